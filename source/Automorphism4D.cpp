@@ -0,0 +1,451 @@
+//
+//  Automorphism4D.cpp
+//
+//   The automorphism group of a polytope's skeleton. See Automorphism4D.h.
+//
+
+#include "Automorphism4D.h"
+#include "SkeletonGraph4D.h"
+#include <math.h>
+#include <algorithm>
+#include <numeric>
+
+// Mixes x into the refinement trace h.
+static unsigned long long MixTrace(unsigned long long h, unsigned long long x)
+{
+	h ^= x + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+	h *= 0xbf58476d1ce4e5b9ull;
+	return h ^ (h >> 31);
+}
+
+double SkeletonAutomorphisms::Find(const SkeletonGraph4D& theGraph, long long theMaxNodes)
+{
+	graph = &theGraph;
+	maxNodes = theMaxNodes;
+	numNodes = 0;
+	exact = true;
+	order = 1.0;
+	firstTrace.clear();
+	targetCells.clear();
+	base.clear();
+	orbitSizes.clear();
+	generatorStart.assign(1, 0);
+	movedVerts.clear();
+	movedImages.clear();
+	int n = graph->GetNumVerts();
+	if (n <= 0) {
+		return order;
+	}
+	count.assign(n, 0);
+	cellFill.assign(n, -1);
+	inQueue.assign(n, 0);
+	orbitParent.resize(n);
+	std::iota(orbitParent.begin(), orbitParent.end(), 0);
+	orbitSize.assign(n, 1);
+
+	// The first path: always the first vertex of the first cell with more than one.
+	//    (The cells before it are single vertices, and stay so.)
+	Partition& p = work;
+	p.lab.resize(n);
+	std::iota(p.lab.begin(), p.lab.end(), 0);
+	p.pos = p.lab;
+	p.cellOf.assign(n, 0);
+	p.cellEnd.assign(n, 0);
+	p.cellEnd[0] = n;
+	p.cellLevel.assign(n, 0);
+	p.splits.clear();
+	p.numCells = 1;
+	firstTrace.push_back(Refine(p, 0, 0));
+	int t = 0;
+	while (p.numCells < n) {
+		while (p.cellEnd[t] - t == 1) {
+			t = p.cellEnd[t];
+		}
+		targetCells.push_back(t);
+		base.push_back(p.lab[t]);
+		int level = (int)base.size();
+		firstTrace.push_back(Refine(p, Individualize(p, p.lab[t], level), level));
+	}
+	firstLeaf = p;
+
+	// From the bottom level up, so the generators already found fix the base vertices above.
+	//    Level i is the partition after individualizing base[0] ... base[i-1].
+	int numLevels = (int)base.size();
+	orbitSizes.assign(numLevels, 1);
+	std::vector<int> cell;
+	for (int level = numLevels - 1; level >= 0; level--) {
+		Restore(work, level);
+		t = targetCells[level];
+		cell.assign(work.lab.begin() + t, work.lab.begin() + work.cellEnd[t]);
+		for (size_t k = 0; k < cell.size(); k++) {
+			int c = cell[k];
+			if (FindOrbit(c) == FindOrbit(base[level])) {
+				continue;
+			}
+			if (numNodes >= maxNodes) {
+				exact = false;
+				break;
+			}
+			Restore(work, level);
+			if (Refine(work, Individualize(work, c, level + 1), level + 1) == firstTrace[level + 1]) {
+				SearchLeaf(level + 1, work);
+			}
+		}
+		orbitSizes[level] = orbitSize[FindOrbit(base[level])];
+		order *= orbitSizes[level];
+	}
+	return order;
+}
+
+// Gives v a cell of its own, at the end of its old cell, split off at level.
+// Returns the start of the new cell.
+int SkeletonAutomorphisms::Individualize(Partition& p, int v, int level) const
+{
+	int s = p.cellOf[v];
+	int last = p.cellEnd[s] - 1;
+	int k = p.pos[v];
+	p.lab[k] = p.lab[last];
+	p.pos[p.lab[k]] = k;
+	p.lab[last] = v;
+	p.pos[v] = last;
+	p.cellEnd[s] = last;
+	p.cellEnd[last] = last + 1;
+	p.cellOf[v] = last;
+	p.cellLevel[last] = level;
+	p.splits.push_back(last);
+	p.numCells++;
+	return last;
+}
+
+// Splits the cells of p until it is equitable, starting from the cell at firstSplitter.
+//    Each cell that is split is sorted by the number of neighbors in the splitter, so
+//    the result (and the trace returned) depends only on the structure of the graph:
+//    an automorphism takes the refinement of one partition to the refinement of its image.
+//    Only the vertices next to the splitter are moved: they go to the end of their
+//    cells, after the vertices with no neighbors in it. So a step costs the number of
+//    edges at the splitter (times a log), however large the cells it splits.
+unsigned long long SkeletonAutomorphisms::Refine(Partition& p, int firstSplitter, int level)
+{
+	numNodes++;
+	int n = (int)p.lab.size();
+	unsigned long long trace = 0;
+	queue.clear();
+	queue.push_back(firstSplitter);
+	inQueue[firstSplitter] = 1;
+	for (size_t head = 0; head < queue.size() && p.numCells < n; head++) {
+		int w = queue[head];
+		int wEnd = p.cellEnd[w];
+		inQueue[w] = 0;
+		trace = MixTrace(trace, (unsigned long long)w << 32 | (unsigned)(wEnd - w));
+		for (int k = w; k < wEnd; k++) {
+			int u = p.lab[k];
+			const int* nbrs = graph->GetNeighbors(u);
+			for (int j = graph->GetDegree(u) - 1; j >= 0; j--) {
+				if (count[nbrs[j]]++ == 0) {
+					touched.push_back(nbrs[j]);
+				}
+			}
+		}
+		for (size_t k = 0; k < touched.size(); k++) {
+			int x = touched[k];
+			int s = p.cellOf[x];
+			if (cellFill[s] < 0) {
+				cellFill[s] = p.cellEnd[s];
+				touchedCells.push_back(s);
+			}
+			int to = --cellFill[s];
+			int from = p.pos[x];
+			p.lab[from] = p.lab[to];
+			p.pos[p.lab[from]] = from;
+			p.lab[to] = x;
+			p.pos[x] = to;
+		}
+		std::sort(touchedCells.begin(), touchedCells.end());
+		for (size_t k = 0; k < touchedCells.size(); k++) {
+			int s = touchedCells[k];
+			int e = p.cellEnd[s];
+			int firstTouched = cellFill[s];
+			cellFill[s] = -1;
+			if (e - s == 1) {
+				trace = MixTrace(trace, (unsigned long long)s << 32 | (unsigned)count[p.lab[s]]);
+				continue;
+			}
+			std::sort(p.lab.begin() + firstTouched, p.lab.begin() + e,
+				[this](int a, int b) { return count[a] < count[b]; });
+			for (int j = firstTouched; j < e; j++) {
+				p.pos[p.lab[j]] = j;
+			}
+			// The pieces, each with one count. Only the touched vertices change cells:
+			//    the untouched ones (count 0) keep the start of the cell.
+			int largest = s;
+			int numPieces = 0;
+			for (int a = s; a < e; ) {
+				int b = a < firstTouched ? firstTouched : a + 1;
+				while (b < e && count[p.lab[b]] == count[p.lab[a]]) {
+					b++;
+				}
+				p.cellEnd[a] = b;
+				if (a != s) {
+					for (int j = a; j < b; j++) {
+						p.cellOf[p.lab[j]] = a;
+					}
+					p.cellLevel[a] = level;
+					p.splits.push_back(a);
+				}
+				trace = MixTrace(trace, (unsigned long long)a << 32 | (unsigned)count[p.lab[a]]);
+				largest = b - a > p.cellEnd[largest] - largest ? a : largest;
+				numPieces++;
+				a = b;
+			}
+			if (numPieces == 1) {
+				continue;
+			}
+			p.numCells += numPieces - 1;
+			// Every piece needs to split the others, except that the largest can be left out
+			//    if the whole cell is not waiting to: it splits them the same as the rest together.
+			bool keepAll = inQueue[s] != 0;
+			for (int a = s; a < e; a = p.cellEnd[a]) {
+				if (!inQueue[a] && (keepAll || a != largest)) {
+					inQueue[a] = 1;
+					queue.push_back(a);
+				}
+			}
+		}
+		for (size_t k = 0; k < touched.size(); k++) {
+			count[touched[k]] = 0;
+		}
+		touched.clear();
+		touchedCells.clear();
+	}
+	for (size_t head = 0; head < queue.size(); head++) {
+		inQueue[queue[head]] = 0;
+	}
+	return MixTrace(trace, (unsigned)p.numCells);
+}
+
+// Goes back up the path to level, merging each cell split off below it into the
+//    cell it came from, latest first.
+void SkeletonAutomorphisms::Restore(Partition& p, int level) const
+{
+	while (!p.splits.empty() && p.cellLevel[p.splits.back()] > level) {
+		int s = p.splits.back();
+		p.splits.pop_back();
+		int from = p.cellOf[p.lab[s - 1]];
+		int e = p.cellEnd[s];
+		for (int j = s; j < e; j++) {
+			p.cellOf[p.lab[j]] = from;
+		}
+		p.cellEnd[from] = e;
+		p.numCells--;
+	}
+}
+
+// Continues a path that has matched the first path down to level, trying each vertex of
+//    the target cell, until a path ends in an automorphism.
+// Returns true if it found one (and added it to the generators).
+bool SkeletonAutomorphisms::SearchLeaf(int level, Partition& p)
+{
+	if (level == (int)base.size()) {
+		const std::vector<int>& firstLab = firstLeaf.lab;
+		std::vector<int> perm(firstLab.size());
+		std::vector<int> moved;
+		for (size_t k = 0; k < firstLab.size(); k++) {
+			perm[firstLab[k]] = p.lab[k];
+			if (firstLab[k] != p.lab[k]) {
+				moved.push_back(firstLab[k]);
+			}
+		}
+		if (!IsAutomorphism(perm, moved)) {
+			return false;
+		}
+		AddGenerator(perm, moved);
+		return true;
+	}
+	int t = targetCells[level];
+	std::vector<int> cell(p.lab.begin() + t, p.lab.begin() + p.cellEnd[t]);
+	for (size_t k = 0; k < cell.size(); k++) {
+		if (numNodes >= maxNodes) {
+			exact = false;
+			return false;
+		}
+		Restore(p, level);
+		if (Refine(p, Individualize(p, cell[k], level + 1), level + 1) == firstTrace[level + 1]
+			&& SearchLeaf(level + 1, p)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Whether perm takes every edge to an edge. Only the edges at the vertices it moves need
+//    checking. (The neighbors of a vertex are in increasing order.)
+bool SkeletonAutomorphisms::IsAutomorphism(const std::vector<int>& perm, const std::vector<int>& moved) const
+{
+	for (size_t k = 0; k < moved.size(); k++) {
+		int v = moved[k];
+		int image = perm[v];
+		int degree = graph->GetDegree(v);
+		if (graph->GetDegree(image) != degree) {
+			return false;
+		}
+		const int* nbrs = graph->GetNeighbors(v);
+		const int* imageNbrs = graph->GetNeighbors(image);
+		for (int j = 0; j < degree; j++) {
+			if (!std::binary_search(imageNbrs, imageNbrs + degree, perm[nbrs[j]])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void SkeletonAutomorphisms::GetGenerator(int k, std::vector<int>& perm) const
+{
+	perm.resize(graph->GetNumVerts());
+	std::iota(perm.begin(), perm.end(), 0);
+	for (int j = generatorStart[k]; j < generatorStart[k + 1]; j++) {
+		perm[movedVerts[j]] = movedImages[j];
+	}
+}
+
+int SkeletonAutomorphisms::FindOrbit(int v)
+{
+	while (orbitParent[v] != v) {
+		orbitParent[v] = orbitParent[orbitParent[v]];
+		v = orbitParent[v];
+	}
+	return v;
+}
+
+void SkeletonAutomorphisms::AddGenerator(const std::vector<int>& perm, const std::vector<int>& moved)
+{
+	for (size_t k = 0; k < moved.size(); k++) {
+		int v = moved[k];
+		movedVerts.push_back(v);
+		movedImages.push_back(perm[v]);
+		int a = FindOrbit(v);
+		int b = FindOrbit(perm[v]);
+		if (a != b) {
+			if (orbitSize[a] < orbitSize[b]) {
+				std::swap(a, b);
+			}
+			orbitParent[b] = a;
+			orbitSize[a] += orbitSize[b];
+		}
+	}
+	generatorStart.push_back((int)movedVerts.size());
+}
+
+// **********************
+// Solves for the inverse of the 4x4 matrix m (by rows), by Gauss-Jordan elimination.
+// Returns false if m is singular.
+// **********************
+static bool Invert4(const double m[4][4], double inv[4][4])
+{
+	double a[4][8];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			a[i][j] = m[i][j];
+			a[i][j + 4] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+	for (int col = 0; col < 4; col++) {
+		int pivot = col;
+		for (int i = col + 1; i < 4; i++) {
+			pivot = fabs(a[i][col]) > fabs(a[pivot][col]) ? i : pivot;
+		}
+		if (fabs(a[pivot][col]) < 1.0e-12) {
+			return false;
+		}
+		for (int j = 0; j < 8; j++) {
+			std::swap(a[col][j], a[pivot][j]);
+		}
+		double scale = 1.0 / a[col][col];
+		for (int j = 0; j < 8; j++) {
+			a[col][j] *= scale;
+		}
+		for (int i = 0; i < 4; i++) {
+			if (i != col && a[i][col] != 0.0) {
+				double f = a[i][col];
+				for (int j = 0; j < 8; j++) {
+					a[i][j] -= f * a[col][j];
+				}
+			}
+		}
+	}
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			inv[i][j] = a[i][j + 4];
+		}
+	}
+	return true;
+}
+
+bool ActsOrthogonally(const float* verts, int numVerts, const int* perm, double& error,
+	double tolerance)
+{
+	error = HUGE_VAL;
+	if (numVerts <= 0) {
+		return false;
+	}
+	// A symmetry of the polytope fixes the centroid of its vertices.
+	double center[4] = { 0.0, 0.0, 0.0, 0.0 };
+	for (int v = 0; v < numVerts; v++) {
+		for (int i = 0; i < 4; i++) {
+			center[i] += verts[4 * v + i];
+		}
+	}
+	for (int i = 0; i < 4; i++) {
+		center[i] /= numVerts;
+	}
+	// The least squares fit A = M S^-1, with S = sum c c^T and M = sum perm(c) c^T
+	//    over the vertices c (about the center).
+	double S[4][4] = {};
+	double M[4][4] = {};
+	double radius2 = 0.0;
+	for (int v = 0; v < numVerts; v++) {
+		double c[4], image[4];
+		for (int i = 0; i < 4; i++) {
+			c[i] = verts[4 * v + i] - center[i];
+			image[i] = verts[4 * perm[v] + i] - center[i];
+		}
+		radius2 = std::max(radius2, c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + c[3] * c[3]);
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				S[i][j] += c[i] * c[j];
+				M[i][j] += image[i] * c[j];
+			}
+		}
+	}
+	double Sinv[4][4];
+	if (radius2 <= 0.0 || !Invert4(S, Sinv)) {
+		return false;		// The vertices do not span R^4: A is not determined
+	}
+	double A[4][4];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			A[i][j] = M[i][0] * Sinv[0][j] + M[i][1] * Sinv[1][j] + M[i][2] * Sinv[2][j] + M[i][3] * Sinv[3][j];
+		}
+	}
+	error = 0.0;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			double dot = A[0][i] * A[0][j] + A[1][i] * A[1][j] + A[2][i] * A[2][j] + A[3][i] * A[3][j];
+			error = std::max(error, fabs(dot - (i == j ? 1.0 : 0.0)));
+		}
+	}
+	double radius = sqrt(radius2);
+	for (int v = 0; v < numVerts; v++) {
+		double dist2 = 0.0;
+		for (int i = 0; i < 4; i++) {
+			double mapped = center[i];
+			for (int j = 0; j < 4; j++) {
+				mapped += A[i][j] * (verts[4 * v + j] - center[j]);
+			}
+			double d = mapped - verts[4 * perm[v] + i];
+			dist2 += d * d;
+		}
+		error = std::max(error, sqrt(dist2) / radius);
+	}
+	return error <= tolerance;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+//
+// Automorphism4D.h   ---  Header file for Automorphism4D.cpp.
+//
+//   The automorphism group of a polytope's skeleton: the permutations of the
+//   vertices that take edges to edges. Found by individualization and refinement,
+//   as in nauty:
+//      Refinement   splits the vertices into cells until every vertex of a cell
+//                   has the same number of neighbors in each cell (an equitable
+//                   partition). Automorphisms take cells to cells.
+//      Search       one vertex of a cell is individualized (given a cell of its own),
+//                   and the partition refined again, until every cell is a single
+//                   vertex. The first such path fixes the base b1, b2, ...; every
+//                   other vertex c of the cell of bi is tried in place of bi, and
+//                   a path that ends in the same way gives an automorphism.
+//   Searches are skipped for the vertices already known to be in the orbit of bi,
+//   so only a few succeed at each level. The order of the group is the product of
+//   the orbit sizes along the base. The automorphisms found generate the group.
+//
+//   ActsOrthogonally() checks that an automorphism of the skeleton is also a
+//   symmetry of the polytope in R^4: a rotation or reflection about its center.
+//
+
+#include <vector>
+
+class SkeletonGraph4D;
+
+class SkeletonAutomorphisms
+{
+public:
+	// Finds generators of the automorphism group of graph. After maxNodes refinements
+	//    the search gives up: the group found is then a subgroup, and IsExact() is false.
+	// Returns the order of the group (as a double, since it can be very large).
+	double Find(const SkeletonGraph4D& graph, long long maxNodes = 1000000);
+
+	double GetOrder() const { return order; }
+	bool IsExact() const { return exact; }
+	int GetNumGenerators() const { return (int)generatorStart.size() - 1; }
+	void GetGenerator(int k, std::vector<int>& perm) const;				// The image of each vertex
+	const std::vector<int>& GetBase() const { return base; }
+	const std::vector<int>& GetOrbitSizes() const { return orbitSizes; }	// The orbit of each base vertex, fixing those before it
+	long long GetNumNodes() const { return numNodes; }					// Refinements done
+
+private:
+	// Refinement only splits cells, and only reorders the vertices within cells, so
+	//    the partitions at all the levels of a path are one lab, with the level at which
+	//    each cell was split off: going back up the path just merges cells again.
+	struct Partition {
+		std::vector<int> lab;		// The vertices, cell by cell
+		std::vector<int> pos;		// The position of each vertex in lab
+		std::vector<int> cellOf;	// The start (in lab) of the cell of each vertex
+		std::vector<int> cellEnd;	// For the start of each cell, the end of the cell
+		std::vector<int> cellLevel;	// For the start of each cell, the level it was split off at
+		std::vector<int> splits;	// The cell starts, in the order they were split off
+		int numCells;
+	};
+
+	int Individualize(Partition& p, int v, int level) const;
+	unsigned long long Refine(Partition& p, int firstSplitter, int level);
+	void Restore(Partition& p, int level) const;
+	bool SearchLeaf(int level, Partition& p);
+	bool IsAutomorphism(const std::vector<int>& perm, const std::vector<int>& moved) const;
+	int FindOrbit(int v);
+	void AddGenerator(const std::vector<int>& perm, const std::vector<int>& moved);
+
+	const SkeletonGraph4D* graph = 0;
+	Partition firstLeaf;					// The end of the first path
+	Partition work;							// The path being searched
+	std::vector<unsigned long long> firstTrace;	// The refinement trace at each level
+	std::vector<int> targetCells;			// The cell individualized at each level
+	std::vector<int> base;
+	std::vector<int> orbitSizes;
+	std::vector<int> generatorStart;		// The vertices generator k moves are movedVerts[generatorStart[k]] up
+	std::vector<int> movedVerts;			//    to movedVerts[generatorStart[k+1]-1], and their images movedImages
+	std::vector<int> movedImages;
+	std::vector<int> orbitParent;			// Union-find forest of the orbits of the generators
+	std::vector<int> orbitSize;
+	double order = 1.0;
+	bool exact = true;
+	long long numNodes = 0;
+	long long maxNodes = 0;
+
+	// Scratch space for Refine()
+	std::vector<int> count;
+	std::vector<int> touched;
+	std::vector<int> touchedCells;
+	std::vector<int> cellFill;		// For each touched cell, where its next touched vertex goes
+	std::vector<char> inQueue;
+	std::vector<int> queue;
+};
+
+// Whether the vertex permutation perm (the image of each vertex) is a symmetry of the
+//    vertices (4 floats each) in R^4: whether a linear map A, about the centroid,
+//    takes each vertex to its image and is orthogonal.
+// error gets the larger of the largest entry of A^T A - I, and the largest distance of
+//    a vertex from its image under A over the circumradius.
+bool ActsOrthogonally(const float* verts, int numVerts, const int* perm, double& error,
+	double tolerance = 1.0e-4);
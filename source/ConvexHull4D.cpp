@@ -0,0 +1,520 @@
+//
+//  ConvexHull4D.cpp
+//
+//   Quickhull in R^4. See ConvexHull4D.h.
+//
+
+#include "ConvexHull4D.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+
+namespace {
+
+struct HullFacet
+{
+	int v[4];			// Vertices (input point indices)
+	int nbr[4];			// nbr[i] is the facet across the ridge opposite v[i]
+	double normal[4];	// Unit normal, pointing out
+	double offset;		// normal . x = offset on the hyperplane
+	std::vector<int> outside;	// The points beyond the facet
+	int furthest;		// The one furthest beyond, or -1
+	double furthestDist;
+	int visited;		// The iteration the facet was last looked at
+	bool visible;		// From the current eye point (valid when visited is current)
+	bool alive;
+};
+
+class Quickhull4D
+{
+public:
+	Quickhull4D(const float* points, int numPoints, double eps)
+		: points(points), numPoints(numPoints), eps(eps) {}
+
+	bool Run();
+
+	std::vector<HullFacet> facets;
+
+private:
+	double Dist(const HullFacet& f, int p) const
+	{
+		const float* x = points + 4 * p;
+		return f.normal[0] * x[0] + f.normal[1] * x[1] + f.normal[2] * x[2] + f.normal[3] * x[3] - f.offset;
+	}
+	bool InitialSimplex(int* simplex);
+	int NewFacet(int a, int b, int c, int d);
+	void Partition(const std::vector<int>& candidates, const std::vector<int>& newFacets);
+
+	const float* points;
+	int numPoints;
+	double eps;
+	double interior[4];		// Stays strictly inside the hull
+};
+
+void Cross4(const double* a, const double* b, const double* c, double* n)
+{
+	double m01 = b[0] * c[1] - b[1] * c[0];
+	double m02 = b[0] * c[2] - b[2] * c[0];
+	double m03 = b[0] * c[3] - b[3] * c[0];
+	double m12 = b[1] * c[2] - b[2] * c[1];
+	double m13 = b[1] * c[3] - b[3] * c[1];
+	double m23 = b[2] * c[3] - b[3] * c[2];
+	n[0] = a[1] * m23 - a[2] * m13 + a[3] * m12;
+	n[1] = -(a[0] * m23 - a[2] * m03 + a[3] * m02);
+	n[2] = a[0] * m13 - a[1] * m03 + a[3] * m01;
+	n[3] = -(a[0] * m12 - a[1] * m02 + a[2] * m01);
+}
+
+// Splits [0, count) among threads, and runs work(first, last) on each.
+// Small counts are done on the calling thread.
+template <class Work>
+void ParallelFor(int count, Work work)
+{
+	int numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads <= 1 || count < 50000) {
+		work(0, count);
+		return;
+	}
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++) {
+		threads.push_back(std::thread(work, (int)((long long)count * t / numThreads),
+			(int)((long long)count * (t + 1) / numThreads)));
+	}
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+}
+
+// The distance of p from the affine span of the first k points of basis (k = 1..4).
+// Gram-Schmidt on the differences, in double.
+double DistFromSpan(const float* points, const int* basis, int k, int p)
+{
+	double q[3][4];
+	const float* o = points + 4 * basis[0];
+	for (int j = 1; j < k; j++) {
+		for (int i = 0; i < 4; i++) {
+			q[j - 1][i] = (double)points[4 * basis[j] + i] - o[i];
+		}
+		for (int m = 0; m < j - 1; m++) {
+			double d = q[j - 1][0] * q[m][0] + q[j - 1][1] * q[m][1] + q[j - 1][2] * q[m][2] + q[j - 1][3] * q[m][3];
+			for (int i = 0; i < 4; i++) {
+				q[j - 1][i] -= d * q[m][i];
+			}
+		}
+		double len = sqrt(q[j - 1][0] * q[j - 1][0] + q[j - 1][1] * q[j - 1][1]
+			+ q[j - 1][2] * q[j - 1][2] + q[j - 1][3] * q[j - 1][3]);
+		for (int i = 0; i < 4; i++) {
+			q[j - 1][i] /= len;
+		}
+	}
+	double r[4];
+	for (int i = 0; i < 4; i++) {
+		r[i] = (double)points[4 * p + i] - o[i];
+	}
+	for (int m = 0; m < k - 1; m++) {
+		double d = r[0] * q[m][0] + r[1] * q[m][1] + r[2] * q[m][2] + r[3] * q[m][3];
+		for (int i = 0; i < 4; i++) {
+			r[i] -= d * q[m][i];
+		}
+	}
+	return sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+}
+
+// Five points far from each other's spans: each one furthest from the span of those before.
+bool Quickhull4D::InitialSimplex(int* simplex)
+{
+	simplex[0] = 0;
+	for (int p = 1; p < numPoints; p++) {
+		if (points[4 * p] < points[4 * simplex[0]]) {
+			simplex[0] = p;
+		}
+	}
+	for (int k = 1; k < 5; k++) {
+		double best = -1.0;
+		for (int p = 0; p < numPoints; p++) {
+			double d = DistFromSpan(points, simplex, k, p);
+			if (d > best) {
+				best = d;
+				simplex[k] = p;
+			}
+		}
+		if (best <= 10.0 * eps) {
+			return false;		// The points lie in a hyperplane (or less)
+		}
+	}
+	for (int i = 0; i < 4; i++) {
+		interior[i] = 0.0;
+		for (int k = 0; k < 5; k++) {
+			interior[i] += 0.2 * points[4 * simplex[k] + i];
+		}
+	}
+	return true;
+}
+
+int Quickhull4D::NewFacet(int a, int b, int c, int d)
+{
+	facets.push_back(HullFacet());
+	HullFacet& f = facets.back();
+	f.v[0] = a;
+	f.v[1] = b;
+	f.v[2] = c;
+	f.v[3] = d;
+	double e[3][4];
+	const float* o = points + 4 * a;
+	for (int i = 0; i < 4; i++) {
+		e[0][i] = (double)points[4 * b + i] - o[i];
+		e[1][i] = (double)points[4 * c + i] - o[i];
+		e[2][i] = (double)points[4 * d + i] - o[i];
+	}
+	Cross4(e[0], e[1], e[2], f.normal);
+	double len = sqrt(f.normal[0] * f.normal[0] + f.normal[1] * f.normal[1]
+		+ f.normal[2] * f.normal[2] + f.normal[3] * f.normal[3]);
+	if (len > 0.0) {
+		for (int i = 0; i < 4; i++) {
+			f.normal[i] /= len;
+		}
+	}
+	f.offset = f.normal[0] * o[0] + f.normal[1] * o[1] + f.normal[2] * o[2] + f.normal[3] * o[3];
+	double inside = f.normal[0] * interior[0] + f.normal[1] * interior[1]
+		+ f.normal[2] * interior[2] + f.normal[3] * interior[3] - f.offset;
+	if (inside > 0.0) {
+		for (int i = 0; i < 4; i++) {
+			f.normal[i] = -f.normal[i];
+		}
+		f.offset = -f.offset;
+	}
+	f.furthest = -1;
+	f.furthestDist = 0.0;
+	f.visited = -1;
+	f.visible = false;
+	f.alive = true;
+	for (int i = 0; i < 4; i++) {
+		f.nbr[i] = -1;
+	}
+	return (int)facets.size() - 1;
+}
+
+// Puts each candidate point into the outside set of the first new facet it is beyond.
+// The other points are inside the hull (or within eps of it), and are dropped.
+void Quickhull4D::Partition(const std::vector<int>& candidates, const std::vector<int>& newFacets)
+{
+	std::vector<int> owner(candidates.size());
+	std::vector<double> dist(candidates.size());
+	ParallelFor((int)candidates.size(), [&](int first, int last) {
+		for (int k = first; k < last; k++) {
+			owner[k] = -1;
+			for (size_t j = 0; j < newFacets.size(); j++) {
+				double d = Dist(facets[newFacets[j]], candidates[k]);
+				if (d > eps) {
+					owner[k] = newFacets[j];
+					dist[k] = d;
+					break;
+				}
+			}
+		}
+	});
+	for (size_t k = 0; k < candidates.size(); k++) {
+		if (owner[k] >= 0) {
+			HullFacet& f = facets[owner[k]];
+			f.outside.push_back(candidates[k]);
+			if (dist[k] > f.furthestDist) {
+				f.furthestDist = dist[k];
+				f.furthest = candidates[k];
+			}
+		}
+	}
+}
+
+bool Quickhull4D::Run()
+{
+	int s[5];
+	if (numPoints < 5 || !InitialSimplex(s)) {
+		return false;
+	}
+	facets.reserve(1024);
+	std::vector<int> newFacets;
+	for (int k = 0; k < 5; k++) {
+		int f = NewFacet(s[(k + 1) % 5], s[(k + 2) % 5], s[(k + 3) % 5], s[(k + 4) % 5]);
+		newFacets.push_back(f);
+	}
+	// Facet k lacks simplex vertex k; the facet across from its vertex s[j] lacks s[j].
+	for (int k = 0; k < 5; k++) {
+		for (int i = 0; i < 4; i++) {
+			facets[k].nbr[i] = (k + 1 + i) % 5;
+		}
+	}
+	std::vector<int> candidates;
+	candidates.reserve(numPoints);
+	for (int p = 0; p < numPoints; p++) {
+		if (p != s[0] && p != s[1] && p != s[2] && p != s[3] && p != s[4]) {
+			candidates.push_back(p);
+		}
+	}
+	Partition(candidates, newFacets);
+
+	std::vector<int> pending(newFacets);
+	std::vector<int> visible, horizonFacet, horizonSlot;
+	std::unordered_map<long long, int> openRidges;		// Ridge through the eye -> new facet * 4 + slot
+	for (int iteration = 0; !pending.empty(); iteration++) {
+		int start = pending.back();
+		pending.pop_back();
+		if (!facets[start].alive || facets[start].furthest < 0) {
+			continue;
+		}
+		int eye = facets[start].furthest;
+
+		// The facets the eye can see, and the ridges on the horizon around them.
+		visible.assign(1, start);
+		facets[start].visited = iteration;
+		facets[start].visible = true;
+		horizonFacet.clear();
+		horizonSlot.clear();
+		for (size_t k = 0; k < visible.size(); k++) {
+			int fv = visible[k];
+			for (int i = 0; i < 4; i++) {
+				int n = facets[fv].nbr[i];
+				if (facets[n].visited != iteration) {
+					facets[n].visited = iteration;
+					facets[n].visible = Dist(facets[n], eye) > eps;
+					if (facets[n].visible) {
+						visible.push_back(n);
+					}
+				}
+				if (!facets[n].visible) {
+					horizonFacet.push_back(fv);
+					horizonSlot.push_back(i);
+				}
+			}
+		}
+
+		// A cone of new facets from the horizon to the eye.
+		newFacets.clear();
+		openRidges.clear();
+		for (size_t h = 0; h < horizonFacet.size(); h++) {
+			int r[3];
+			int m = 0;
+			const HullFacet& old = facets[horizonFacet[h]];
+			for (int i = 0; i < 4; i++) {
+				if (i != horizonSlot[h]) {
+					r[m++] = old.v[i];
+				}
+			}
+			int across = old.nbr[horizonSlot[h]];
+			int oldIndex = horizonFacet[h];
+			int f = NewFacet(r[0], r[1], r[2], eye);		// May move facets in memory
+			newFacets.push_back(f);
+			facets[f].nbr[3] = across;
+			for (int i = 0; i < 4; i++) {
+				if (facets[across].nbr[i] == oldIndex) {
+					facets[across].nbr[i] = f;
+				}
+			}
+			// The ridge opposite r[j] is the eye and the other two, keyed by those two.
+			for (int j = 0; j < 3; j++) {
+				int a = r[(j + 1) % 3];
+				int b = r[(j + 2) % 3];
+				long long key = a < b ? ((long long)a << 32) | b : ((long long)b << 32) | a;
+				std::unordered_map<long long, int>::iterator it = openRidges.find(key);
+				if (it == openRidges.end()) {
+					openRidges[key] = 4 * f + j;
+				}
+				else {
+					facets[f].nbr[j] = it->second / 4;
+					facets[it->second / 4].nbr[it->second % 4] = f;
+					openRidges.erase(it);
+				}
+			}
+		}
+		if (!openRidges.empty()) {
+			return false;		// The horizon was not a closed surface
+		}
+
+		// The points outside the visible facets go to the new ones.
+		candidates.clear();
+		for (size_t k = 0; k < visible.size(); k++) {
+			HullFacet& f = facets[visible[k]];
+			for (size_t j = 0; j < f.outside.size(); j++) {
+				if (f.outside[j] != eye) {
+					candidates.push_back(f.outside[j]);
+				}
+			}
+			std::vector<int>().swap(f.outside);
+			f.alive = false;
+		}
+		Partition(candidates, newFacets);
+		pending.insert(pending.end(), newFacets.begin(), newFacets.end());
+	}
+	return true;
+}
+
+int FindRoot(std::vector<int>& parent, int i)
+{
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// Merges the facets into cells, and finds the edges (in edges), and the 2-faces (in topology).
+// Neighboring facets are in the same cell if each one's other vertex is within
+//    mergeTolerance of the other's hyperplane.
+// Returns false if the cells do not fit together as the cells of a polytope.
+bool MergeFacets(const float* points, const std::vector<HullFacet>& facets, const std::vector<int>& newIndex,
+	int numVerts, double mergeTolerance, std::vector<int>& edges, PolytopeTopology4D& topology)
+{
+	std::vector<int> parent(facets.size());
+	for (size_t f = 0; f < facets.size(); f++) {
+		parent[f] = (int)f;
+	}
+	for (size_t f = 0; f < facets.size(); f++) {
+		if (!facets[f].alive) {
+			continue;
+		}
+		for (int i = 0; i < 4; i++) {
+			int g = facets[f].nbr[i];
+			if (g < (int)f) {
+				continue;
+			}
+			// The vertex of each facet that is not on the other must be in its hyperplane.
+			int pf = facets[f].v[i];
+			int pg = -1;
+			for (int j = 0; j < 4; j++) {
+				if (facets[g].nbr[j] == (int)f) {
+					pg = facets[g].v[j];
+				}
+			}
+			const float* xf = points + 4 * pf;
+			const float* xg = points + 4 * pg;
+			const double* nf = facets[f].normal;
+			const double* ng = facets[g].normal;
+			double df = ng[0] * xf[0] + ng[1] * xf[1] + ng[2] * xf[2] + ng[3] * xf[3] - facets[g].offset;
+			double dg = nf[0] * xg[0] + nf[1] * xg[1] + nf[2] * xg[2] + nf[3] * xg[3] - facets[f].offset;
+			if (fabs(df) <= mergeTolerance && fabs(dg) <= mergeTolerance) {
+				parent[FindRoot(parent, (int)f)] = FindRoot(parent, g);
+			}
+		}
+	}
+
+	// Edges: triangulation edges in at least three cells.
+	edges.clear();
+	std::vector<std::pair<long long, int> > edgeCells;		// (edge key, cell) for each facet edge
+	edgeCells.reserve(6 * facets.size());
+	for (size_t f = 0; f < facets.size(); f++) {
+		if (!facets[f].alive) {
+			continue;
+		}
+		int cell = FindRoot(parent, (int)f);
+		for (int i = 0; i < 4; i++) {
+			for (int j = i + 1; j < 4; j++) {
+				int a = newIndex[facets[f].v[i]];
+				int b = newIndex[facets[f].v[j]];
+				long long key = a < b ? ((long long)a << 32) | b : ((long long)b << 32) | a;
+				edgeCells.push_back(std::make_pair(key, cell));
+			}
+		}
+	}
+	std::sort(edgeCells.begin(), edgeCells.end());
+	for (size_t k = 0; k < edgeCells.size(); ) {
+		size_t end = k;
+		int numCells = 0;
+		while (end < edgeCells.size() && edgeCells[end].first == edgeCells[k].first) {
+			if (end == k || edgeCells[end].second != edgeCells[end - 1].second) {
+				numCells++;
+			}
+			end++;
+		}
+		if (numCells >= 3) {
+			edges.push_back((int)(edgeCells[k].first >> 32));
+			edges.push_back((int)(edgeCells[k].first & 0xffffffff));
+		}
+		k = end;
+	}
+
+	// The vertices of each cell, for the 2-faces.
+	std::vector<int> cellOf(facets.size(), -1);
+	std::vector<int> cellStart(1, 0), cellVerts;
+	for (size_t f = 0; f < facets.size(); f++) {
+		if (facets[f].alive && FindRoot(parent, (int)f) == (int)f) {
+			cellOf[f] = (int)cellStart.size() - 1;
+			cellStart.push_back(0);
+		}
+	}
+	std::vector<std::pair<int, int> > cellVertPairs;		// (cell, vertex) for each facet vertex
+	cellVertPairs.reserve(4 * facets.size());
+	for (size_t f = 0; f < facets.size(); f++) {
+		if (facets[f].alive) {
+			int cell = cellOf[FindRoot(parent, (int)f)];
+			for (int i = 0; i < 4; i++) {
+				cellVertPairs.push_back(std::make_pair(cell, newIndex[facets[f].v[i]]));
+			}
+		}
+	}
+	std::sort(cellVertPairs.begin(), cellVertPairs.end());
+	cellVertPairs.erase(std::unique(cellVertPairs.begin(), cellVertPairs.end()), cellVertPairs.end());
+	for (size_t k = 0; k < cellVertPairs.size(); k++) {
+		cellVerts.push_back(cellVertPairs[k].second);
+		cellStart[cellVertPairs[k].first + 1]++;
+	}
+	for (size_t c = 1; c < cellStart.size(); c++) {
+		cellStart[c] += cellStart[c - 1];
+	}
+	return topology.BuildFromCells(numVerts, edges.data(), (int)edges.size() / 2, cellStart, cellVerts);
+}
+
+}	// namespace
+
+bool ConvexHull4D::Build(const float* points, int numPoints, double tolerance)
+{
+	verts.clear();
+	sourceIndex.clear();
+	edges.clear();
+	tetrahedra.clear();
+	if (tolerance <= 0.0) {
+		double extent = 0.0;
+		for (int i = 0; i < 4; i++) {
+			double lo = DBL_MAX, hi = -DBL_MAX;
+			for (int p = 0; p < numPoints; p++) {
+				lo = fmin(lo, points[4 * p + i]);
+				hi = fmax(hi, points[4 * p + i]);
+			}
+			extent = fmax(extent, hi - lo);
+		}
+		tolerance = 1.0e-6 * extent;
+	}
+	Quickhull4D hull(points, numPoints, tolerance);
+	if (!hull.Run()) {
+		return false;
+	}
+	std::vector<HullFacet>& facets = hull.facets;
+
+	// Renumber the points that are hull vertices.
+	std::vector<int> newIndex(numPoints, -1);
+	for (size_t f = 0; f < facets.size(); f++) {
+		if (!facets[f].alive) {
+			continue;
+		}
+		for (int i = 0; i < 4; i++) {
+			int p = facets[f].v[i];
+			if (newIndex[p] < 0) {
+				newIndex[p] = (int)sourceIndex.size();
+				sourceIndex.push_back(p);
+				verts.insert(verts.end(), points + 4 * p, points + 4 * p + 4);
+			}
+			tetrahedra.push_back(newIndex[p]);
+		}
+	}
+
+	// Points of random clouds can also be in each other's hyperplanes, up to the tolerance,
+	//    and then merging may not leave a polytope. Merging less always ends the problem:
+	//    with no merging, the cells are the tetrahedra themselves.
+	const double mergeFactors[] = { 1.0, 1.0e-2, 1.0e-4, 0.0 };
+	for (int k = 0; k < 4; k++) {
+		if (MergeFacets(points, facets, newIndex, GetNumVerts(), mergeFactors[k] * tolerance, edges, topology)) {
+			return true;
+		}
+	}
+	return false;
+}
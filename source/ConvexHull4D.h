@@ -0,0 +1,53 @@
+#pragma once
+
+//
+// ConvexHull4D.h   ---  Header file for ConvexHull4D.cpp.
+//
+//   The convex hull of a 4D point cloud, by quickhull. The hull is first built
+//   from tetrahedral facets. Each facet keeps the points outside it, and the
+//   point furthest out is added next. Facets that lie in one hyperplane are then
+//   merged into the cells of the polytope. A triangulation edge is an edge of
+//   the polytope if it is in at least three cells; otherwise it is a diagonal
+//   of a 2-face or a cell.
+//
+//   The output is in the viewer's format: 4 floats per vertex and 2 vertex indices
+//   per edge. The cells and 2-faces (ridges) come from PolytopeTopology4D.
+//
+//   Points are only counted as outside a facet if they are more than a tolerance
+//   beyond it, so points that are in a cell's hyperplane up to float rounding
+//   (golden-ratio coordinates, for instance) do not make sliver facets.
+//   The points are sorted into the outside sets on several threads.
+//
+
+#include <vector>
+#include "Topology4D.h"
+
+class ConvexHull4D
+{
+public:
+	// Builds the hull of the points (4 floats each). tolerance is a distance; if it is
+	//    <= 0, 1e-6 times the size of the point cloud is used.
+	// Returns false if the points do not span R^4, or if the cells and edges found
+	//    do not form a polytope.
+	bool Build(const float* points, int numPoints, double tolerance = 0.0);
+
+	int GetNumVerts() const { return (int)verts.size() / 4; }
+	const float* GetVerts() const { return verts.data(); }		// 4 floats per vertex
+	const int* GetSourceIndices() const { return sourceIndex.data(); }	// The input point of each vertex
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge
+
+	// The tetrahedra of the triangulated hull, 4 vertex indices each
+	int GetNumTetrahedra() const { return (int)tetrahedra.size() / 4; }
+	const int* GetTetrahedra() const { return tetrahedra.data(); }
+
+	// The facets (cells) and ridges (2-faces)
+	const PolytopeTopology4D& GetTopology() const { return topology; }
+
+private:
+	std::vector<float> verts;
+	std::vector<int> sourceIndex;
+	std::vector<int> edges;
+	std::vector<int> tetrahedra;
+	PolytopeTopology4D topology;
+};
@@ -0,0 +1,388 @@
+//
+//  Coxeter4D.cpp
+//
+//   Coxeter groups of linear diagrams in R^4, Todd-Coxeter coset enumeration,
+//   and the regular 4-polytopes built from them. See Coxeter4D.h.
+//
+
+#include "Coxeter4D.h"
+#include <math.h>
+#include <set>
+#include <algorithm>
+
+// **********************
+// CoxeterGroup4D
+// **********************
+
+bool CoxeterGroup4D::Set(int m01, int m12, int m23)
+{
+	if (m01 < 2 || m12 < 2 || m23 < 2) {
+		return false;
+	}
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			m[i][j] = (i == j) ? 1 : 2;		// Mirrors not joined in the diagram are perpendicular
+		}
+	}
+	m[0][1] = m[1][0] = m01;
+	m[1][2] = m[2][1] = m12;
+	m[2][3] = m[3][2] = m23;
+
+	// The normals of mirrors i and j meet at angle pi - pi/mij. The rows of the Cholesky
+	//    factor of their Gram matrix are normals with exactly these angles. The Gram
+	//    matrix is positive definite exactly when the group is finite.
+	const double Pi = 3.14159265358979323846;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			roots[i][j] = 0.0;
+		}
+		for (int j = 0; j <= i; j++) {
+			double sum = (i == j) ? 1.0 : -cos(Pi / m[i][j]);
+			for (int k = 0; k < j; k++) {
+				sum -= roots[i][k] * roots[j][k];
+			}
+			if (i == j) {
+				if (sum <= 1.0e-9) {
+					return false;
+				}
+				roots[i][i] = sqrt(sum);
+			}
+			else {
+				roots[i][j] = sum / roots[j][j];
+			}
+		}
+	}
+	return true;
+}
+
+void CoxeterGroup4D::Reflect(int i, const double* in, double* out) const
+{
+	const double* a = roots[i];
+	double twoDot = 2.0 * (in[0] * a[0] + in[1] * a[1] + in[2] * a[2] + in[3] * a[3]);
+	for (int k = 0; k < 4; k++) {
+		out[k] = in[k] - twoDot * a[k];
+	}
+}
+
+void CoxeterGroup4D::WythoffPoint(int ringMask, double* point) const
+{
+	// Solve roots * point = b by forward substitution (roots is lower triangular).
+	for (int i = 0; i < 4; i++) {
+		double b = (ringMask & (1 << i)) ? 0.5 : 0.0;
+		for (int k = 0; k < i; k++) {
+			b -= roots[i][k] * point[k];
+		}
+		point[i] = b / roots[i][i];
+	}
+}
+
+void CoxeterGroup4D::PlaceCosets(const std::vector<int>& table, int ringMask, double scale, std::vector<float>& verts) const
+{
+	// Place the first coset, then reach every other one through a mirror.
+	int numCosets = (int)table.size() / 4;
+	std::vector<double> pos(4 * numCosets);
+	std::vector<bool> placed(numCosets, false);
+	std::vector<int> queue(1, 0);
+	WythoffPoint(ringMask, &pos[0]);
+	placed[0] = true;
+	for (size_t k = 0; k < queue.size(); k++) {
+		int c = queue[k];
+		for (int i = 0; i < 4; i++) {
+			int d = table[4 * c + i];
+			if (!placed[d]) {
+				Reflect(i, &pos[4 * c], &pos[4 * d]);
+				placed[d] = true;
+				queue.push_back(d);
+			}
+		}
+	}
+	verts.resize(4 * numCosets);
+	for (int k = 0; k < 4 * numCosets; k++) {
+		verts[k] = (float)(scale * pos[k]);
+	}
+}
+
+// The working state of one coset enumeration (the Hasselgrove-Leech-Trotter strategy).
+// Every generator is a reflection, and so is its own inverse: an entry
+//    table[4*c+i] = d always comes with table[4*d+i] = c.
+class CosetEnumerator
+{
+public:
+	CosetEnumerator(std::vector<int>& theTable, int theMaxCosets)
+		: table(theTable), maxCosets(theMaxCosets) {}
+
+	std::vector<int>& table;
+	std::vector<int> parent;	// For coincidences: parent[c] == c while coset c is alive
+	std::vector<int> queue;		// Cosets found equal to a smaller one, still to be processed
+	int maxCosets;
+	bool overflow = false;
+
+	int NumCosets() const { return (int)parent.size(); }
+	bool IsAlive(int c) const { return parent[c] == c; }
+
+	int NewCoset() {
+		if (NumCosets() >= maxCosets) {
+			overflow = true;
+			return -1;
+		}
+		parent.push_back(NumCosets());
+		table.insert(table.end(), 4, -1);
+		return NumCosets() - 1;
+	}
+
+	int Rep(int c) {
+		int r = c;
+		while (parent[r] != r) {
+			r = parent[r];
+		}
+		while (parent[c] != r) {		// Path compression
+			int next = parent[c];
+			parent[c] = r;
+			c = next;
+		}
+		return r;
+	}
+
+	void Merge(int a, int b) {
+		a = Rep(a);
+		b = Rep(b);
+		if (a != b) {
+			if (a > b) {
+				std::swap(a, b);
+			}
+			parent[b] = a;			// The smaller coset survives
+			queue.push_back(b);
+		}
+	}
+
+	// Cosets a and b turned out to be the same: merge them, and everything that follows.
+	void Coincidence(int a, int b) {
+		queue.clear();
+		Merge(a, b);
+		for (size_t k = 0; k < queue.size(); k++) {
+			int dead = queue[k];
+			for (int i = 0; i < 4; i++) {
+				int d = table[4 * dead + i];
+				if (d < 0) {
+					continue;
+				}
+				table[4 * d + i] = -1;
+				int mu = Rep(dead);
+				int nu = Rep(d);
+				if (table[4 * mu + i] >= 0) {
+					Merge(nu, table[4 * mu + i]);
+				}
+				else if (table[4 * nu + i] >= 0) {
+					Merge(mu, table[4 * nu + i]);
+				}
+				else {
+					table[4 * mu + i] = nu;
+					table[4 * nu + i] = mu;
+				}
+			}
+		}
+	}
+
+	// Traces the relator word from coset c, forwards from its start and backwards from its end.
+	// A single gap is filled in (a deduction); otherwise new cosets are defined to close the gap.
+	void ScanAndFill(int c, const std::vector<int>& word) {
+		int f = c;
+		int b = c;
+		int i = 0;
+		int j = (int)word.size() - 1;
+		while (true) {
+			while (i <= j && table[4 * f + word[i]] >= 0) {
+				f = table[4 * f + word[i]];
+				i++;
+			}
+			if (i > j) {
+				if (f != b) {
+					Coincidence(f, b);
+				}
+				return;
+			}
+			while (j >= i && table[4 * b + word[j]] >= 0) {
+				b = table[4 * b + word[j]];
+				j--;
+			}
+			if (j < i) {
+				Coincidence(f, b);
+				return;
+			}
+			if (i == j) {
+				table[4 * f + word[i]] = b;
+				table[4 * b + word[i]] = f;
+				return;
+			}
+			int d = NewCoset();
+			if (d < 0) {
+				return;
+			}
+			table[4 * f + word[i]] = d;
+			table[4 * d + word[i]] = f;
+		}
+	}
+};
+
+int CoxeterGroup4D::EnumerateCosets(int subgroupMask, std::vector<int>& table, int maxCosets) const
+{
+	// The relators (ri rj)^mij. The relators ri ri hold by the construction of the table.
+	std::vector<std::vector<int>> relators;
+	for (int i = 0; i < 4; i++) {
+		for (int j = i + 1; j < 4; j++) {
+			std::vector<int> word;
+			for (int k = 0; k < m[i][j]; k++) {
+				word.push_back(i);
+				word.push_back(j);
+			}
+			relators.push_back(word);
+		}
+	}
+
+	table.clear();
+	CosetEnumerator e(table, maxCosets);
+	e.NewCoset();
+	for (int i = 0; i < 4; i++) {
+		if (subgroupMask & (1 << i)) {
+			table[i] = 0;			// The subgroup's own mirrors fix coset 0
+		}
+	}
+	for (int c = 0; c < e.NumCosets() && !e.overflow; c++) {
+		for (size_t k = 0; k < relators.size() && e.IsAlive(c) && !e.overflow; k++) {
+			e.ScanAndFill(c, relators[k]);
+		}
+		for (int i = 0; i < 4 && e.IsAlive(c) && !e.overflow; i++) {
+			if (table[4 * c + i] < 0) {
+				int d = e.NewCoset();
+				if (d >= 0) {
+					table[4 * c + i] = d;
+					table[4 * d + i] = c;
+				}
+			}
+		}
+	}
+	if (e.overflow) {
+		table.clear();
+		return 0;
+	}
+
+	// Renumber the cosets that are still alive, in order.
+	int n = e.NumCosets();
+	std::vector<int> newNumber(n, -1);
+	int count = 0;
+	for (int c = 0; c < n; c++) {
+		if (e.IsAlive(c)) {
+			newNumber[c] = count++;
+		}
+	}
+	std::vector<int> compact(4 * count);
+	for (int c = 0; c < n; c++) {
+		if (e.IsAlive(c)) {
+			for (int i = 0; i < 4; i++) {
+				compact[4 * newNumber[c] + i] = newNumber[e.Rep(table[4 * c + i])];
+			}
+		}
+	}
+	table.swap(compact);
+	return count;
+}
+
+// **********************
+// Orbits of vertex sets
+// **********************
+
+void OrbitOfVertexSet(const std::vector<int>& table, const std::vector<int>& seed,
+	std::vector<int>& setStart, std::vector<int>& setVerts)
+{
+	std::set<std::vector<int>> found;		// Sorted vertices of each set found so far
+	setStart.assign(1, 0);
+	setVerts.assign(seed.begin(), seed.end());
+	setStart.push_back((int)seed.size());
+	std::vector<int> key(seed);
+	std::sort(key.begin(), key.end());
+	found.insert(key);
+
+	size_t n = seed.size();
+	std::vector<int> image(n);
+	for (size_t s = 0; s + 1 < setStart.size(); s++) {
+		for (int i = 0; i < 4; i++) {
+			for (size_t k = 0; k < n; k++) {
+				image[k] = table[4 * setVerts[setStart[s] + k] + i];
+			}
+			key = image;
+			std::sort(key.begin(), key.end());
+			if (found.insert(key).second) {
+				setVerts.insert(setVerts.end(), image.begin(), image.end());
+				setStart.push_back((int)setVerts.size());
+			}
+		}
+	}
+}
+
+// **********************
+// RegularPolytope4D
+// **********************
+
+bool RegularPolytope4D::Generate(int p, int q, int r, double edgeLength)
+{
+	if (p < 3 || q < 3 || r < 3) {
+		return false;
+	}
+	// {p,q,r} and its dual {r,q,p} have the same group. The diagram is always set up with
+	//    the larger end first, so that duals come out in matching orientations, and the
+	//    tesseract and the 16-cell have their vertices on the coordinate axes.
+	// node[0] is the mirror that moves the first vertex; node[1], node[2], node[3] fix it.
+	CoxeterGroup4D group;
+	bool reversed = p < r;
+	if (!group.Set(reversed ? r : p, q, reversed ? p : r)) {
+		return false;
+	}
+	int node[4] = { 0, 1, 2, 3 };
+	if (reversed) {
+		for (int k = 0; k < 4; k++) {
+			node[k] = 3 - k;
+		}
+	}
+
+	std::vector<int> table;
+	int numVerts = group.EnumerateCosets(15 & ~(1 << node[0]), table);
+	if (numVerts == 0) {
+		return false;
+	}
+
+	group.PlaceCosets(table, 1 << node[0], edgeLength, verts);
+
+	// Edges: the orbit of the first vertex and its image in the moving mirror.
+	std::vector<int> seed;
+	std::vector<int> edgeStart;
+	seed.push_back(0);
+	seed.push_back(table[node[0]]);
+	OrbitOfVertexSet(table, seed, edgeStart, edges);
+
+	// 2-faces: the orbit of the p-gon around the first vertex. Rotating by node[0] after
+	//    node[1] steps once around it.
+	seed.clear();
+	int c = 0;
+	do {
+		seed.push_back(c);
+		c = table[4 * table[4 * c + node[1]] + node[0]];
+	} while (c != 0);
+	OrbitOfVertexSet(table, seed, faceStart, faceVerts);
+
+	// Cells: the orbit of all the vertices reached from the first one with the first three mirrors.
+	seed.assign(1, 0);
+	for (size_t k = 0; k < seed.size(); k++) {
+		for (int j = 0; j < 3; j++) {
+			int d = table[4 * seed[k] + node[j]];
+			if (std::find(seed.begin(), seed.end(), d) == seed.end()) {
+				seed.push_back(d);
+			}
+		}
+	}
+	std::sort(seed.begin(), seed.end());
+	OrbitOfVertexSet(table, seed, cellStart, cellVerts);
+	for (int i = 0; i < GetNumCells(); i++) {
+		std::sort(cellVerts.begin() + cellStart[i], cellVerts.begin() + cellStart[i + 1]);
+	}
+	return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+//
+// Coxeter4D.h   ---  Header file for Coxeter4D.cpp.
+//
+//   Builds 4-polytopes from their symmetry groups, instead of from typed-in tables.
+//   The symmetries of a regular 4-polytope {p,q,r} are generated by the reflections
+//   r0, r1, r2, r3 in four mirrors, subject only to (ri rj)^mij = identity, where
+//   m01 = p, m12 = q, m23 = r and the other mij are 2 (the Coxeter diagram o-p-o-q-o-r-o).
+//   The vertices are the cosets of the subgroup that fixes one vertex. Todd-Coxeter
+//   coset enumeration lists them and tells how each mirror permutes them.
+//   The edges, 2-faces and cells are then the orbits of one edge, face and cell.
+//
+
+#include <vector>
+
+// The Coxeter group of a linear diagram o-m01-o-m12-o-m23-o, with its mirrors in R^4.
+class CoxeterGroup4D
+{
+public:
+	// Returns false if the group is infinite (no set of four mirrors in R^4 has these angles).
+	bool Set(int m01, int m12, int m23);
+
+	int GetOrder(int i, int j) const { return m[i][j]; }		// mij: ri rj is a rotation by 2*pi/mij
+	const double* GetRoot(int i) const { return roots[i]; }		// Unit normal of mirror i
+	void Reflect(int i, const double* in, double* out) const;	// out = ri(in). in and out may be the same
+
+	// The point that lies on every mirror except those in ringMask (bit i for mirror i),
+	//    at distance 0.5 from each mirror in ringMask, so its reflections in them are
+	//    1 unit away. (The Wythoff construction.)
+	void WythoffPoint(int ringMask, double* point) const;
+
+	// Places the cosets from EnumerateCosets: coset 0 at WythoffPoint(ringMask), and the
+	//    others at its images, all multiplied by scale. verts gets 4 floats per coset.
+	void PlaceCosets(const std::vector<int>& table, int ringMask, double scale, std::vector<float>& verts) const;
+
+	// Todd-Coxeter enumeration of the cosets of the subgroup generated by the mirrors in
+	//    subgroupMask (bit i for mirror i). On return, table[4*c+i] is the coset that
+	//    mirror i takes coset c to; coset 0 is the subgroup itself.
+	// Returns the number of cosets, or 0 if more than maxCosets were needed.
+	int EnumerateCosets(int subgroupMask, std::vector<int>& table, int maxCosets = 1 << 20) const;
+
+private:
+	int m[4][4];
+	double roots[4][4];
+};
+
+// A regular 4-polytope, with its vertices, edges, 2-faces and cells.
+class RegularPolytope4D
+{
+public:
+	// Builds {p,q,r}, centered at the origin, with the given edge length.
+	// Returns false if {p,q,r} is not a regular 4-polytope.
+	bool Generate(int p, int q, int r, double edgeLength);
+
+	int GetNumVerts() const { return (int)verts.size() / 4; }
+	const float* GetVerts() const { return verts.data(); }		// 4 floats per vertex
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge
+
+	// The vertices of 2-face i, in order around it
+	int GetNumFaces() const { return (int)faceStart.size() - 1; }
+	int GetFaceSize(int i) const { return faceStart[i + 1] - faceStart[i]; }
+	const int* GetFace(int i) const { return faceVerts.data() + faceStart[i]; }
+
+	// The vertices of cell i, in increasing order
+	int GetNumCells() const { return (int)cellStart.size() - 1; }
+	int GetCellSize(int i) const { return cellStart[i + 1] - cellStart[i]; }
+	const int* GetCell(int i) const { return cellVerts.data() + cellStart[i]; }
+
+private:
+	std::vector<float> verts;
+	std::vector<int> edges;
+	std::vector<int> faceStart;		// Face i is faceVerts[faceStart[i]] up to faceVerts[faceStart[i+1]-1]
+	std::vector<int> faceVerts;
+	std::vector<int> cellStart;		// Likewise for the cells
+	std::vector<int> cellVerts;
+};
+
+// The orbit of the vertex set seed under the permutations in table (4 per vertex,
+//    as from EnumerateCosets). Each set found is appended to setVerts, with its
+//    start in setStart; the vertex order within each set is kept.
+// Sets with the same vertices in a different order count as the same set.
+void OrbitOfVertexSet(const std::vector<int>& table, const std::vector<int>& seed,
+	std::vector<int>& setStart, std::vector<int>& setVerts);
@@ -0,0 +1,257 @@
+//
+//  EdgeFinder4D.cpp
+//
+//   Edge discovery for 4D vertex sets with a uniform grid hash. See EdgeFinder4D.h.
+//
+
+#include "EdgeFinder4D.h"
+#include <math.h>
+#include <float.h>
+#include <thread>
+
+// **********************
+// The vertices, bucketed by the grid cell they fall in.
+// Each cell is hashed to one of numBuckets buckets, and a bucket may hold
+//    vertices of several cells, so the cell of each vertex is kept too.
+// **********************
+class Grid4D
+{
+public:
+	// Returns false if the cells would be too small for int cell coordinates.
+	bool Build(const float* verts, int numVerts, double cellSize);
+
+	int GetNumOccupiedBuckets() const { return numOccupied; }
+
+	// Calls visit(j) for vertices j in the 81 cells around vertex i, so that
+	//    each pair of vertices in neighboring cells is visited from just one of them.
+	template <class Visitor>
+	void ForNeighbors(int i, Visitor& visit) const;
+
+private:
+	unsigned int Hash(int c0, int c1, int c2, int c3) const
+	{
+		return ((unsigned int)c0 * 73856093u ^ (unsigned int)c1 * 19349663u
+			^ (unsigned int)c2 * 83492791u ^ (unsigned int)c3 * 2654435761u) & bucketMask;
+	}
+
+	unsigned int bucketMask;		// The number of buckets, minus 1 (a power of 2)
+	int numOccupied;
+	std::vector<int> cells;			// 4 cell coordinates per vertex
+	std::vector<int> bucketStart;	// Bucket b is bucketVerts[bucketStart[b]] up to bucketVerts[bucketStart[b+1]-1]
+	std::vector<int> bucketVerts;
+};
+
+bool Grid4D::Build(const float* verts, int numVerts, double cellSize)
+{
+	double lo[4] = { DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX };
+	double hi[4] = { -DBL_MAX, -DBL_MAX, -DBL_MAX, -DBL_MAX };
+	for (int i = 0; i < numVerts; i++) {
+		for (int k = 0; k < 4; k++) {
+			lo[k] = fmin(lo[k], verts[4 * i + k]);
+			hi[k] = fmax(hi[k], verts[4 * i + k]);
+		}
+	}
+	for (int k = 0; k < 4; k++) {
+		if ((hi[k] - lo[k]) / cellSize > 1.0e9) {
+			return false;
+		}
+	}
+
+	unsigned int numBuckets = 1;
+	while (numBuckets < 2 * (unsigned int)numVerts) {
+		numBuckets <<= 1;
+	}
+	bucketMask = numBuckets - 1;
+
+	// Counting sort of the vertices by bucket.
+	cells.resize(4 * numVerts);
+	std::vector<unsigned int> bucketOf(numVerts);
+	bucketStart.assign(numBuckets + 1, 0);
+	for (int i = 0; i < numVerts; i++) {
+		int* c = &cells[4 * i];
+		for (int k = 0; k < 4; k++) {
+			c[k] = (int)floor((verts[4 * i + k] - lo[k]) / cellSize);
+		}
+		bucketOf[i] = Hash(c[0], c[1], c[2], c[3]);
+		bucketStart[bucketOf[i] + 1]++;
+	}
+	numOccupied = 0;
+	for (unsigned int b = 0; b < numBuckets; b++) {
+		numOccupied += (bucketStart[b + 1] > 0);
+		bucketStart[b + 1] += bucketStart[b];
+	}
+	bucketVerts.resize(numVerts);
+	std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+	for (int i = 0; i < numVerts; i++) {
+		bucketVerts[fill[bucketOf[i]]++] = i;
+	}
+	return true;
+}
+
+template <class Visitor>
+void Grid4D::ForNeighbors(int i, Visitor& visit) const
+{
+	// Only the 40 neighboring cells that come after the cell of i (in lexicographic order)
+	//    are looked at, and the vertices after i in its own cell, so each pair is seen once.
+	const int* c = &cells[4 * i];
+	for (int offset = 40; offset < 81; offset++) {
+		int n0 = c[0] + offset / 27 - 1;
+		int n1 = c[1] + (offset / 9) % 3 - 1;
+		int n2 = c[2] + (offset / 3) % 3 - 1;
+		int n3 = c[3] + offset % 3 - 1;
+		unsigned int b = Hash(n0, n1, n2, n3);
+		for (int s = bucketStart[b]; s < bucketStart[b + 1]; s++) {
+			int j = bucketVerts[s];
+			const int* cj = &cells[4 * j];
+			if (cj[0] == n0 && cj[1] == n1 && cj[2] == n2 && cj[3] == n3 && (offset > 40 || j > i)) {
+				visit(j);
+			}
+		}
+	}
+}
+
+// **********************
+// Runs work(first, last, t) for vertex ranges, each on its own thread t.
+// Small vertex sets are done on the calling thread.
+// **********************
+template <class Work>
+static int RunInParallel(int numVerts, Work work)
+{
+	int numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads < 1 || numVerts < 4096) {
+		numThreads = 1;
+	}
+	if (numThreads == 1) {
+		work(0, numVerts, 0);
+		return 1;
+	}
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++) {
+		int first = (int)((long long)numVerts * t / numThreads);
+		int last = (int)((long long)numVerts * (t + 1) / numThreads);
+		threads.push_back(std::thread(work, first, last, t));
+	}
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+	return numThreads;
+}
+
+static double DistSq(const float* a, const float* b)
+{
+	double d0 = a[0] - b[0], d1 = a[1] - b[1], d2 = a[2] - b[2], d3 = a[3] - b[3];
+	return d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3;
+}
+
+double MinDistance4D(const float* verts, int numVerts)
+{
+	if (numVerts < 2) {
+		return 0.0;
+	}
+	double extent = 0.0;
+	for (int k = 0; k < 4; k++) {
+		double lo = DBL_MAX, hi = -DBL_MAX;
+		for (int i = 0; i < numVerts; i++) {
+			lo = fmin(lo, verts[4 * i + k]);
+			hi = fmax(hi, verts[4 * i + k]);
+		}
+		extent = fmax(extent, hi - lo);
+	}
+	if (extent == 0.0) {
+		return 0.0;
+	}
+
+	// Start with about one vertex per cell if they filled a 4D box, then make the cells
+	//    smaller while they are crowded (vertices on a surface or a curve), and larger
+	//    while no vertex has a neighbor. Any pair closer than the cell size is in
+	//    neighboring cells, so a minimum found below the cell size is the true one.
+	double cellSize = extent / pow((double)numVerts, 0.25);
+	Grid4D grid;
+	bool mayShrink = true;
+	std::vector<double> threadMin(std::thread::hardware_concurrency() + 1);
+	for (int tries = 0; tries < 200; tries++) {
+		if (!grid.Build(verts, numVerts, cellSize)) {
+			return 0.0;
+		}
+		if (mayShrink && numVerts > 4 * grid.GetNumOccupiedBuckets() && cellSize > 1.0e-6 * extent) {
+			cellSize *= 0.5;
+			continue;
+		}
+		for (size_t t = 0; t < threadMin.size(); t++) {
+			threadMin[t] = DBL_MAX;
+		}
+		RunInParallel(numVerts, [&](int first, int last, int t) {
+			double minSq = DBL_MAX;
+			for (int i = first; i < last; i++) {
+				const float* a = verts + 4 * i;
+				auto visit = [&](int j) {
+					double dSq = DistSq(a, verts + 4 * j);
+					if (dSq > 0.0 && dSq < minSq) {
+						minSq = dSq;
+					}
+				};
+				grid.ForNeighbors(i, visit);
+			}
+			threadMin[t] = minSq;
+		});
+		double minSq = DBL_MAX;
+		for (size_t t = 0; t < threadMin.size(); t++) {
+			minSq = fmin(minSq, threadMin[t]);
+		}
+		if (minSq <= cellSize * cellSize) {
+			return sqrt(minSq);
+		}
+		if (cellSize > 2.0 * extent) {
+			return 0.0;			// Only one distinct vertex
+		}
+		// Either no pair was found, or the closest one found may not be the closest of all.
+		mayShrink = false;
+		cellSize = (minSq < DBL_MAX) ? sqrt(minSq) * 1.000001 : 2.0 * cellSize;
+	}
+	return 0.0;
+}
+
+double FindEdges4D(const float* verts, int numVerts, std::vector<int>& edges,
+	double edgeLength, double tolerance)
+{
+	edges.clear();
+	if (edgeLength <= 0.0) {
+		edgeLength = MinDistance4D(verts, numVerts);
+		if (edgeLength == 0.0) {
+			return 0.0;
+		}
+	}
+	double maxLen = edgeLength * (1.0 + tolerance);
+	double minLen = edgeLength * (1.0 - tolerance);
+	double maxSq = maxLen * maxLen;
+	double minSq = fmax(minLen, 0.0) * fmax(minLen, 0.0);
+
+	Grid4D grid;
+	if (!grid.Build(verts, numVerts, maxLen)) {
+		return 0.0;
+	}
+	std::vector<std::vector<int> > threadEdges(std::thread::hardware_concurrency() + 1);
+	int numThreads = RunInParallel(numVerts, [&](int first, int last, int t) {
+		std::vector<int>& found = threadEdges[t];
+		for (int i = first; i < last; i++) {
+			const float* a = verts + 4 * i;
+			auto visit = [&](int j) {
+				double dSq = DistSq(a, verts + 4 * j);
+				if (dSq > 0.0 && dSq >= minSq && dSq <= maxSq) {
+					found.push_back(i < j ? i : j);
+					found.push_back(i < j ? j : i);
+				}
+			};
+			grid.ForNeighbors(i, visit);
+		}
+	});
+	size_t total = 0;
+	for (int t = 0; t < numThreads; t++) {
+		total += threadEdges[t].size();
+	}
+	edges.reserve(total);
+	for (int t = 0; t < numThreads; t++) {
+		edges.insert(edges.end(), threadEdges[t].begin(), threadEdges[t].end());
+	}
+	return edgeLength;
+}
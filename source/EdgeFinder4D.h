@@ -0,0 +1,26 @@
+#pragma once
+
+//
+// EdgeFinder4D.h   ---  Header file for EdgeFinder4D.cpp.
+//
+//   Finds the edges of a bare 4D vertex set: all pairs of vertices at the
+//   edge length, which by default is the smallest distance between two vertices.
+//   This is right for the uniform polytopes, whose edges all have one length.
+//   The vertices are hashed into a uniform grid of cells in R^4, so each vertex
+//   is compared only with the vertices in the 3^4 = 81 cells around its own.
+//   The expected time is linear in the number of vertices (and edges), and the
+//   vertices are split among threads.
+//
+
+#include <vector>
+
+// The smallest nonzero distance between two of the vertices (4 floats each).
+// Returns 0 if there are fewer than two distinct vertices.
+double MinDistance4D(const float* verts, int numVerts);
+
+// Puts into edges (2 vertex indices per edge, smaller index first) every pair of
+//    vertices whose distance is within tolerance*edgeLength of edgeLength.
+//    If edgeLength <= 0, MinDistance4D is used.
+// Returns the edge length used, or 0 if there are fewer than two distinct vertices.
+double FindEdges4D(const float* verts, int numVerts, std::vector<int>& edges,
+	double edgeLength = 0.0, double tolerance = 1.0e-3);
@@ -23,6 +23,7 @@
 
 #include "EduPhong.h"
 #include "GlShaderMgr.h"
+#include "GlStateCache.h"
 
 #include <GL/glew.h> 
 #include <GLFW/glfw3.h>
@@ -49,16 +50,17 @@ const unsigned int phUseFresnel_loc = 8;               // Corresponds to "locati
 
 /* *** 
  * Functions for uniform variable locations
+ *   These are looked up in GlShaderMgr's cache, filled when the program was linked.
  * *** */
 
 unsigned int phGetProjMatLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phProjMatName);
+    return GlShaderMgr::GetUniformLocation(programID, phProjMatName);
 }
 unsigned int phGetModelviewMatLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phModelviewMatName);
+    return GlShaderMgr::GetUniformLocation(programID, phModelviewMatName);
 }
 unsigned int phGetApplyTextureLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phApplyTextureName);
+    return GlShaderMgr::GetUniformLocation(programID, phApplyTextureName);
 }
 
 const char* globallightBlockName= "phGlobal";       // Name of the global light uniform block
@@ -133,9 +135,9 @@ bool phRegisterShaderProgram(unsigned int programID)
     glUniformBlockBinding(programID, globallightBlockIndex, 0);      // Buffer binding 0 for global lights
     glUniformBlockBinding(programID, lightsBlockIndex, 1);           // Buffer binding 1 for lights
 
-    glUseProgram(programID);
+    GlStateCache::UseProgram(programID);
     unsigned int applyTextureLocation = phGetApplyTextureLoc(programID);
-    glUniform1i(applyTextureLocation, 0); // Default is to  not apply the texture
+    GlStateCache::Uniform1i(applyTextureLocation, 0); // Default is to  not apply the texture
 
     if (shaderLayoutInfoKnown) {
         return true;
@@ -21,6 +21,23 @@
 //           (Does not do the Phong lighting itself.)
 //    fragmentShader_PhongPhong
 //         - Fragment shader for Phong lighting with Phong shading.
+//    vertexShader_PhongPhongInstanced
+//         - Same as vertexShader_PhongPhong, but with a per-instance
+//           model matrix (used with glDrawElementsInstanced).
+//    vertexShader_PolytopeGpu
+//         - Same outputs as vertexShader_PhongPhong, but places a polytope
+//           vertex sphere or edge cylinder itself, from the unit 4D vertices
+//           and edge list stored in texture buffers and a 4x4 rotation.
+//    vertexShader_PhongPhongIndirect, fragmentShader_PhongPhongIndirect
+//         - For drawing the whole scene with glMultiDrawElementsIndirect.
+//           Each instance reads its modelview matrix, material and texture
+//           choice from a shader storage buffer. (Needs OpenGL 4.3.)
+//    vertexShader_Impostor, fragmentShader_Impostor
+//         - Ray-cast impostors for the polytope's vertex spheres and edge cylinders.
+//           A quad (sphere) or box (cylinder) is drawn around each primitive and
+//           the fragment shader intersects the view ray with the exact surface,
+//           writing its depth. Compile the fragment shader with calcPhongLighting
+//           and applyTextureMap.
 //
 // Code blocks for common use (Phong lighting and Texture mapping)
 //    calcPhongLighting 
@@ -29,6 +46,9 @@
 //    applyTextureMap 
 //         - defines the function applyTextureFunction()
 //           which applies a bitmapped texture map
+//    skeletonColoring
+//         - defines the function SkeletonColor(), the color of a graph distance
+//           or color number from SkeletonGraph4D (for the polytope shaders)
 
 
 
@@ -78,6 +98,355 @@ void main()
 }
 #endglsl
 
+// **************
+// The vertex shader for Phong lighting with Phong shading, for instanced drawing.
+//   Identical to vertexShader_PhongPhong, except that each instance supplies
+//   its own model matrix (in attribute locations 9-12) which is applied
+//   before the modelview matrix.
+// **************
+#beginglsl vertexshader vertexShader_PhongPhongInstanced
+#version 330 core
+layout (location = 0) in vec3 vertPos;         // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;      // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;   // Texture coordinates in attribute location 2
+layout (location = 3) in vec3 EmissiveColor;   // Surface material properties 
+layout (location = 4) in vec3 AmbientColor; 
+layout (location = 5) in vec3 DiffuseColor; 
+layout (location = 6) in vec3 SpecularColor; 
+layout (location = 7) in float SpecularExponent; 
+layout (location = 8) in float UseFresnel;		// Shold be 1.0 (for Fresnel) or 0.0 (for no Fresnel)
+layout (location = 9) in mat4 instanceMatrix;	// Per-instance model matrix (uses locations 9,10,11,12)
+
+out vec3 mvPos;         // Vertex position in modelview coordinates
+out vec3 mvNormalFront; // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+
+uniform mat4 projectionMatrix;        // The projection matrix
+uniform mat4 modelviewMatrix;         // The modelview matrix (shared by all instances)
+
+void main()
+{
+    mat4 mvMatrix = modelviewMatrix * instanceMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0); 
+    gl_Position = projectionMatrix * mvPos4; 
+    mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
+    mvNormalFront = normalize(inverse(transpose(mat3(mvMatrix)))*vertNormal); // Unit normal from the surface 
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    theTexCoords = vertTexCoords;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
+// **************
+// The vertex shader for a GPU-resident polytope, with Phong shading.
+//   The unit polytope's 4D vertices and its edges are stored once in two
+//   texture buffers. Instance number gl_InstanceID selects the vertex
+//   (primitiveKind == 0, drawing spheres) or the edge (primitiveKind == 1,
+//   drawing cylinders). The vertex is rotated in 4D by rotation4 and
+//   orthogonally projected to xyz, then the sphere or cylinder is placed
+//   in the polytope's frame; modelviewMatrix maps that frame to view space.
+//   The cylinder placement matches CalcEdgeMatrix() in MyGeometries.cpp.
+//   When morphing, unitVerts instead holds four texels per vertex, the images
+//   of the corners of the fundamental simplex (see WythoffMorph4D), and the
+//   vertex is their sum weighted by wythoffWeights, moved out to morphRadius.
+//   Edges that shrink to a point are not drawn.
+//   When skeletonColoring is on, the vertex or edge takes its diffuse and ambient
+//   colors from its value in vertAttribs or edgeAttribs. Compile with skeletonColoring.
+// **************
+#beginglsl vertexshader vertexShader_PolytopeGpu
+#version 330 core
+layout (location = 0) in vec3 vertPos;         // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;      // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;   // Texture coordinates in attribute location 2
+layout (location = 3) in vec3 EmissiveColor;   // Surface material properties 
+layout (location = 4) in vec3 AmbientColor; 
+layout (location = 5) in vec3 DiffuseColor; 
+layout (location = 6) in vec3 SpecularColor; 
+layout (location = 7) in float SpecularExponent; 
+layout (location = 8) in float UseFresnel;		// Shold be 1.0 (for Fresnel) or 0.0 (for no Fresnel)
+
+out vec3 mvPos;         // Vertex position in modelview coordinates
+out vec3 mvNormalFront; // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+
+uniform mat4 projectionMatrix;        // The projection matrix
+uniform mat4 modelviewMatrix;         // The modelview matrix of the polytope's frame
+
+uniform samplerBuffer unitVerts;      // Unit polytope vertices (x,y,z,w), one texel per vertex
+uniform isamplerBuffer edgeEnds;      // Edges as pairs of vertex indices, one texel per edge
+uniform mat4 rotation4;               // Composed 4D rotation
+uniform float vertScale;              // Scales the unit polytope
+uniform float shapeRadius;            // Radius of the spheres (and relative radius of the cylinders)
+uniform int primitiveKind;            // 0 = vertex spheres, 1 = edge cylinders
+uniform bool morphing;                // Whether unitVerts holds the corner images of a morph
+uniform vec4 wythoffWeights;          // Weights of the four corners, when morphing
+uniform float morphRadius;            // Circumradius of the morph, in unit polytope units
+uniform samplerBuffer vertAttribs;    // Skeleton value of each vertex (-1 for none)
+uniform samplerBuffer edgeAttribs;    // Skeleton value of each edge (-1 for none)
+uniform int skeletonColoring;         // 0 for the usual colors (see the skeletonColoring code block)
+uniform float skeletonScale;
+
+vec3 SkeletonColor(float value, vec3 defaultColor);
+
+vec3 RotatedVertex(int i) {
+    vec4 v;
+    if ( morphing ) {
+        mat4 corners = mat4(texelFetch(unitVerts, 4*i), texelFetch(unitVerts, 4*i+1),
+                            texelFetch(unitVerts, 4*i+2), texelFetch(unitVerts, 4*i+3));
+        v = morphRadius * normalize(corners * wythoffWeights);
+    }
+    else {
+        v = texelFetch(unitVerts, i);
+    }
+    return vertScale * (rotation4 * v).xyz;
+}
+
+void main()
+{
+    vec3 modelPos;
+    vec3 modelNormal;
+    if ( primitiveKind == 0 ) {
+        modelPos = RotatedVertex(gl_InstanceID) + shapeRadius * vertPos;
+        modelNormal = vertNormal;
+    }
+    else {
+        ivec2 ends = texelFetch(edgeEnds, gl_InstanceID).xy;
+        vec3 p1 = RotatedVertex(ends.x);
+        vec3 p2 = RotatedVertex(ends.y);
+        vec3 d = p2 - p1;
+        float len = length(d);
+        // Rotate the y-axis onto the edge direction. The cylinder is symmetric,
+        //    so the direction is flipped to the upper hemisphere to keep this stable.
+        vec3 b = (len > 0.0) ? d / len : vec3(0.0, 1.0, 0.0);
+        if ( b.y < 0.0 ) {
+            b = -b;
+        }
+        vec3 v = vec3(b.z, 0.0, -b.x);                  // cross((0,1,0), b)
+        mat3 K = mat3(0.0, v.z, -v.y,  -v.z, 0.0, v.x,  v.y, -v.x, 0.0);
+        mat3 R = mat3(1.0) + K + K * K / (1.0 + b.y);   // Rodrigues' formula
+        vec3 scale = vec3(0.8 * shapeRadius, 0.5 * len, 0.8 * shapeRadius);
+        if ( len < 1.0e-4 * vertScale ) {
+            scale = vec3(0.0);      // A morph's edge, shrunk to a point: all its triangles are degenerate
+        }
+        modelPos = 0.5 * (p1 + p2) + R * (scale * vertPos);
+        modelNormal = R * (vertNormal / max(scale, vec3(1.0e-6)));
+    }
+    vec4 mvPos4 = modelviewMatrix * vec4(modelPos, 1.0); 
+    gl_Position = projectionMatrix * mvPos4; 
+    mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
+    mvNormalFront = normalize(inverse(transpose(mat3(modelviewMatrix)))*modelNormal); // Unit normal from the surface 
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    if ( skeletonColoring != 0 ) {
+        float value = primitiveKind == 0 ? texelFetch(vertAttribs, gl_InstanceID).x
+                                         : texelFetch(edgeAttribs, gl_InstanceID).x;
+        if ( value >= 0.0 ) {
+            matDiffuse = SkeletonColor(value, DiffuseColor);
+            matAmbient = 0.3 * matDiffuse;
+        }
+    }
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    theTexCoords = vertTexCoords;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
+// **************
+// The vertex shader for Phong lighting with Phong shading, for multi-draw-indirect.
+//   All per-object data comes from the phDrawRecords storage buffer.
+//   The record number is an instanced attribute (location 9) holding 0,1,2,...,
+//   so that the draw command's baseInstance selects the first record of the draw.
+//   The polytope's spheres and cylinders are not given a record each: a draw whose
+//   first record has Flags.w 1 (spheres) or 2 (cylinders) uses that one record for
+//   all its instances, and places each instance itself from unitVerts and edgeEnds,
+//   as vertexShader_PolytopeGpu does. Its modelview matrix is the polytope's frame.
+// **************
+#beginglsl vertexshader vertexShader_PhongPhongIndirect
+#version 430 core
+layout (location = 0) in vec3 vertPos;         // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;      // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;   // Texture coordinates in attribute location 2
+layout (location = 9) in int drawRecord;       // Per-instance record number
+
+struct phDrawRecord {
+    mat4 modelviewMatrix;
+    vec4 EmissiveColor;
+    vec4 AmbientColor;
+    vec4 DiffuseColor;
+    vec4 SpecularColor;         // w is the specular exponent
+    ivec4 Flags;                // x: texture kind, y: texture number, z: use Fresnel,
+                                //    w: 0, or 1 for the polytope's spheres, 2 for its cylinders
+};
+layout (std430, binding = 0) readonly buffer phDrawRecords {
+    phDrawRecord drawRecords[];
+};
+
+out vec3 mvPos;         // Vertex position in modelview coordinates
+out vec3 mvNormalFront; // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+flat out int textureKind;
+flat out int textureNum;
+
+uniform mat4 projectionMatrix;        // The projection matrix
+
+uniform samplerBuffer unitVerts;      // As in vertexShader_PolytopeGpu (never a morph here)
+uniform isamplerBuffer edgeEnds;
+uniform mat4 rotation4;
+uniform float vertScale;
+uniform float shapeRadius;
+
+vec3 RotatedVertex(int i) {
+    return vertScale * (rotation4 * texelFetch(unitVerts, i)).xyz;
+}
+
+void main()
+{
+    int record = drawRecord - gl_InstanceID;        // The first record of the draw
+    int polytopeKind = drawRecords[record].Flags.w;
+    vec3 modelPos = vertPos;
+    vec3 modelNormal = vertNormal;
+    if ( polytopeKind == 0 ) {
+        record = drawRecord;
+    }
+    else if ( polytopeKind == 1 ) {
+        modelPos = RotatedVertex(gl_InstanceID) + shapeRadius * vertPos;
+    }
+    else {
+        ivec2 ends = texelFetch(edgeEnds, gl_InstanceID).xy;
+        vec3 p1 = RotatedVertex(ends.x);
+        vec3 p2 = RotatedVertex(ends.y);
+        vec3 d = p2 - p1;
+        float len = length(d);
+        // Rotate the y-axis onto the edge direction, as in vertexShader_PolytopeGpu.
+        vec3 b = (len > 0.0) ? d / len : vec3(0.0, 1.0, 0.0);
+        if ( b.y < 0.0 ) {
+            b = -b;
+        }
+        vec3 v = vec3(b.z, 0.0, -b.x);                  // cross((0,1,0), b)
+        mat3 K = mat3(0.0, v.z, -v.y,  -v.z, 0.0, v.x,  v.y, -v.x, 0.0);
+        mat3 R = mat3(1.0) + K + K * K / (1.0 + b.y);   // Rodrigues' formula
+        vec3 scale = vec3(0.8 * shapeRadius, 0.5 * len, 0.8 * shapeRadius);
+        modelPos = 0.5 * (p1 + p2) + R * (scale * vertPos);
+        modelNormal = R * (vertNormal / max(scale, vec3(1.0e-6)));
+    }
+    mat4 mvMatrix = drawRecords[record].modelviewMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(modelPos, 1.0); 
+    gl_Position = projectionMatrix * mvPos4; 
+    mvPos = vec3(mvPos4.x,mvPos4.y,mvPos4.z)/mvPos4.w; 
+    mvNormalFront = normalize(inverse(transpose(mat3(mvMatrix)))*modelNormal); // Unit normal from the surface 
+    matEmissive = drawRecords[record].EmissiveColor.xyz;
+    matAmbient = drawRecords[record].AmbientColor.xyz;
+    matDiffuse = drawRecords[record].DiffuseColor.xyz;
+    matSpecular = drawRecords[record].SpecularColor.xyz;
+    matSpecExponent = drawRecords[record].SpecularColor.w;
+    theTexCoords = vertTexCoords;
+    useFresnel = float(drawRecords[record].Flags.z);
+    textureKind = drawRecords[record].Flags.x;
+    textureNum = drawRecords[record].Flags.y;
+}
+#endglsl
+
+// **************
+// The vertex shader for ray-cast sphere and cylinder impostors.
+//   primitiveKind 0: a sphere. vertPos.xy in [-1,1] is a corner of a quad facing the
+//       viewer, made large enough to cover the sphere's perspective outline.
+//   primitiveKind 1: a capped cylinder. vertPos in [-1,1]^3 is a corner of the box
+//       around the cylinder; y runs along the axis, as in GlGeomCylinder.
+//   The per-instance endpoints are in the coordinates of modelviewMatrix.
+// **************
+#beginglsl vertexshader vertexShader_Impostor
+#version 330 core
+layout (location = 0) in vec3 vertPos;         // Corner of the proxy quad or box
+layout (location = 3) in vec3 EmissiveColor;   // Surface material properties 
+layout (location = 4) in vec3 AmbientColor; 
+layout (location = 5) in vec3 DiffuseColor; 
+layout (location = 6) in vec3 SpecularColor; 
+layout (location = 7) in float SpecularExponent; 
+layout (location = 8) in float UseFresnel;		// Shold be 1.0 (for Fresnel) or 0.0 (for no Fresnel)
+layout (location = 9) in vec3 instanceP0;      // Sphere center, or one end of the cylinder's axis
+layout (location = 10) in vec3 instanceP1;     // The other end of the cylinder's axis
+
+out vec3 proxyPos;          // Point on the proxy, in modelview coordinates
+flat out vec3 mvP0;         // Center or axis ends, in modelview coordinates
+flat out vec3 mvP1;
+flat out vec3 objAxis;      // Cylinder axis, in model coordinates (for texture coordinates)
+flat out float mvRadius;
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out float useFresnel;
+
+uniform mat4 projectionMatrix;        // The projection matrix
+uniform mat4 modelviewMatrix;         // The modelview matrix (must not have non-uniform scaling)
+uniform float shapeRadius;            // Radius in model coordinates
+uniform int primitiveKind;            // 0 for spheres, 1 for cylinders
+
+// Two unit vectors perpendicular to w (a unit vector) and to each other.
+void perpendiculars(vec3 w, out vec3 u, out vec3 v) {
+    vec3 other = abs(w.x) < 0.9 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+    u = normalize(cross(other, w));
+    v = cross(w, u);
+}
+
+void main()
+{
+    mvP0 = (modelviewMatrix * vec4(instanceP0, 1.0)).xyz;
+    mvP1 = (modelviewMatrix * vec4(instanceP1, 1.0)).xyz;
+    objAxis = instanceP1 - instanceP0;
+    mvRadius = shapeRadius * length(modelviewMatrix[0].xyz);
+    vec3 u, v;
+    if ( primitiveKind == 0 ) {
+        float d = length(mvP0);
+        vec3 toEye = -mvP0 / d;
+        perpendiculars(toEye, u, v);        // The quad is counterclockwise as seen from the eye
+        // The outline of a sphere seen from distance d is a circle of this radius in the center plane
+        float halfSize = mvRadius * d / sqrt(max(d*d - mvRadius*mvRadius, 1e-6));
+        proxyPos = mvP0 + halfSize*(vertPos.x*u + vertPos.y*v);
+    }
+    else {
+        vec3 axis = mvP1 - mvP0;
+        float len = length(axis);
+        vec3 w = len > 0.0 ? axis/len : vec3(0.0, 1.0, 0.0);
+        perpendiculars(w, u, v);
+        // (u, w, -v) is right-handed, so the box's outward faces stay counterclockwise for culling
+        proxyPos = 0.5*(mvP0 + mvP1) + mvRadius*(vertPos.x*u - vertPos.z*v) + 0.5*len*vertPos.y*w;
+    }
+    gl_Position = projectionMatrix * vec4(proxyPos, 1.0); 
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
 // **************
 // The base code for the fragment shader for Phong lighting with Phong shading.
 //   This does all the hard work of the Phong lighting by calling CalculatePhongLighting()
@@ -154,6 +523,376 @@ void main() {
 }
 #endglsl
 
+// **************
+// The fragment shader for multi-draw-indirect (see vertexShader_PhongPhongIndirect).
+//   Compile it with calcPhongLighting and MyProcTexture: instead of the
+//   applyTexture uniform, each draw record chooses
+//      textureKind 0: no texture
+//      textureKind 1: the bitmap sceneTextures[textureNum]
+//      textureKind 2: the procedural texture applyTextureFunction()
+// **************
+#beginglsl fragmentshader fragmentShader_PhongPhongIndirect
+#version 430 core
+
+in vec3 mvPos;         // Vertex position in modelview coordinates
+in vec3 mvNormalFront; // Normal vector to vertex (front facing) in modelview coordinates
+in vec3 matEmissive;
+in vec3 matAmbient;
+in vec3 matDiffuse;
+in vec3 matSpecular;
+in float matSpecExponent;
+in float useFresnel;
+flat in int textureKind;
+flat in int textureNum;
+
+layout (std140) uniform phGlobal { 
+    vec3 GlobalAmbientColor;        // Global ambient light color 
+    int NumLights;                  // Number of lights 
+    bool LocalViewer;               // true for local viewer; false for directional viewer 
+    bool EnableEmissive;            // Control whether emissive colors are rendered 
+    bool EnableDiffuse;             // Control whether diffuse colors are rendered 
+    bool EnableAmbient;             // Control whether ambient colors are rendered 
+    bool EnableSpecular;            // Control whether specular colors are rendered 
+	bool UseHalfwayVector;			// Control whether halfway vector method is used
+};
+
+const int MaxLights = 8;        // The maximum number of lights (must match value in C++ code)
+struct phLight { 
+    bool IsEnabled;             // True if light is turned on 
+    bool IsAttenuated;          // True if attenuation is active 
+    bool IsSpotLight;           // True if spotlight 
+    bool IsDirectional;         // True if directional 
+    vec3 Position; 
+    vec3 AmbientColor; 
+    vec3 DiffuseColor; 
+    vec3 SpecularColor; 
+    vec3 SpotDirection;         // Should be unit vector! 
+    float SpotCosCutoff;        // Cosine of cutoff angle 
+    float SpotExponent; 
+    float ConstantAttenuation; 
+    float LinearAttenuation; 
+    float QuadraticAttenuation; 
+};
+layout (std140) uniform phLightArray { 
+    phLight Lights[MaxLights];
+};
+
+vec3 mvNormal; 
+in vec2 theTexCoords;          // Texture coordinates (interpolated from vertex shader) 
+uniform sampler2D theTextureMap;        // Used by the procedural texture
+uniform sampler2D sceneTextures[3];     // Bitmaps selected by textureNum
+
+vec3 nonspecColor;
+vec3 specularColor;  
+out vec4 fragmentColor;         // Color that will be used for the fragment
+
+void CalculatePhongLighting();  // Calculates: nonspecColor and specularColor. 
+vec4 applyTextureFunction();
+
+void main() { 
+    if ( gl_FrontFacing ) {
+        mvNormal = mvNormalFront;
+    }
+    else {
+        mvNormal = -mvNormalFront;
+    }
+
+    CalculatePhongLighting();       // Calculates: nonspecColor and specularColor. 
+    fragmentColor = vec4(nonspecColor+specularColor, 1.0f);   // Add alpha value of 1.0.
+    if ( textureKind == 1 ) {
+        vec4 texColor;
+        switch ( textureNum ) {     // Constant indices: textureNum need not be dynamically uniform
+            case 0:
+                texColor = texture(sceneTextures[0], theTexCoords);
+                break;
+            case 1:
+                texColor = texture(sceneTextures[1], theTexCoords);
+                break;
+            default:
+                texColor = texture(sceneTextures[2], theTexCoords);
+                break;
+        }
+        fragmentColor = vec4(nonspecColor, 1.0f)*texColor + vec4(specularColor,0.0);
+    }
+    else if ( textureKind == 2 ) {
+        fragmentColor = applyTextureFunction();
+    }
+}
+#endglsl
+
+// **************
+// The fragment shader for ray-cast sphere and cylinder impostors (see vertexShader_Impostor).
+//   The ray from the eye (the origin, in modelview coordinates) through proxyPos is
+//   intersected with the exact sphere or capped cylinder. Fragments that miss are
+//   discarded. The hit point gives the position, normal, texture coordinates and depth
+//   used for the Phong lighting.
+//   Texture coordinates follow GlGeomSphere and GlGeomCylinder.
+// **************
+#beginglsl fragmentshader fragmentShader_Impostor
+#version 330 core
+
+in vec3 proxyPos;
+flat in vec3 mvP0;
+flat in vec3 mvP1;
+flat in vec3 objAxis;
+flat in float mvRadius;
+in vec3 matEmissive;
+in vec3 matAmbient;
+in vec3 matDiffuse;
+in vec3 matSpecular;
+in float matSpecExponent;
+in float useFresnel;
+
+layout (std140) uniform phGlobal { 
+    vec3 GlobalAmbientColor;        // Global ambient light color 
+    int NumLights;                  // Number of lights 
+    bool LocalViewer;               // true for local viewer; false for directional viewer 
+    bool EnableEmissive;            // Control whether emissive colors are rendered 
+    bool EnableDiffuse;             // Control whether diffuse colors are rendered 
+    bool EnableAmbient;             // Control whether ambient colors are rendered 
+    bool EnableSpecular;            // Control whether specular colors are rendered 
+	bool UseHalfwayVector;			// Control whether halfway vector method is used
+};
+
+const int MaxLights = 8;        // The maximum number of lights (must match value in C++ code)
+struct phLight { 
+    bool IsEnabled;             // True if light is turned on 
+    bool IsAttenuated;          // True if attenuation is active 
+    bool IsSpotLight;           // True if spotlight 
+    bool IsDirectional;         // True if directional 
+    vec3 Position; 
+    vec3 AmbientColor; 
+    vec3 DiffuseColor; 
+    vec3 SpecularColor; 
+    vec3 SpotDirection;         // Should be unit vector! 
+    float SpotCosCutoff;        // Cosine of cutoff angle 
+    float SpotExponent; 
+    float ConstantAttenuation; 
+    float LinearAttenuation; 
+    float QuadraticAttenuation; 
+};
+layout (std140) uniform phLightArray { 
+    phLight Lights[MaxLights];
+};
+
+vec3 mvPos;                     // Computed by the ray cast, instead of interpolated
+vec3 mvNormal; 
+vec2 theTexCoords;
+uniform sampler2D theTextureMap;
+uniform bool applyTexture;
+uniform mat4 projectionMatrix;
+uniform mat4 modelviewMatrix;
+uniform int primitiveKind;      // 0 for spheres, 1 for cylinders
+
+vec3 nonspecColor;
+vec3 specularColor;  
+out vec4 fragmentColor;         // Color that will be used for the fragment
+
+void CalculatePhongLighting();  // Calculates: nonspecColor and specularColor. 
+vec4 applyTextureFunction();
+
+const float PI = 3.1415926535897932;
+
+// Model coordinates of a modelview direction (modelviewMatrix has uniform scaling).
+vec3 toModel(vec3 dir) {
+    return normalize(transpose(mat3(modelviewMatrix)) * dir);
+}
+
+// The nearest hit with the sphere, or false if the ray misses it.
+bool raySphere(vec3 rd, out float t) {
+    float b = dot(rd, mvP0);
+    float disc = b*b - dot(mvP0, mvP0) + mvRadius*mvRadius;
+    if ( disc < 0.0 ) {
+        return false;
+    }
+    float h = sqrt(disc);
+    t = (b - h > 0.0) ? b - h : b + h;      // Second hit if the eye is inside
+    mvNormal = (t*rd - mvP0) / mvRadius;
+    vec3 n = toModel(mvNormal);
+    float theta = atan(-n.x, -n.z);
+    theTexCoords = vec2(fract(theta/(2.0*PI)), acos(clamp(-n.y, -1.0, 1.0))/PI);
+    return true;
+}
+
+// The nearest hit with the capped cylinder from mvP0 to mvP1, or false if the ray misses it.
+bool rayCylinder(vec3 rd, out float t) {
+    vec3 ba = mvP1 - mvP0;
+    vec3 oc = -mvP0;                // Ray origin (the eye) relative to mvP0
+    float baba = dot(ba, ba);
+    float bard = dot(ba, rd);
+    float baoc = dot(ba, oc);
+    float k2 = baba - bard*bard;
+    float k1 = baba*dot(oc, rd) - baoc*bard;
+    float k0 = baba*dot(oc, oc) - baoc*baoc - mvRadius*mvRadius*baba;
+    float h = k1*k1 - k2*k0;
+    if ( h < 0.0 || baba == 0.0 ) {
+        return false;
+    }
+    h = sqrt(h);
+    t = (-k1 - h)/k2;
+    float y = baoc + t*bard;        // Position along the axis, times |ba|
+    float ty = y/baba;
+    if ( y > 0.0 && y < baba && k2 != 0.0 ) {
+        mvNormal = (oc + t*rd - ba*ty)/mvRadius;        // Side
+    }
+    else {
+        t = ((y < 0.0 ? 0.0 : baba) - baoc)/bard;        // Caps
+        if ( abs(k1 + k2*t) >= h ) {
+            return false;
+        }
+        mvNormal = ba*sign(y)/sqrt(baba);
+        ty = y < 0.0 ? 0.0 : 1.0;
+    }
+    vec3 n = toModel(mvNormal);
+    vec3 w = normalize(objAxis);
+    vec3 other = abs(w.x) < 0.9 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+    vec3 u = normalize(cross(other, w));
+    float theta = atan(dot(n, cross(w, u)), dot(n, u));
+    theTexCoords = vec2(fract(theta/(2.0*PI)), clamp(ty, 0.0, 1.0));
+    return true;
+}
+
+void main() { 
+    vec3 rd = normalize(proxyPos);
+    float t;
+    bool hit = (primitiveKind == 0) ? raySphere(rd, t) : rayCylinder(rd, t);
+    if ( !hit || t <= 0.0 ) {
+        discard;
+    }
+    mvPos = t*rd;
+    vec4 clipPos = projectionMatrix * vec4(mvPos, 1.0);
+    float ndcDepth = clipPos.z / clipPos.w;
+    gl_FragDepth = 0.5*(gl_DepthRange.diff*ndcDepth + gl_DepthRange.near + gl_DepthRange.far);
+
+    CalculatePhongLighting();       // Calculates: nonspecColor and specularColor. 
+    fragmentColor = vec4(nonspecColor+specularColor, 1.0f);   // Add alpha value of 1.0.
+    if ( applyTexture ) { 
+        fragmentColor = applyTextureFunction();
+    }
+}
+#endglsl
+
+// **************
+// Wireframe shaders, for drawing very large polytopes interactively.
+//   No lighting and no texture: the edges are a single GL_LINES draw and the
+//   vertices a single GL_POINTS draw, both straight from the rotated vertices.
+//   The x, y and z coordinates come from three separate attribute arrays,
+//   matching the structure-of-arrays layout of the CPU rotation.
+//   Core profile OpenGL has no wide lines, so the geometry shader widens each
+//   line into a screen-space quad. The fragment shader fades out the last pixel
+//   at the edge of lines and round points, for anti-aliasing without multisampling.
+//   primitiveKind 0: points (no geometry shader).  primitiveKind 1: lines.
+//   When skeletonColoring is on, the points and lines take their colors from
+//   vertAttribs and edgeAttribs. Compile the vertex and geometry shaders with skeletonColoring.
+// **************
+#beginglsl vertexshader vertexShader_Wireframe
+#version 330 core
+layout (location = 0) in float vertX;
+layout (location = 1) in float vertY;
+layout (location = 2) in float vertZ;
+
+noperspective out float edgeDist;     // Replaced by the geometry shader, for lines
+flat out vec3 wireColor;              // Replaced by the geometry shader, for lines
+
+uniform mat4 projectionMatrix;        // The projection matrix
+uniform mat4 modelviewMatrix;         // The modelview matrix
+uniform float pointSize;              // Diameter of the points, in pixels
+uniform samplerBuffer vertAttribs;    // Skeleton value of each vertex (-1 for none)
+uniform int skeletonColoring;         // 0 for the usual colors (see the skeletonColoring code block)
+uniform float skeletonScale;
+
+vec3 SkeletonColor(float value, vec3 defaultColor);
+
+void main()
+{
+    gl_Position = projectionMatrix * modelviewMatrix * vec4(vertX, vertY, vertZ, 1.0);
+    gl_PointSize = pointSize;
+    edgeDist = 0.0;
+    wireColor = SkeletonColor(texelFetch(vertAttribs, gl_VertexID).x, vec3(1.0, 0.6, 0.1));
+}
+#endglsl
+
+#beginglsl geometryshader geometryShader_WireframeLines
+#version 330 core
+layout (lines) in;
+layout (triangle_strip, max_vertices = 4) out;
+
+noperspective out float edgeDist;     // -1 on one side of the quad, +1 on the other
+flat out vec3 wireColor;
+
+uniform vec2 viewportSize;            // In pixels
+uniform float lineWidth;              // In pixels
+uniform samplerBuffer edgeAttribs;    // Skeleton value of each edge (-1 for none)
+uniform int skeletonColoring;         // 0 for the usual colors (see the skeletonColoring code block)
+uniform float skeletonScale;
+
+vec3 SkeletonColor(float value, vec3 defaultColor);
+
+void main()
+{
+    vec4 p0 = gl_in[0].gl_Position;
+    vec4 p1 = gl_in[1].gl_Position;
+    if ( p0.w <= 0.0 || p1.w <= 0.0 ) {
+        return;                         // Not worth clipping: the eye is never this close
+    }
+    // The lines are drawn from the edge list, so the primitive number is the edge number
+    vec3 color = SkeletonColor(texelFetch(edgeAttribs, gl_PrimitiveIDIn).x, vec3(0.55, 0.75, 1.0));
+    vec2 halfViewport = 0.5*viewportSize;
+    vec2 dir = p1.xy/p1.w*halfViewport - p0.xy/p0.w*halfViewport;
+    float len = length(dir);
+    dir = len > 1e-4 ? dir/len : vec2(1.0, 0.0);
+    // Half the width plus one pixel for the anti-aliased fringe, back in clip coordinates
+    vec2 offset = vec2(-dir.y, dir.x) * (0.5*lineWidth + 1.0) / halfViewport;
+    gl_Position = p0 + vec4(offset*p0.w, 0.0, 0.0);
+    edgeDist = 1.0;
+    wireColor = color;
+    EmitVertex();
+    gl_Position = p0 - vec4(offset*p0.w, 0.0, 0.0);
+    edgeDist = -1.0;
+    wireColor = color;
+    EmitVertex();
+    gl_Position = p1 + vec4(offset*p1.w, 0.0, 0.0);
+    edgeDist = 1.0;
+    wireColor = color;
+    EmitVertex();
+    gl_Position = p1 - vec4(offset*p1.w, 0.0, 0.0);
+    edgeDist = -1.0;
+    wireColor = color;
+    EmitVertex();
+    EndPrimitive();
+}
+#endglsl
+
+#beginglsl fragmentshader fragmentShader_Wireframe
+#version 330 core
+noperspective in float edgeDist;
+flat in vec3 wireColor;
+
+out vec4 fragmentColor;
+
+uniform int primitiveKind;            // 0 for points, 1 for lines
+uniform float lineWidth;              // In pixels
+uniform float pointSize;              // In pixels
+
+void main()
+{
+    float coverage;      // Distance inside the edge of the line or point, in pixels, plus 0.5
+    if ( primitiveKind == 0 ) {
+        float r = length(2.0*gl_PointCoord - 1.0);
+        coverage = (1.0 - r)*0.5*pointSize + 0.5;
+    }
+    else {
+        float halfWidth = 0.5*lineWidth;
+        coverage = halfWidth - abs(edgeDist)*(halfWidth + 1.0) + 0.5;
+    }
+    float alpha = clamp(coverage, 0.0, 1.0);
+    if ( alpha <= 0.0 ) {
+        discard;
+    }
+    fragmentColor = vec4(wireColor, alpha);
+}
+#endglsl
+
 // ********************
 // The vertex shader for Phong lighting (with Gouraud shading).
 //   This does the hard work of the Phong lighting by calling CalculatePhongLighting()
@@ -369,3 +1108,37 @@ vec4 applyTextureFunction()
     return vec4(nonspecColor, 1.0f)*texture(theTextureMap, theTexCoords) + vec4(specularColor,0.0);
 }
 #endglsl
+
+
+// *****************************
+// skeletonColoring - code block
+//    Inputs: the uniforms skeletonColoring (0 = off, 1 = graph distance,
+//        2 or 3 = color numbers) and skeletonScale (1/(the largest distance))
+//    SkeletonColor(value, defaultColor) returns the color of a vertex or edge
+//    with the given value from SkeletonGraph4D, or defaultColor if the value
+//    is negative or skeletonColoring is off.
+//    skeletonColoring 1: value is a graph distance. The hue runs from red at the
+//        source to violet at the largest distance (value*skeletonScale == 1),
+//        and every other shell is darker so neighboring shells stand apart.
+//    skeletonColoring 2 or 3: value is a color number. Successive hues step by
+//        the golden ratio, so the first few colors are far apart.
+// *****************************
+#beginglsl codeblock skeletonColoring
+vec3 SkeletonColor(float value, vec3 defaultColor)
+{
+    if ( skeletonColoring == 0 || value < 0.0 ) {
+        return defaultColor;
+    }
+    float hue;
+    float shade = 1.0;
+    if ( skeletonColoring == 1 ) {
+        hue = 0.8*value*skeletonScale;
+        shade = mod(value, 2.0) < 0.5 ? 1.0 : 0.65;
+    }
+    else {
+        hue = fract(0.618034*value);
+    }
+    vec3 rgb = clamp(abs(mod(6.0*hue + vec3(0.0, 4.0, 2.0), 6.0) - 3.0) - 1.0, 0.0, 1.0);
+    return shade*rgb;
+}
+#endglsl
@@ -0,0 +1,52 @@
+//
+//  FrameArena.cpp
+//
+//   A bump allocator for per-frame data. See FrameArena.h.
+//
+
+#include "FrameArena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+FrameArena::~FrameArena()
+{
+	free(rawBlock);
+}
+
+bool FrameArena::Reserve(size_t numBytes)
+{
+	if (numBytes <= capacity) {
+		return true;
+	}
+	free(rawBlock);
+	size_t newCapacity = Padded(numBytes);
+	rawBlock = malloc(newCapacity + Alignment - 1);
+	if (rawBlock == NULL) {
+		fprintf(stderr, "Error: cannot allocate %zu bytes for the frame arena.\n", newCapacity);
+		base = 0;
+		capacity = 0;
+		used = 0;
+		return false;
+	}
+	base = (char*)(((uintptr_t)rawBlock + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+	capacity = newCapacity;
+	used = 0;
+	numGrows++;
+	return true;
+}
+
+void* FrameArena::Alloc(size_t numBytes)
+{
+	size_t size = Padded(numBytes);
+	if (size > capacity - used) {
+		fprintf(stderr, "Error: frame arena exhausted (%zu bytes requested, %zu of %zu in use).\n", numBytes, used, capacity);
+		return NULL;
+	}
+	void* ret = base + used;
+	used += size;
+	if (used > highWaterMark) {
+		highWaterMark = used;
+	}
+	return ret;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+//
+// FrameArena.h   ---  Header file for FrameArena.cpp.
+//
+//   A bump allocator for data that only lives for one frame
+//   (rotated vertices, per-instance matrices, ...).
+//   The memory is reserved once, sized for the current polytope,
+//   and Reset() at the start of every frame, so the render loop
+//   itself never calls malloc or free.
+//
+
+#include <stddef.h>
+
+class FrameArena
+{
+public:
+	static const size_t Alignment = 64;		// Every allocation starts on a 64-byte (cache line) boundary
+
+	FrameArena() {}
+	~FrameArena();
+
+	// Make sure at least numBytes are available after Reset().
+	// Only allocates if the current capacity is too small, so it is cheap to call every frame.
+	// Discards any outstanding allocations if it has to grow. Returns false if out of memory.
+	bool Reserve(size_t numBytes);
+
+	// Frees all allocations at once. Called at the start of each frame.
+	void Reset() { used = 0; }
+
+	// Returns numBytes of 64-byte aligned memory, or NULL if the arena is exhausted.
+	void* Alloc(size_t numBytes);
+	template<class T> T* Alloc(size_t count) { return (T*)Alloc(count * sizeof(T)); }
+
+	// Size of an allocation of numBytes, including the padding up to the next aligned address.
+	// Use this to compute the argument to Reserve().
+	static size_t Padded(size_t numBytes) { return (numBytes + Alignment - 1) & ~(Alignment - 1); }
+
+	size_t GetCapacity() const { return capacity; }
+	size_t GetUsed() const { return used; }
+	size_t GetHighWaterMark() const { return highWaterMark; }	// Largest GetUsed() ever seen
+	int GetNumGrows() const { return numGrows; }				// Number of times the memory was (re)allocated
+
+	// Disable all copy and assignment operators.
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+private:
+	void* rawBlock = 0;			// As returned by malloc
+	char* base = 0;				// rawBlock rounded up to the alignment
+	size_t capacity = 0;
+	size_t used = 0;
+	size_t highWaterMark = 0;
+	int numGrows = 0;
+};
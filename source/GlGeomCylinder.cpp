@@ -30,6 +30,7 @@
 #endif  // DONT_USE_OPENGL
 
 #include "GlGeomCylinder.h"
+#include "GlStateCache.h"
 #include "MathMisc.h"
 #include "assert.h"
 
@@ -204,7 +205,7 @@ void GlGeomCylinder::InitializeAttribLocations(
 
     // Link the VBO and EBO to the VAO, and request OpenGL to
     //   allocate memory for them.
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
     glBufferData(GL_ARRAY_BUFFER, StrideVal() * numVertices * sizeof(float), 0, GL_STATIC_DRAW);
@@ -236,7 +237,7 @@ void GlGeomCylinder::InitializeAttribLocations(
     VboEboLoaded = true;
 
     // Good practice to unbind things: helps with debugging if nothing else
-    glBindVertexArray(0);
+    GlStateCache::BindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -251,39 +252,53 @@ void GlGeomCylinder::Render()
 {
     PreRender();
 
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glDrawElements(GL_TRIANGLES, GetNumElements() , GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
+}
+
+// **********************************************
+// This routine renders many cylinders at once.
+// The per-instance data (e.g. a model matrix) must be supplied by
+//   instanced vertex attributes that the caller has attached to the VAO.
+// **********************************************
+void GlGeomCylinder::RenderInstanced(int numInstances, int baseInstance)
+{
+    PreRender();
+
+    GlStateCache::BindVertexArray(theVAO);
+    if (baseInstance == 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, GetNumElements(), GL_UNSIGNED_INT, (void*)0, numInstances);
+    }
+    else {
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, GetNumElements(), GL_UNSIGNED_INT, (void*)0, numInstances, baseInstance);
+    }
 }
 
 void GlGeomCylinder::RenderTop()
 {
     PreRender();
 
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     int n = GetNumElementsDisk();
     glDrawElements(GL_TRIANGLES, n, GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
 }
 
 void GlGeomCylinder::RenderBase()
 {
     PreRender();
 
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     int n = GetNumElementsDisk();
     glDrawElements(GL_TRIANGLES, n, GL_UNSIGNED_INT, (void*)(n * sizeof(unsigned int)));
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
 }
 
 void GlGeomCylinder::RenderSide()
 {
     PreRender();
 
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     int n = GetNumElementsDisk();
     glDrawElements(GL_TRIANGLES, GetNumElementsSide(), GL_UNSIGNED_INT, (void*)(2 * n * sizeof(unsigned int)));
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
 }
 
 void GlGeomCylinder::PreRender()
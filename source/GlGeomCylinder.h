@@ -71,6 +71,9 @@ public:
 		unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
 
     void Render();          // Render: renders entire cylinder
+    void RenderInstanced(int numInstances, int baseInstance = 0);   // Renders numInstances cylinders with one draw call.
+                                              //   Per-instance attributes must already be attached to GetVAO().
+                                              //   A nonzero baseInstance offsets them (needs OpenGL 4.2).
     void RenderTop();
     void RenderBase();
     void RenderSide();
@@ -34,6 +34,7 @@
 #include "assert.h"
 
 #include "GlGeomSphere.h"
+#include "GlStateCache.h"
 
 void GlGeomSphere::Remesh(int slices, int stacks)
 {
@@ -153,7 +154,7 @@ void GlGeomSphere::InitializeAttribLocations(
 
 	// Link the VBO and EBO to the VAO, and request OpenGL to
 	//   allocate memory for them.
-	glBindVertexArray(theVAO);
+	GlStateCache::BindVertexArray(theVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
 	glBufferData(GL_ARRAY_BUFFER, StrideVal() * numVertices * sizeof(float), 0, GL_STATIC_DRAW);
@@ -186,7 +187,7 @@ void GlGeomSphere::InitializeAttribLocations(
     loadedStacks = numStacks;
 
     // Good practice to unbind things: helps with debugging if nothing else
-    glBindVertexArray(0); 
+    GlStateCache::BindVertexArray(0); 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -209,9 +210,25 @@ bool GlGeomSphere::Prerender() {
 void GlGeomSphere::Render()
 {
     Prerender();
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glDrawElements(GL_TRIANGLES, (GLsizei)GetNumElements(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
+}
+
+// **********************************************
+// This routine renders many spheres at once.
+// The per-instance data (e.g. a model matrix) must be supplied by
+//   instanced vertex attributes that the caller has attached to the VAO.
+// **********************************************
+void GlGeomSphere::RenderInstanced(int numInstances, int baseInstance)
+{
+    Prerender();
+    GlStateCache::BindVertexArray(theVAO);
+    if (baseInstance == 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)GetNumElements(), GL_UNSIGNED_INT, 0, numInstances);
+    }
+    else {
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, (GLsizei)GetNumElements(), GL_UNSIGNED_INT, 0, numInstances, baseInstance);
+    }
 }
 
 // **********************************************
@@ -223,10 +240,9 @@ void GlGeomSphere::RenderSlice(int i)
     assert(i >= 0 && i < numSlices);
     Prerender();
 
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     GLsizei sliceLen = GetNumElementsInSlice();
     glDrawElements(GL_TRIANGLES, sliceLen, GL_UNSIGNED_INT, (void*)(i*sliceLen*sizeof(unsigned int)));
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
 }
 
 // **********************************************
@@ -251,7 +267,7 @@ void GlGeomSphere::RenderStack(int j)
 
     unsigned int tempEBO;
     glGenBuffers(1, &tempEBO);
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tempEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, (numSlices + 1) * 2 * sizeof(unsigned int), stackElts, GL_STATIC_DRAW);
 
@@ -260,7 +276,7 @@ void GlGeomSphere::RenderStack(int j)
     delete[] stackElts;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);  // Restore the main EBO (The VAO maintains its knowledge of this)
     glDeleteBuffers(1, &tempEBO);
-    glBindVertexArray(0);
+    GlStateCache::BindVertexArray(0);
 
 }
 
@@ -282,7 +298,7 @@ void GlGeomSphere::RenderNorthPoleFan() {
 
     unsigned int tempEBO;
     glGenBuffers(1, &tempEBO);
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tempEBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (numSlices+2) * sizeof(unsigned int), poleElts, GL_STATIC_DRAW);
 
@@ -291,7 +307,7 @@ void GlGeomSphere::RenderNorthPoleFan() {
     delete[] poleElts;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);  // Restore the main EBO (The VAO maintains its knowledge of this)
     glDeleteBuffers(1, &tempEBO);
-    glBindVertexArray(0);
+    GlStateCache::BindVertexArray(0);
 }
 
 
@@ -70,6 +70,11 @@ public:
 
 	void Render();
 
+    // Renders numInstances copies of the sphere with a single glDrawElementsInstanced.
+    // Per-instance attributes (with divisor 1) must already be attached to GetVAO().
+    // A nonzero baseInstance offsets the instanced attributes (needs OpenGL 4.2).
+    void RenderInstanced(int numInstances, int baseInstance = 0);
+
     // Mode (2) 
     // CalcVboAndEbo- return all VBO vertex information, and EBO elements for GL_TRIANGLES drawing.
     // Inputs:
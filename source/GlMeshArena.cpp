@@ -0,0 +1,102 @@
+//
+//  GlMeshArena.cpp
+//
+//   Shared vertex and element buffers for multi-draw-indirect rendering.
+//   See GlMeshArena.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h> 
+#include <GLFW/glfw3.h>
+#include <assert.h>
+#include <stddef.h>
+
+#include "GlMeshArena.h"
+#include "GlStateCache.h"
+
+void GlMeshArena::SetAttribLocations(unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+{
+	posLoc = pos_loc;
+	normalLoc = normal_loc;
+	texcoordsLoc = texcoords_loc;
+}
+
+int GlMeshArena::AddMesh()
+{
+	meshes.push_back(Mesh());
+	meshes.back().baseVertex = 0;
+	meshes.back().firstIndex = 0;
+	return (int)meshes.size() - 1;
+}
+
+void GlMeshArena::SetMesh(int meshNum, const float* verts, int numVerts, const unsigned int* elts, int numElts)
+{
+	assert(meshNum >= 0 && meshNum < (int)meshes.size());
+	Mesh& m = meshes[meshNum];
+	m.verts.assign(verts, verts + FloatsPerVertex * numVerts);
+	m.elts.assign(elts, elts + numElts);
+	dirty = true;
+}
+
+void GlMeshArena::Upload()
+{
+	if (!dirty) {
+		return;
+	}
+	dirty = false;
+
+	size_t numFloats = 0;
+	size_t numElts = 0;
+	for (Mesh& m : meshes) {
+		m.baseVertex = (int)(numFloats / FloatsPerVertex);
+		m.firstIndex = (unsigned int)numElts;
+		numFloats += m.verts.size();
+		numElts += m.elts.size();
+	}
+
+	if (theVAO == 0) {
+		glGenVertexArrays(1, &theVAO);
+		glGenBuffers(1, &theVBO);
+		glGenBuffers(1, &theEBO);
+		GlStateCache::BindVertexArray(theVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
+		int stride = FloatsPerVertex * sizeof(float);
+		glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+		glEnableVertexAttribArray(posLoc);
+		glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(normalLoc);
+		glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(texcoordsLoc);
+	}
+	else {
+		GlStateCache::BindVertexArray(theVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+	}
+
+	// Allocate, then copy in each mesh. The EBO binding is part of the VAO's state.
+	glBufferData(GL_ARRAY_BUFFER, numFloats * sizeof(float), 0, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, numElts * sizeof(unsigned int), 0, GL_STATIC_DRAW);
+	for (Mesh& m : meshes) {
+		if (m.elts.empty()) {
+			continue;
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, m.baseVertex * FloatsPerVertex * sizeof(float),
+			m.verts.size() * sizeof(float), &m.verts[0]);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, m.firstIndex * sizeof(unsigned int),
+			m.elts.size() * sizeof(unsigned int), &m.elts[0]);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GlMeshArena::GetDrawCommand(int meshNum, int numInstances, int baseInstance, GlDrawElementsIndirectCommand* cmd) const
+{
+	assert(meshNum >= 0 && meshNum < (int)meshes.size());
+	const Mesh& m = meshes[meshNum];
+	cmd->count = (unsigned int)m.elts.size();
+	cmd->instanceCount = (unsigned int)numInstances;
+	cmd->firstIndex = m.firstIndex;
+	cmd->baseVertex = m.baseVertex;
+	cmd->baseInstance = (unsigned int)baseInstance;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+//
+// GlMeshArena.h   ---  Header file for GlMeshArena.cpp.
+//
+//   Packs many static triangle meshes into one shared VBO and EBO with one VAO,
+//   so they can all be drawn by a single glMultiDrawElementsIndirect call.
+//   Every vertex has 8 floats: position (3), normal (3), texture coordinates (2),
+//   at the attribute locations passed to SetAttribLocations().
+//   Each mesh keeps its own element numbering; the draw command's baseVertex
+//   and firstIndex place it in the shared buffers.
+//
+//   A mesh's data is kept on the CPU as well, so that one mesh can be replaced
+//   (e.g., when a sphere is remeshed) and the buffers packed again by Upload().
+//
+
+#include <vector>
+
+// The layout OpenGL expects in the GL_DRAW_INDIRECT_BUFFER.
+typedef struct {
+	unsigned int count;				// Number of elements
+	unsigned int instanceCount;
+	unsigned int firstIndex;		// Offset in the EBO, in elements
+	int baseVertex;					// Added to every element
+	unsigned int baseInstance;		// Offset for the instanced attributes
+} GlDrawElementsIndirectCommand;
+
+class GlMeshArena
+{
+public:
+	static const int FloatsPerVertex = 8;
+
+	GlMeshArena() {}
+
+	void SetAttribLocations(unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc);
+
+	// Returns the number of a new, empty mesh.
+	int AddMesh();
+	// Gives the vertices (FloatsPerVertex floats each) and the GL_TRIANGLES elements of a mesh.
+	void SetMesh(int meshNum, const float* verts, int numVerts, const unsigned int* elts, int numElts);
+	// Same, for a GlGeomSphere, GlGeomCylinder, or any class with their Mode (2) interface.
+	template<class Geom> void SetMesh(int meshNum, Geom& geom);
+
+	// Packs all meshes into the VBO and EBO, if anything changed since the last call.
+	void Upload();
+
+	// Fills in the indirect draw command for numInstances copies of a mesh.
+	void GetDrawCommand(int meshNum, int numInstances, int baseInstance, GlDrawElementsIndirectCommand* cmd) const;
+
+	unsigned int GetVAO() const { return theVAO; }
+	int GetNumMeshes() const { return (int)meshes.size(); }
+
+	// Disable all copy and assignment operators.
+	GlMeshArena(const GlMeshArena&) = delete;
+	GlMeshArena& operator=(const GlMeshArena&) = delete;
+
+private:
+	typedef struct {
+		std::vector<float> verts;
+		std::vector<unsigned int> elts;
+		int baseVertex;
+		unsigned int firstIndex;
+	} Mesh;
+	std::vector<Mesh> meshes;
+	bool dirty = false;
+
+	unsigned int posLoc = 0;
+	unsigned int normalLoc = 1;
+	unsigned int texcoordsLoc = 2;
+	unsigned int theVAO = 0;
+	unsigned int theVBO = 0;
+	unsigned int theEBO = 0;
+};
+
+template<class Geom> inline void GlMeshArena::SetMesh(int meshNum, Geom& geom)
+{
+	std::vector<float> verts(FloatsPerVertex * geom.GetNumVerticesTexCoords());
+	std::vector<unsigned int> elts(geom.GetNumElements());
+	geom.CalcVboAndEbo(&verts[0], &elts[0], 0, 3, 6, FloatsPerVertex);
+	SetMesh(meshNum, &verts[0], geom.GetNumVerticesTexCoords(), &elts[0], (int)elts.size());
+}
@@ -64,6 +64,9 @@ std::vector<GlShaderMgr::ShaderInfo> GlShaderMgr::shdrInfo;
 // List of all shader program OpenGL handles.
 std::vector<unsigned int> GlShaderMgr::shdrPrograms;
 
+// Uniform locations of each linked shader program, filled by ReflectUniforms.
+std::map<unsigned int, std::map<std::string, int>> GlShaderMgr::uniformLocs;
+
 // Load shader source code from multiple files.
 bool GlShaderMgr::LoadShaderSource(int numFiles, const char* filenamePtr[])
 {
@@ -336,9 +339,59 @@ unsigned int GlShaderMgr::LinkShaderProgram(int numShaders, const unsigned int s
     }
 
     shdrPrograms.push_back(shaderProgram);
+    ReflectUniforms(shaderProgram);
     return shaderProgram;
 }
 
+// Query all active uniforms of a newly linked program and store their locations.
+// Uniforms in uniform blocks have location -1 and are skipped.
+void GlShaderMgr::ReflectUniforms(unsigned int program)
+{
+    std::map<std::string, int>& locs = uniformLocs[program];
+    locs.clear();
+    int numUniforms = 0;
+    int maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<char> nameBuf(maxNameLength + 1);
+    for (int i = 0; i < numUniforms; i++) {
+        int nameLength = 0;
+        int arraySize = 0;
+        GLenum type;
+        glGetActiveUniform(program, (GLuint)i, (GLsizei)nameBuf.size(), &nameLength, &arraySize, &type, &nameBuf[0]);
+        std::string name(&nameBuf[0], nameLength);
+        int loc = glGetUniformLocation(program, name.c_str());
+        if (loc < 0) {
+            continue;
+        }
+        locs[name] = loc;
+        // Arrays are reported as "name[0]"; also register the bare name and the other elements.
+        size_t len = name.size();
+        if (len > 3 && name.compare(len - 3, 3, "[0]") == 0) {
+            std::string baseName = name.substr(0, len - 3);
+            locs[baseName] = loc;
+            for (int j = 1; j < arraySize; j++) {
+                std::string elementName = baseName + "[" + std::to_string(j) + "]";
+                locs[elementName] = glGetUniformLocation(program, elementName.c_str());
+            }
+        }
+    }
+}
+
+int GlShaderMgr::GetUniformLocation(unsigned int program, const char* uniformName)
+{
+    auto progIter = uniformLocs.find(program);
+    if (progIter == uniformLocs.end()) {
+        // Not linked by GlShaderMgr: fall back to asking OpenGL.
+        return glGetUniformLocation(program, uniformName);
+    }
+    auto locIter = progIter->second.find(uniformName);
+    if (locIter == progIter->second.end()) {
+        return -1;      // Not an active uniform (possibly optimized away)
+    }
+    return locIter->second;
+}
+
 // The next three "convenience" routines allow compiling and linking shaders
 //    with a little less code
 
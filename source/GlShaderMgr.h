@@ -29,6 +29,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 class GlShaderMgr {
 
@@ -101,6 +102,16 @@ public:
     //    Removes source code, and deletes no-longer needed shaders
     static void FinalizeCompileAndLink();
 
+    // ****
+    // Uniform location cache.
+    // The active uniforms of every program are reflected once, when
+    //     LinkShaderProgram succeeds, so that per-frame code never needs
+    //     to call glGetUniformLocation.
+    // Arrays are registered as "name", "name[0]", "name[1]", etc.
+    // Returns -1 if the program has no active uniform with that name.
+    // ****
+    static int GetUniformLocation(unsigned int program, const char* uniformName);
+
     // ****
     // Routines for error reporting. 
     // ****
@@ -136,6 +147,10 @@ protected:
 
     // The vector shdrPrograms contains the OpenGL handles for all linked shader programs.
     static std::vector<unsigned int> shdrPrograms;
+
+    // uniformLocs maps a shader program handle to the locations of its active uniforms.
+    static std::map<unsigned int, std::map<std::string, int>> uniformLocs;
+    static void ReflectUniforms(unsigned int program);
 };
 
 
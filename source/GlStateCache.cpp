@@ -0,0 +1,203 @@
+//
+//  GlStateCache.cpp
+//
+//   Drops redundant OpenGL state changes.  See GlStateCache.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h> 
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "GlStateCache.h"
+
+unsigned int GlStateCache::curProgram = GlStateCache::Unknown;
+unsigned int GlStateCache::curVAO = GlStateCache::Unknown;
+unsigned int GlStateCache::curTextureUnit = GlStateCache::Unknown;
+unsigned int GlStateCache::boundTex2D[GlStateCache::MaxTextureUnits];
+unsigned int GlStateCache::boundTexBuffer[GlStateCache::MaxTextureUnits];
+long long GlStateCache::numIssued = 0;
+long long GlStateCache::numDropped = 0;
+std::map<unsigned int, std::vector<GlStateCache::ShadowUniform>> GlStateCache::shadowUniforms;
+bool GlStateCache::texturesKnown = false;
+
+void GlStateCache::Invalidate()
+{
+	curProgram = Unknown;
+	curVAO = Unknown;
+	curTextureUnit = Unknown;
+	for (int i = 0; i < MaxTextureUnits; i++) {
+		boundTex2D[i] = Unknown;
+		boundTexBuffer[i] = Unknown;
+	}
+	texturesKnown = true;
+	shadowUniforms.clear();
+}
+
+void GlStateCache::UseProgram(unsigned int program)
+{
+	if (program == curProgram && Dropped()) {
+		return;
+	}
+	glUseProgram(program);
+	curProgram = program;
+	numIssued++;
+}
+
+void GlStateCache::BindVertexArray(unsigned int vao)
+{
+	if (vao == curVAO && Dropped()) {
+		return;
+	}
+	glBindVertexArray(vao);
+	curVAO = vao;
+	numIssued++;
+}
+
+void GlStateCache::ActiveTexture(unsigned int textureUnit)
+{
+	unsigned int unit = textureUnit - GL_TEXTURE0;
+	if (unit == curTextureUnit && Dropped()) {
+		return;
+	}
+	glActiveTexture(textureUnit);
+	curTextureUnit = unit;
+	numIssued++;
+}
+
+void GlStateCache::BindTexture(unsigned int target, unsigned int texture)
+{
+	if (!texturesKnown) {
+		Invalidate();
+	}
+	unsigned int* slot = 0;
+	if (curTextureUnit < (unsigned int)MaxTextureUnits) {
+		if (target == GL_TEXTURE_2D) {
+			slot = &boundTex2D[curTextureUnit];
+		}
+		else if (target == GL_TEXTURE_BUFFER) {
+			slot = &boundTexBuffer[curTextureUnit];
+		}
+	}
+	if (slot != 0 && *slot == texture && Dropped()) {
+		return;
+	}
+	glBindTexture(target, texture);
+	if (slot != 0) {
+		*slot = texture;
+	}
+	numIssued++;
+}
+
+GlStateCache::ShadowUniform* GlStateCache::FindShadow(int location)
+{
+	if (curProgram == Unknown) {
+		return 0;
+	}
+	std::vector<ShadowUniform>& shadows = shadowUniforms[curProgram];
+	if ((size_t)location >= shadows.size()) {
+		ShadowUniform unset;
+		memset(&unset, 0, sizeof(unset));
+		shadows.resize(location + 1, unset);
+	}
+	return &shadows[location];
+}
+
+void GlStateCache::Uniform1i(int location, int value)
+{
+	if (location < 0) {
+		return;
+	}
+	ShadowUniform* shadow = FindShadow(location);
+	if (shadow != 0 && shadow->kind == 1 && shadow->intValue == value && Dropped()) {
+		return;
+	}
+	glUniform1i(location, value);
+	if (shadow != 0) {
+		shadow->kind = 1;
+		shadow->intValue = value;
+	}
+	numIssued++;
+}
+
+void GlStateCache::Uniform1f(int location, float value)
+{
+	if (location < 0) {
+		return;
+	}
+	ShadowUniform* shadow = FindShadow(location);
+	if (shadow != 0 && shadow->kind == 2 && shadow->floatValues[0] == value && Dropped()) {
+		return;
+	}
+	glUniform1f(location, value);
+	if (shadow != 0) {
+		shadow->kind = 2;
+		shadow->floatValues[0] = value;
+	}
+	numIssued++;
+}
+
+void GlStateCache::Uniform2f(int location, float x, float y)
+{
+	if (location < 0) {
+		return;
+	}
+	ShadowUniform* shadow = FindShadow(location);
+	if (shadow != 0 && shadow->kind == 4 
+			&& shadow->floatValues[0] == x && shadow->floatValues[1] == y && Dropped()) {
+		return;
+	}
+	glUniform2f(location, x, y);
+	if (shadow != 0) {
+		shadow->kind = 4;
+		shadow->floatValues[0] = x;
+		shadow->floatValues[1] = y;
+	}
+	numIssued++;
+}
+
+void GlStateCache::Uniform4f(int location, float x, float y, float z, float w)
+{
+	if (location < 0) {
+		return;
+	}
+	float values[4] = { x, y, z, w };
+	ShadowUniform* shadow = FindShadow(location);
+	if (shadow != 0 && shadow->kind == 5 
+			&& memcmp(shadow->floatValues, values, 4 * sizeof(float)) == 0 && Dropped()) {
+		return;
+	}
+	glUniform4f(location, x, y, z, w);
+	if (shadow != 0) {
+		shadow->kind = 5;
+		memcpy(shadow->floatValues, values, 4 * sizeof(float));
+	}
+	numIssued++;
+}
+
+void GlStateCache::UniformMatrix4fv(int location, const float* matEntries)
+{
+	if (location < 0) {
+		return;
+	}
+	ShadowUniform* shadow = FindShadow(location);
+	if (shadow != 0 && shadow->kind == 3 
+			&& memcmp(shadow->floatValues, matEntries, 16 * sizeof(float)) == 0 && Dropped()) {
+		return;
+	}
+	glUniformMatrix4fv(location, 1, GL_FALSE, matEntries);
+	if (shadow != 0) {
+		shadow->kind = 3;
+		memcpy(shadow->floatValues, matEntries, 16 * sizeof(float));
+	}
+	numIssued++;
+}
+
+void GlStateCache::PrintStats()
+{
+	long long total = numIssued + numDropped;
+	printf("GL state cache: %lld calls issued, %lld redundant calls dropped (%.1f%%).\n",
+		numIssued, numDropped, total > 0 ? 100.0 * (double)numDropped / (double)total : 0.0);
+}
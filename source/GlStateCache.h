@@ -0,0 +1,70 @@
+#pragma once
+
+//
+// GlStateCache.h   ---  Header file for GlStateCache.cpp.
+//
+//   A thin shadow of the OpenGL state that the render loop changes most often:
+//   the current shader program, the bound vertex array, the active texture unit,
+//   the texture bound to each unit, and the values of int, float, vec2, vec4 and mat4 uniforms.
+//   A call that would set the state to the value it already has is dropped
+//   and counted instead of being passed to OpenGL.
+//
+//   All changes to this state must go through GlStateCache, otherwise the
+//   shadow copy goes stale. Call Invalidate() after any code that bypasses it.
+//
+
+#include <map>
+#include <vector>
+
+class GlStateCache
+{
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vao);
+	static void ActiveTexture(unsigned int textureUnit);		// GL_TEXTURE0, GL_TEXTURE1, ...
+	static void BindTexture(unsigned int target, unsigned int texture);
+
+	// Set a uniform of the current program. Locations of -1 are ignored, as in OpenGL.
+	static void Uniform1i(int location, int value);
+	static void Uniform1f(int location, float value);
+	static void Uniform2f(int location, float x, float y);
+	static void Uniform4f(int location, float x, float y, float z, float w);
+	static void UniformMatrix4fv(int location, const float* matEntries);	// One column-major matrix
+
+	// Forget everything: the next call of each kind always reaches OpenGL.
+	static void Invalidate();
+
+	// Statistics
+	static long long GetNumIssued() { return numIssued; }		// Calls passed on to OpenGL
+	static long long GetNumDropped() { return numDropped; }		// Redundant calls dropped
+	static void PrintStats();
+
+private:
+	static const int MaxTextureUnits = 16;
+	static const unsigned int Unknown = 0xffffffff;
+
+	static unsigned int curProgram;
+	static unsigned int curVAO;
+	static unsigned int curTextureUnit;			// 0, 1, 2, ... (not GL_TEXTURE0 + i)
+	static unsigned int boundTex2D[MaxTextureUnits];
+	static unsigned int boundTexBuffer[MaxTextureUnits];
+
+	static long long numIssued;
+	static long long numDropped;
+
+	// Shadow copy of a uniform: up to 16 floats, or one int.
+	typedef struct {
+		int kind;			// 0 = not yet set, 1 = int, 2 = float, 3 = mat4, 4 = vec2, 5 = vec4
+		int intValue;
+		float floatValues[16];
+	} ShadowUniform;
+	// Uniform values are part of the program object, so they are shadowed per program,
+	//    in a vector indexed by uniform location.
+	static std::map<unsigned int, std::vector<ShadowUniform>> shadowUniforms;
+	static ShadowUniform* FindShadow(int location);
+
+	// The texture arrays start out unknown, as if Invalidate() had been called.
+	static bool texturesKnown;
+
+	static bool Dropped() { numDropped++; return true; }
+};
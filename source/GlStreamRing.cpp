@@ -0,0 +1,112 @@
+//
+//  GlStreamRing.cpp
+//
+//   Persistently mapped, fence-guarded, triple-buffered streaming buffer.
+//   See GlStreamRing.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h> 
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "GlStreamRing.h"
+
+bool GlStreamRing::IsSupported()
+{
+	return (GLEW_ARB_buffer_storage && GLEW_ARB_base_instance) ? true : false;
+}
+
+GlStreamRing::~GlStreamRing()
+{
+	Release();
+}
+
+void GlStreamRing::Release()
+{
+	for (int i = 0; i < NumSections; i++) {
+		if (fences[i] != 0) {
+			glDeleteSync((GLsync)fences[i]);
+			fences[i] = 0;
+		}
+	}
+	if (theBuffer != 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, theBuffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &theBuffer);
+		theBuffer = 0;
+	}
+	mappedPtr = 0;
+	sectionSize = 0;
+}
+
+bool GlStreamRing::Reserve(size_t bytesPerFrame)
+{
+	if (bytesPerFrame <= sectionSize) {
+		return false;
+	}
+	// The old buffer may still be in use by the GPU.
+	for (int i = 0; i < NumSections; i++) {
+		WaitForSection(i);
+	}
+	Release();
+
+	sectionSize = (bytesPerFrame + 255) & ~(size_t)255;
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &theBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, theBuffer);
+	glBufferStorage(GL_ARRAY_BUFFER, NumSections * sectionSize, 0, flags);
+	mappedPtr = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, NumSections * sectionSize, flags);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	if (mappedPtr == 0) {
+		fprintf(stderr, "Error: cannot map %zu bytes for the streaming buffer.\n", NumSections * sectionSize);
+	}
+	curSection = NumSections - 1;
+	curUsed = 0;
+	return true;
+}
+
+void GlStreamRing::WaitForSection(int section)
+{
+	GLsync fence = (GLsync)fences[section];
+	if (fence == 0) {
+		return;
+	}
+	GLenum ret = glClientWaitSync(fence, 0, 0);
+	if (ret == GL_TIMEOUT_EXPIRED) {
+		numWaits++;
+		do {
+			ret = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);	// 1 second
+		} while (ret == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(fence);
+	fences[section] = 0;
+}
+
+void GlStreamRing::BeginFrame()
+{
+	curSection = (curSection + 1) % NumSections;
+	curUsed = 0;
+	WaitForSection(curSection);
+}
+
+void GlStreamRing::EndFrame()
+{
+	if (fences[curSection] == 0) {
+		fences[curSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+void* GlStreamRing::Alloc(size_t numBytes, size_t align, size_t* offset)
+{
+	size_t start = (curUsed + align - 1) / align * align;
+	if (mappedPtr == 0 || start + numBytes > sectionSize) {
+		return NULL;
+	}
+	curUsed = start + numBytes;
+	*offset = curSection * sectionSize + start;
+	return mappedPtr + *offset;
+}
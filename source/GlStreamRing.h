@@ -0,0 +1,66 @@
+#pragma once
+
+//
+// GlStreamRing.h   ---  Header file for GlStreamRing.cpp.
+//
+//   A streaming buffer for data that is rewritten every frame
+//   (per-instance matrices, etc.).
+//   The buffer is created with glBufferStorage and stays persistently
+//   and coherently mapped, so the CPU writes straight into GPU-visible memory.
+//   It is split into three sections, one per frame in flight; a fence
+//   placed at the end of each frame guards its section from being
+//   overwritten while the GPU may still be reading it.
+//   This avoids the implicit synchronization of calling glBufferData every frame.
+//
+//   Requires OpenGL 4.4 (or ARB_buffer_storage and ARB_base_instance).
+//   IsSupported() returns false otherwise, and callers should fall back to glBufferData.
+//
+
+#include <stddef.h>
+
+class GlStreamRing
+{
+public:
+	static const int NumSections = 3;		// Triple buffering
+
+	GlStreamRing() {}
+	~GlStreamRing();
+
+	static bool IsSupported();
+
+	// Make sure each frame can allocate at least bytesPerFrame.
+	// Returns true if the buffer was (re)created, in which case GetBuffer()
+	//    has changed and anything referring to the old buffer (like a VAO) must be updated.
+	// Must not be called between BeginFrame() and EndFrame().
+	bool Reserve(size_t bytesPerFrame);
+
+	// Start writing the next section. Waits if the GPU is still using it.
+	void BeginFrame();
+	// Places the fence for the current section. Call after the frame's last draw call using the ring.
+	void EndFrame();
+
+	// Allocates numBytes in the current section, aligned to a multiple of align bytes.
+	// Returns the CPU pointer to write to, and sets *offset to the byte offset in GetBuffer().
+	// Returns NULL if the section is full.
+	void* Alloc(size_t numBytes, size_t align, size_t* offset);
+
+	unsigned int GetBuffer() const { return theBuffer; }
+	size_t GetSectionSize() const { return sectionSize; }
+	int GetNumWaits() const { return numWaits; }		// Number of times BeginFrame() had to block
+
+	// Disable all copy and assignment operators.
+	GlStreamRing(const GlStreamRing&) = delete;
+	GlStreamRing& operator=(const GlStreamRing&) = delete;
+
+private:
+	unsigned int theBuffer = 0;
+	char* mappedPtr = 0;			// Persistent mapping of the whole buffer
+	size_t sectionSize = 0;
+	int curSection = NumSections - 1;
+	size_t curUsed = 0;				// Bytes used in the current section
+	void* fences[NumSections] = { 0, 0, 0 };	// GLsync objects
+	int numWaits = 0;
+
+	void WaitForSection(int section);
+	void Release();
+};
@@ -1,4 +1,5 @@
 #include "MathCustom.h"
+#include "MathMisc.h"
 
 // for vec1 = <a1, a2, ..., an> and vec2 = <b1, b2, ..., bn>, vec1\oplus vec2 is
 // [ b1*vec1, b2*vec1, ..., bn*vec1 ]
@@ -15,4 +16,35 @@ float * outerProduct(float * vec1, int n1, float * vec2, int n2) {
 		}
 	}
 	return matrix;
-}
\ No newline at end of file
+}
+
+// Same closed form as the per-vertex rotation in MyRenderGeometries(), but evaluated
+// once: R = Rxy * Rxz * Rxw * Ryz * Ryw * Rzw.
+void composeRotation4D(const double * thetas, float * R) {
+	float c1 = (float)cos(PI2*thetas[0]);	float s1 = (float)sin(PI2*thetas[0]);
+	float c2 = (float)cos(PI2*thetas[1]);	float s2 = (float)sin(PI2*thetas[1]);
+	float c3 = (float)cos(PI2*thetas[2]);	float s3 = (float)sin(PI2*thetas[2]);
+	float c4 = (float)cos(PI2*thetas[3]);	float s4 = (float)sin(PI2*thetas[3]);
+	float c5 = (float)cos(PI2*thetas[4]);	float s5 = (float)sin(PI2*thetas[4]);
+	float c6 = (float)cos(PI2*thetas[5]);	float s6 = (float)sin(PI2*thetas[5]);
+	// row 0 (x)
+	R[0] = c1 * c2*c3;
+	R[4] = c1 * c2*s3*s5 - c5 * (c4*s1 - c1 * s2*s4);
+	R[8] = c6 * (s1*s4 + c1 * c4*s2) - s6 * (s5*(c4*s1 - c1 * s2*s4) + c1 * c2*c5*s3);
+	R[12] = -s6 * (s1*s4 + c1 * c4*s2) - c6 * (s5*(c4*s1 - c1 * s2*s4) + c1 * c2*c5*s3);
+	// row 1 (y)
+	R[1] = c2 * c3*s1;
+	R[5] = c5 * (c1*c4 + s1 * s2*s4) + c2 * s1*s3*s5;
+	R[9] = s6 * (s5*(c1*c4 + s1 * s2*s4) - c2 * c5*s1*s3) - c6 * (c1*s4 - c4 * s1*s2);
+	R[13] = s6 * (c1*s4 - c4 * s1*s2) + c6 * (s5*(c1*c4 + s1 * s2*s4) - c2 * c5*s1*s3);
+	// row 2 (z)
+	R[2] = -c3 * s2;
+	R[6] = c2 * c5*s4 - s2 * s3*s5;
+	R[10] = s6 * (c5*s2*s3 + c2 * s4*s5) + c2 * c4*c6;
+	R[14] = c6 * (c5*s2*s3 + c2 * s4*s5) - c2 * c4*s6;
+	// row 3 (w)
+	R[3] = s3;
+	R[7] = -c3 * s5;
+	R[11] = c3 * c5*s6;
+	R[15] = c3 * c5*c6;
+}
@@ -6,4 +6,8 @@
 #include <stdlib.h>
 
 // calculates the outer product of vec1 and vec2, which have n1 and n2 number of elements respectively
-float * outerProduct(float * vec1, int n1, float * vec2, int n2);
\ No newline at end of file
+float * outerProduct(float * vec1, int n1, float * vec2, int n2);
+
+// composes the six plane rotations (xy/xz/xw/yz/yw/zw, in units of full turns) into a
+// single 4x4 rotation matrix, stored by columns in R. The zw rotation is applied first.
+void composeRotation4D(const double * thetas, float * R);
\ No newline at end of file
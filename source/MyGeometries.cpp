@@ -19,8 +19,30 @@
 #include "RgbImage.h"
 #include "GlGeomCylinder.h"
 #include "GlGeomSphere.h"
+#include <string.h>
+#include <float.h>
+#include <vector>
+#include <utility>
+#include <memory>
 
 #include "MathCustom.h"
+#include "FrameArena.h"
+#include "Rotate4D.h"
+#include "GlStreamRing.h"
+#include "GlShaderMgr.h"
+#include "GlStateCache.h"
+#include "GlMeshArena.h"
+#include "Coxeter4D.h"
+#include "Wythoff4D.h"
+#include "PolytopeTable.h"
+#include "StressScene4D.h"
+#include "Polytope4D.h"
+#include "PolytopeFile.h"
+#include "Off4D.h"
+#include "ConvexHull4D.h"
+#include "EdgeFinder4D.h"
+#include "SkeletonGraph4D.h"
+#include "Automorphism4D.h"
 // **********************************
 // Material to underlie a texture map.
 // YOU MAY DEFINE A SECOND ONE OF THESE IF YOU WISH
@@ -47,157 +69,27 @@ double shapeMax = 3;
 double shapeScale = 0.05;
 
 const float sq2 = sqrtf(2);
-const float sq3 = sqrtf(3);
-const float sq5 = sqrtf(5);
-const float sq6 = sqrtf(6);
-const float sq10 = sqrtf(10);
-const float phi = (1 + sq5) / 2;
 float x_1; float x_2; float y_1; float y_2; float z_1; float z_2;
 float normD;
 float tW;
 float wallScale = 4.82f;
 
-// Lists of vertices and orderings in use
-// Note: all vertices here list the unit polytope, centered at the origin
-// simplex vertices
-float simplexVerts[] = {
-	-0.5,	-sq3 / 6,	-sq6 / 12,	0.0,
-	0.5,	-sq3 / 6,	-sq6 / 12,	0.0,
-	0.0,	sq3 / 3,	-sq6 / 12,	0.0,
-	0.0,	0.0,		sq6 / 4,	0.0,
-	0.0,	0.0,		0.0,		sq10 / 4,
-};
-// simplex edges: connections between vertex indices
-int simplexOrdering[] = {
-	0,1,	0,2,	0,3,	0,4,	1,2,	1,3,	1,4,	2,3,	2,4,	3,4,
-};
-// tesseract vertices
-float tessVerts[] = {
-	-0.5,-0.5,-0.5,-0.5,		0.5,-0.5,-0.5,-0.5,			0.5,0.5,-0.5,-0.5,			-0.5,0.5,-0.5,-0.5,
-	-0.5,-0.5,0.5,-0.5,			0.5,-0.5,0.5,-0.5,			0.5,0.5,0.5,-0.5,			-0.5,0.5,0.5,-0.5,
-	-0.5,-0.5,-0.5,0.5,			0.5,-0.5,-0.5,0.5,			0.5,0.5,-0.5,0.5,			-0.5,0.5,-0.5,0.5,
-	-0.5,-0.5,0.5,0.5,			0.5,-0.5,0.5,0.5,			0.5,0.5,0.5,0.5,			-0.5,0.5,0.5,0.5,
-};
-// tesseract edges: connections between vertex indices
-int tessOrdering[] = {
-	0,1,	4,5,	7,6,	3,2,	8,9,	12,13,	15,14,	11,10,	// connections along x axis
-	0,4,	1,5,	2,6,	3,7,	8,12,	9,13,	10,14,	11,15,	// connections along y axis
-	0,3,	1,2,	5,6,	4,7,	8,11,	9,10,	13,14,	12,15,	// connections along z axis
-	0,8,	1,9,	2,10,	3,11,	4,12,	5,13,	6,14,	7,15,	// connections along w axis
-};
-// orthoplex vertices
-float orthoVerts[] = {
-	1/sq2,0.0,0.0,0.0,	-1/sq2,0.0,0.0,0.0,
-	0.0,1/sq2,0.0,0.0,	0.0,-1/sq2,0.0,0.0,
-	0.0,0.0,1/sq2,0.0,	0.0,0.0,-1/sq2,0.0,
-	0.0,0.0,0.0,1/sq2,	0.0,0.0,0.0,-1/sq2,
-};
-// orthoplex edges: connections between vertex indices
-int orthoOrdering[] = {
-	0,2,	0,3,	0,4,	0,5,	0,6,	0,7,
-	1,2,	1,3,	1,4,	1,5,	1,6,	1,7,
-	2,4,	2,5,	2,6,	2,7,
-	3,4,	3,5,	3,6,	3,7,
-	4,6,	4,7,
-	5,6,	5,7,
-};
-// octaplex vertices
-float octaVerts[] = {
-	1.0,	0.0,	0.0,	0.0,		-1.0,	0.0,	0.0,	0.0,
-	0.0,	1.0,	0.0,	0.0,		0.0,	-1.0,	0.0,	0.0,
-	0.0,	0.0,	1.0,	0.0,		0.0,	0.0,	-1.0,	0.0,
-	0.0,	0.0,	0.0,	1.0,		0.0,	0.0,	0.0,	-1.0,
-	0.5,	0.5,	0.5,	0.5,		-0.5,	0.5,	0.5,	0.5,
-	0.5,	-0.5,	0.5,	0.5,		-0.5,	-0.5,	0.5,	0.5,
-	0.5,	0.5,	-0.5,	0.5,		-0.5,	0.5,	-0.5,	0.5,
-	0.5,	-0.5,	-0.5,	0.5,		-0.5,	-0.5,	-0.5,	0.5,
-	0.5,	0.5,	0.5,	-0.5,		-0.5,	0.5,	0.5,	-0.5,
-	0.5,	-0.5,	0.5,	-0.5,		-0.5,	-0.5,	0.5,	-0.5,
-	0.5,	0.5,	-0.5,	-0.5,		-0.5,	0.5,	-0.5,	-0.5,
-	0.5,	-0.5,	-0.5,	-0.5,		-0.5,	-0.5,	-0.5,	-0.5,
-};
-// octaplex edges: connections between vertex indices
-int octaOrdering[] = {
-	0,8,	0,10,	0,12,	0,14,	0,16,	0,18,	0,20,	0,22,
-	1,9,	1,11,	1,13,	1,15,	1,17,	1,19,	1,21,	1,23,
-	2,8,	2,9,	2,12,	2,13,	2,16,	2,17,	2,20,	2,21,
-	3,10,	3,11,	3,14,	3,15,	3,18,	3,19,	3,22,	3,23,
-	4,8,	4,9,	4,10,	4,11,	4,16,	4,17,	4,18,	4,19,
-	5,12,	5,13,	5,14,	5,15,	5,20,	5,21,	5,22,	5,23,
-	8,9,	8,10,	9,11,	10,11,	12,13,	12,14,	13,15,	14,15,	8,12,	9,13,	10,14,	11,15,
-	16,17,	16,18,	17,19,	18,19,	20,21,	20,22,	21,23,	22,23,	16,20,	17,21,	18,22,	19,23,
-	6,8,	6,9,	6,10,	6,11,	6,12,	6,13,	6,14,	6,15,
-	7,16,	7,17,	7,18,	7,19,	7,20,	7,21,	7,22,	7,23,
-	8,16,	9,17,	10,18,	11,19,	12,20,	13,21,	14,22,	15,23,
-};
-// dodecaplex vertices
-float dodecaVerts[] = {
-	0,0,2,2,0,0,2,-2,0,0,-2,2,0,0,-2,-2,0,2,2,0,0,2,-2,0,0,-2,2,0,0,-2,-2,0,0,2,0,2,0,2,0,-2,0,-2,0,2,0,-2,0,-2,2,0,0,2,2,0,0,-2,-2,0,0,2,-2,0,0,-2,2,0,2,0,2,0,-2,0,-2,0,2,0,-2,0,-2,0,2,2,0,0,2,-2,0,0,-2,2,0,0,-2,-2,0,0,
-	1,1,1,sq5,1,1,1,-sq5,1,1,-1,sq5,1,1,-1,-sq5,1,-1,1,sq5,1,-1,1,-sq5,1,-1,-1,sq5,1,-1,-1,-sq5,-1,1,1,sq5,-1,1,1,-sq5,-1,1,-1,sq5,-1,1,-1,-sq5,-1,-1,1,sq5,-1,-1,1,-sq5,-1,-1,-1,sq5,-1,-1,-1,-sq5,1,1,sq5,1,1,1,sq5,-1,1,1,-sq5,1,1,1,-sq5,-1,1,-1,sq5,1,1,-1,sq5,-1,1,-1,-sq5,1,1,-1,-sq5,-1,-1,1,sq5,1,-1,1,sq5,-1,-1,1,-sq5,1,-1,1,-sq5,-1,-1,-1,sq5,1,-1,-1,sq5,-1,-1,-1,-sq5,1,-1,-1,-sq5,-1,1,sq5,1,1,1,sq5,1,-1,1,sq5,-1,1,1,sq5,-1,-1,1,-sq5,1,1,1,-sq5,1,-1,1,-sq5,-1,1,1,-sq5,-1,-1,-1,sq5,1,1,-1,sq5,1,-1,-1,sq5,-1,1,-1,sq5,-1,-1,-1,-sq5,1,1,-1,-sq5,1,-1,-1,-sq5,-1,1,-1,-sq5,-1,-1,sq5,1,1,1,sq5,1,1,-1,sq5,1,-1,1,sq5,1,-1,-1,sq5,-1,1,1,sq5,-1,1,-1,sq5,-1,-1,1,sq5,-1,-1,-1,-sq5,1,1,1,-sq5,1,1,-1,-sq5,1,-1,1,-sq5,1,-1,-1,-sq5,-1,1,1,-sq5,-1,1,-1,-sq5,-1,-1,1,-sq5,-1,-1,-1,
-	pow(phi,-2),phi,phi,phi,pow(phi,-2),phi,phi,-phi,pow(phi,-2),phi,-phi,phi,pow(phi,-2),phi,-phi,-phi,pow(phi,-2),-phi,phi,phi,pow(phi,-2),-phi,phi,-phi,pow(phi,-2),-phi,-phi,phi,pow(phi,-2),-phi,-phi,-phi,-pow(phi,-2),phi,phi,phi,-pow(phi,-2),phi,phi,-phi,-pow(phi,-2),phi,-phi,phi,-pow(phi,-2),phi,-phi,-phi,-pow(phi,-2),-phi,phi,phi,-pow(phi,-2),-phi,phi,-phi,-pow(phi,-2),-phi,-phi,phi,-pow(phi,-2),-phi,-phi,-phi,phi,pow(phi,-2),phi,phi,phi,pow(phi,-2),phi,-phi,phi,pow(phi,-2),-phi,phi,phi,pow(phi,-2),-phi,-phi,phi,-pow(phi,-2),phi,phi,phi,-pow(phi,-2),phi,-phi,phi,-pow(phi,-2),-phi,phi,phi,-pow(phi,-2),-phi,-phi,-phi,pow(phi,-2),phi,phi,-phi,pow(phi,-2),phi,-phi,-phi,pow(phi,-2),-phi,phi,-phi,pow(phi,-2),-phi,-phi,-phi,-pow(phi,-2),phi,phi,-phi,-pow(phi,-2),phi,-phi,-phi,-pow(phi,-2),-phi,phi,-phi,-pow(phi,-2),-phi,-phi,phi,phi,pow(phi,-2),phi,phi,phi,pow(phi,-2),-phi,phi,phi,-pow(phi,-2),phi,phi,phi,-pow(phi,-2),-phi,phi,-phi,pow(phi,-2),phi,phi,-phi,pow(phi,-2),-phi,phi,-phi,-pow(phi,-2),phi,phi,-phi,-pow(phi,-2),-phi,-phi,phi,pow(phi,-2),phi,-phi,phi,pow(phi,-2),-phi,-phi,phi,-pow(phi,-2),phi,-phi,phi,-pow(phi,-2),-phi,-phi,-phi,pow(phi,-2),phi,-phi,-phi,pow(phi,-2),-phi,-phi,-phi,-pow(phi,-2),phi,-phi,-phi,-pow(phi,-2),-phi,phi,phi,phi,pow(phi,-2),phi,phi,phi,-pow(phi,-2),phi,phi,-phi,pow(phi,-2),phi,phi,-phi,-pow(phi,-2),phi,-phi,phi,pow(phi,-2),phi,-phi,phi,-pow(phi,-2),phi,-phi,-phi,pow(phi,-2),phi,-phi,-phi,-pow(phi,-2),-phi,phi,phi,pow(phi,-2),-phi,phi,phi,-pow(phi,-2),-phi,phi,-phi,pow(phi,-2),-phi,phi,-phi,-pow(phi,-2),-phi,-phi,phi,pow(phi,-2),-phi,-phi,phi,-pow(phi,-2),-phi,-phi,-phi,pow(phi,-2),-phi,-phi,-phi,-pow(phi,-2),
-	pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),pow(phi,-1),-pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),pow(phi,-1),-pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),pow(phi,-1),-pow(phi,2),-pow(phi,-1),-pow(phi,-1),-pow(phi,-1),
-	0,pow(phi,-2),1,pow(phi,2),0,pow(phi,-2),1,-pow(phi,2),0,pow(phi,-2),-1,pow(phi,2),0,pow(phi,-2),-1,-pow(phi,2),0,-pow(phi,-2),1,pow(phi,2),0,-pow(phi,-2),1,-pow(phi,2),0,-pow(phi,-2),-1,pow(phi,2),0,-pow(phi,-2),-1,-pow(phi,2),0,1,pow(phi,2),pow(phi,-2),0,1,pow(phi,2),-pow(phi,-2),0,1,-pow(phi,2),pow(phi,-2),0,1,-pow(phi,2),-pow(phi,-2),0,-1,pow(phi,2),pow(phi,-2),0,-1,pow(phi,2),-pow(phi,-2),0,-1,-pow(phi,2),pow(phi,-2),0,-1,-pow(phi,2),-pow(phi,-2),0,pow(phi,2),pow(phi,-2),1,0,pow(phi,2),pow(phi,-2),-1,0,pow(phi,2),-pow(phi,-2),1,0,pow(phi,2),-pow(phi,-2),-1,0,-pow(phi,2),pow(phi,-2),1,0,-pow(phi,2),pow(phi,-2),-1,0,-pow(phi,2),-pow(phi,-2),1,0,-pow(phi,2),-pow(phi,-2),-1,pow(phi,-2),0,pow(phi,2),1,pow(phi,-2),0,pow(phi,2),-1,pow(phi,-2),0,-pow(phi,2),1,pow(phi,-2),0,-pow(phi,2),-1,-pow(phi,-2),0,pow(phi,2),1,-pow(phi,-2),0,pow(phi,2),-1,-pow(phi,-2),0,-pow(phi,2),1,-pow(phi,-2),0,-pow(phi,2),-1,pow(phi,-2),1,0,pow(phi,2),pow(phi,-2),1,0,-pow(phi,2),pow(phi,-2),-1,0,pow(phi,2),pow(phi,-2),-1,0,-pow(phi,2),-pow(phi,-2),1,0,pow(phi,2),-pow(phi,-2),1,0,-pow(phi,2),-pow(phi,-2),-1,0,pow(phi,2),-pow(phi,-2),-1,0,-pow(phi,2),pow(phi,-2),pow(phi,2),1,0,pow(phi,-2),pow(phi,2),-1,0,pow(phi,-2),-pow(phi,2),1,0,pow(phi,-2),-pow(phi,2),-1,0,-pow(phi,-2),pow(phi,2),1,0,-pow(phi,-2),pow(phi,2),-1,0,-pow(phi,-2),-pow(phi,2),1,0,-pow(phi,-2),-pow(phi,2),-1,0,1,0,pow(phi,-2),pow(phi,2),1,0,pow(phi,-2),-pow(phi,2),1,0,-pow(phi,-2),pow(phi,2),1,0,-pow(phi,-2),-pow(phi,2),-1,0,pow(phi,-2),pow(phi,2),-1,0,pow(phi,-2),-pow(phi,2),-1,0,-pow(phi,-2),pow(phi,2),-1,0,-pow(phi,-2),-pow(phi,2),1,pow(phi,-2),pow(phi,2),0,1,pow(phi,-2),-pow(phi,2),0,1,-pow(phi,-2),pow(phi,2),0,1,-pow(phi,-2),-pow(phi,2),0,-1,pow(phi,-2),pow(phi,2),0,-1,pow(phi,-2),-pow(phi,2),0,-1,-pow(phi,-2),pow(phi,2),0,-1,-pow(phi,-2),-pow(phi,2),0,1,pow(phi,2),0,pow(phi,-2),1,pow(phi,2),0,-pow(phi,-2),1,-pow(phi,2),0,pow(phi,-2),1,-pow(phi,2),0,-pow(phi,-2),-1,pow(phi,2),0,pow(phi,-2),-1,pow(phi,2),0,-pow(phi,-2),-1,-pow(phi,2),0,pow(phi,-2),-1,-pow(phi,2),0,-pow(phi,-2),pow(phi,2),0,1,pow(phi,-2),pow(phi,2),0,1,-pow(phi,-2),pow(phi,2),0,-1,pow(phi,-2),pow(phi,2),0,-1,-pow(phi,-2),-pow(phi,2),0,1,pow(phi,-2),-pow(phi,2),0,1,-pow(phi,-2),-pow(phi,2),0,-1,pow(phi,-2),-pow(phi,2),0,-1,-pow(phi,-2),pow(phi,2),pow(phi,-2),0,1,pow(phi,2),pow(phi,-2),0,-1,pow(phi,2),-pow(phi,-2),0,1,pow(phi,2),-pow(phi,-2),0,-1,-pow(phi,2),pow(phi,-2),0,1,-pow(phi,2),pow(phi,-2),0,-1,-pow(phi,2),-pow(phi,-2),0,1,-pow(phi,2),-pow(phi,-2),0,-1,pow(phi,2),1,pow(phi,-2),0,pow(phi,2),1,-pow(phi,-2),0,pow(phi,2),-1,pow(phi,-2),0,pow(phi,2),-1,-pow(phi,-2),0,-pow(phi,2),1,pow(phi,-2),0,-pow(phi,2),1,-pow(phi,-2),0,-pow(phi,2),-1,pow(phi,-2),0,-pow(phi,2),-1,-pow(phi,-2),0,
-	0,pow(phi,-1),phi,sq5,0,pow(phi,-1),phi,-sq5,0,pow(phi,-1),-phi,sq5,0,pow(phi,-1),-phi,-sq5,0,-pow(phi,-1),phi,sq5,0,-pow(phi,-1),phi,-sq5,0,-pow(phi,-1),-phi,sq5,0,-pow(phi,-1),-phi,-sq5,0,phi,sq5,pow(phi,-1),0,phi,sq5,-pow(phi,-1),0,phi,-sq5,pow(phi,-1),0,phi,-sq5,-pow(phi,-1),0,-phi,sq5,pow(phi,-1),0,-phi,sq5,-pow(phi,-1),0,-phi,-sq5,pow(phi,-1),0,-phi,-sq5,-pow(phi,-1),0,sq5,pow(phi,-1),phi,0,sq5,pow(phi,-1),-phi,0,sq5,-pow(phi,-1),phi,0,sq5,-pow(phi,-1),-phi,0,-sq5,pow(phi,-1),phi,0,-sq5,pow(phi,-1),-phi,0,-sq5,-pow(phi,-1),phi,0,-sq5,-pow(phi,-1),-phi,pow(phi,-1),0,sq5,phi,pow(phi,-1),0,sq5,-phi,pow(phi,-1),0,-sq5,phi,pow(phi,-1),0,-sq5,-phi,-pow(phi,-1),0,sq5,phi,-pow(phi,-1),0,sq5,-phi,-pow(phi,-1),0,-sq5,phi,-pow(phi,-1),0,-sq5,-phi,pow(phi,-1),phi,0,sq5,pow(phi,-1),phi,0,-sq5,pow(phi,-1),-phi,0,sq5,pow(phi,-1),-phi,0,-sq5,-pow(phi,-1),phi,0,sq5,-pow(phi,-1),phi,0,-sq5,-pow(phi,-1),-phi,0,sq5,-pow(phi,-1),-phi,0,-sq5,pow(phi,-1),sq5,phi,0,pow(phi,-1),sq5,-phi,0,pow(phi,-1),-sq5,phi,0,pow(phi,-1),-sq5,-phi,0,-pow(phi,-1),sq5,phi,0,-pow(phi,-1),sq5,-phi,0,-pow(phi,-1),-sq5,phi,0,-pow(phi,-1),-sq5,-phi,0,phi,0,pow(phi,-1),sq5,phi,0,pow(phi,-1),-sq5,phi,0,-pow(phi,-1),sq5,phi,0,-pow(phi,-1),-sq5,-phi,0,pow(phi,-1),sq5,-phi,0,pow(phi,-1),-sq5,-phi,0,-pow(phi,-1),sq5,-phi,0,-pow(phi,-1),-sq5,phi,pow(phi,-1),sq5,0,phi,pow(phi,-1),-sq5,0,phi,-pow(phi,-1),sq5,0,phi,-pow(phi,-1),-sq5,0,-phi,pow(phi,-1),sq5,0,-phi,pow(phi,-1),-sq5,0,-phi,-pow(phi,-1),sq5,0,-phi,-pow(phi,-1),-sq5,0,phi,sq5,0,pow(phi,-1),phi,sq5,0,-pow(phi,-1),phi,-sq5,0,pow(phi,-1),phi,-sq5,0,-pow(phi,-1),-phi,sq5,0,pow(phi,-1),-phi,sq5,0,-pow(phi,-1),-phi,-sq5,0,pow(phi,-1),-phi,-sq5,0,-pow(phi,-1),sq5,0,phi,pow(phi,-1),sq5,0,phi,-pow(phi,-1),sq5,0,-phi,pow(phi,-1),sq5,0,-phi,-pow(phi,-1),-sq5,0,phi,pow(phi,-1),-sq5,0,phi,-pow(phi,-1),-sq5,0,-phi,pow(phi,-1),-sq5,0,-phi,-pow(phi,-1),sq5,pow(phi,-1),0,phi,sq5,pow(phi,-1),0,-phi,sq5,-pow(phi,-1),0,phi,sq5,-pow(phi,-1),0,-phi,-sq5,pow(phi,-1),0,phi,-sq5,pow(phi,-1),0,-phi,-sq5,-pow(phi,-1),0,phi,-sq5,-pow(phi,-1),0,-phi,sq5,phi,pow(phi,-1),0,sq5,phi,-pow(phi,-1),0,sq5,-phi,pow(phi,-1),0,sq5,-phi,-pow(phi,-1),0,-sq5,phi,pow(phi,-1),0,-sq5,phi,-pow(phi,-1),0,-sq5,-phi,pow(phi,-1),0,-sq5,-phi,-pow(phi,-1),0,
-	pow(phi,-1),1,phi,2,pow(phi,-1),1,phi,-2,pow(phi,-1),1,-phi,2,pow(phi,-1),1,-phi,-2,pow(phi,-1),-1,phi,2,pow(phi,-1),-1,phi,-2,pow(phi,-1),-1,-phi,2,pow(phi,-1),-1,-phi,-2,-pow(phi,-1),1,phi,2,-pow(phi,-1),1,phi,-2,-pow(phi,-1),1,-phi,2,-pow(phi,-1),1,-phi,-2,-pow(phi,-1),-1,phi,2,-pow(phi,-1),-1,phi,-2,-pow(phi,-1),-1,-phi,2,-pow(phi,-1),-1,-phi,-2,pow(phi,-1),phi,2,1,pow(phi,-1),phi,2,-1,pow(phi,-1),phi,-2,1,pow(phi,-1),phi,-2,-1,pow(phi,-1),-phi,2,1,pow(phi,-1),-phi,2,-1,pow(phi,-1),-phi,-2,1,pow(phi,-1),-phi,-2,-1,-pow(phi,-1),phi,2,1,-pow(phi,-1),phi,2,-1,-pow(phi,-1),phi,-2,1,-pow(phi,-1),phi,-2,-1,-pow(phi,-1),-phi,2,1,-pow(phi,-1),-phi,2,-1,-pow(phi,-1),-phi,-2,1,-pow(phi,-1),-phi,-2,-1,pow(phi,-1),2,1,phi,pow(phi,-1),2,1,-phi,pow(phi,-1),2,-1,phi,pow(phi,-1),2,-1,-phi,pow(phi,-1),-2,1,phi,pow(phi,-1),-2,1,-phi,pow(phi,-1),-2,-1,phi,pow(phi,-1),-2,-1,-phi,-pow(phi,-1),2,1,phi,-pow(phi,-1),2,1,-phi,-pow(phi,-1),2,-1,phi,-pow(phi,-1),2,-1,-phi,-pow(phi,-1),-2,1,phi,-pow(phi,-1),-2,1,-phi,-pow(phi,-1),-2,-1,phi,-pow(phi,-1),-2,-1,-phi,1,pow(phi,-1),2,phi,1,pow(phi,-1),2,-phi,1,pow(phi,-1),-2,phi,1,pow(phi,-1),-2,-phi,1,-pow(phi,-1),2,phi,1,-pow(phi,-1),2,-phi,1,-pow(phi,-1),-2,phi,1,-pow(phi,-1),-2,-phi,-1,pow(phi,-1),2,phi,-1,pow(phi,-1),2,-phi,-1,pow(phi,-1),-2,phi,-1,pow(phi,-1),-2,-phi,-1,-pow(phi,-1),2,phi,-1,-pow(phi,-1),2,-phi,-1,-pow(phi,-1),-2,phi,-1,-pow(phi,-1),-2,-phi,1,phi,pow(phi,-1),2,1,phi,pow(phi,-1),-2,1,phi,-pow(phi,-1),2,1,phi,-pow(phi,-1),-2,1,-phi,pow(phi,-1),2,1,-phi,pow(phi,-1),-2,1,-phi,-pow(phi,-1),2,1,-phi,-pow(phi,-1),-2,-1,phi,pow(phi,-1),2,-1,phi,pow(phi,-1),-2,-1,phi,-pow(phi,-1),2,-1,phi,-pow(phi,-1),-2,-1,-phi,pow(phi,-1),2,-1,-phi,pow(phi,-1),-2,-1,-phi,-pow(phi,-1),2,-1,-phi,-pow(phi,-1),-2,1,2,phi,pow(phi,-1),1,2,phi,-pow(phi,-1),1,2,-phi,pow(phi,-1),1,2,-phi,-pow(phi,-1),1,-2,phi,pow(phi,-1),1,-2,phi,-pow(phi,-1),1,-2,-phi,pow(phi,-1),1,-2,-phi,-pow(phi,-1),-1,2,phi,pow(phi,-1),-1,2,phi,-pow(phi,-1),-1,2,-phi,pow(phi,-1),-1,2,-phi,-pow(phi,-1),-1,-2,phi,pow(phi,-1),-1,-2,phi,-pow(phi,-1),-1,-2,-phi,pow(phi,-1),-1,-2,-phi,-pow(phi,-1),phi,pow(phi,-1),1,2,phi,pow(phi,-1),1,-2,phi,pow(phi,-1),-1,2,phi,pow(phi,-1),-1,-2,phi,-pow(phi,-1),1,2,phi,-pow(phi,-1),1,-2,phi,-pow(phi,-1),-1,2,phi,-pow(phi,-1),-1,-2,-phi,pow(phi,-1),1,2,-phi,pow(phi,-1),1,-2,-phi,pow(phi,-1),-1,2,-phi,pow(phi,-1),-1,-2,-phi,-pow(phi,-1),1,2,-phi,-pow(phi,-1),1,-2,-phi,-pow(phi,-1),-1,2,-phi,-pow(phi,-1),-1,-2,phi,1,2,pow(phi,-1),phi,1,2,-pow(phi,-1),phi,1,-2,pow(phi,-1),phi,1,-2,-pow(phi,-1),phi,-1,2,pow(phi,-1),phi,-1,2,-pow(phi,-1),phi,-1,-2,pow(phi,-1),phi,-1,-2,-pow(phi,-1),-phi,1,2,pow(phi,-1),-phi,1,2,-pow(phi,-1),-phi,1,-2,pow(phi,-1),-phi,1,-2,-pow(phi,-1),-phi,-1,2,pow(phi,-1),-phi,-1,2,-pow(phi,-1),-phi,-1,-2,pow(phi,-1),-phi,-1,-2,-pow(phi,-1),phi,2,pow(phi,-1),1,phi,2,pow(phi,-1),-1,phi,2,-pow(phi,-1),1,phi,2,-pow(phi,-1),-1,phi,-2,pow(phi,-1),1,phi,-2,pow(phi,-1),-1,phi,-2,-pow(phi,-1),1,phi,-2,-pow(phi,-1),-1,-phi,2,pow(phi,-1),1,-phi,2,pow(phi,-1),-1,-phi,2,-pow(phi,-1),1,-phi,2,-pow(phi,-1),-1,-phi,-2,pow(phi,-1),1,-phi,-2,pow(phi,-1),-1,-phi,-2,-pow(phi,-1),1,-phi,-2,-pow(phi,-1),-1,2,pow(phi,-1),phi,1,2,pow(phi,-1),phi,-1,2,pow(phi,-1),-phi,1,2,pow(phi,-1),-phi,-1,2,-pow(phi,-1),phi,1,2,-pow(phi,-1),phi,-1,2,-pow(phi,-1),-phi,1,2,-pow(phi,-1),-phi,-1,-2,pow(phi,-1),phi,1,-2,pow(phi,-1),phi,-1,-2,pow(phi,-1),-phi,1,-2,pow(phi,-1),-phi,-1,-2,-pow(phi,-1),phi,1,-2,-pow(phi,-1),phi,-1,-2,-pow(phi,-1),-phi,1,-2,-pow(phi,-1),-phi,-1,2,1,pow(phi,-1),phi,2,1,pow(phi,-1),-phi,2,1,-pow(phi,-1),phi,2,1,-pow(phi,-1),-phi,2,-1,pow(phi,-1),phi,2,-1,pow(phi,-1),-phi,2,-1,-pow(phi,-1),phi,2,-1,-pow(phi,-1),-phi,-2,1,pow(phi,-1),phi,-2,1,pow(phi,-1),-phi,-2,1,-pow(phi,-1),phi,-2,1,-pow(phi,-1),-phi,-2,-1,pow(phi,-1),phi,-2,-1,pow(phi,-1),-phi,-2,-1,-pow(phi,-1),phi,-2,-1,-pow(phi,-1),-phi,2,phi,1,pow(phi,-1),2,phi,1,-pow(phi,-1),2,phi,-1,pow(phi,-1),2,phi,-1,-pow(phi,-1),2,-phi,1,pow(phi,-1),2,-phi,1,-pow(phi,-1),2,-phi,-1,pow(phi,-1),2,-phi,-1,-pow(phi,-1),-2,phi,1,pow(phi,-1),-2,phi,1,-pow(phi,-1),-2,phi,-1,pow(phi,-1),-2,phi,-1,-pow(phi,-1),-2,-phi,1,pow(phi,-1),-2,-phi,1,-pow(phi,-1),-2,-phi,-1,pow(phi,-1),-2,-phi,-1,-pow(phi,-1),
-};
-// dodecaplex edges: connections between vertex indices
-int dodecaOrdering[] = {
-	0,312,0,316,0,336,0,340,1,313,1,317,1,337,1,341,2,314,2,318,2,338,2,342,3,315,3,319,3,339,3,343,4,320,4,321,4,352,4,356,5,322,5,323,5,353,5,357,6,324,6,325,6,354,6,358,7,326,7,327,7,355,7,359,8,328,8,330,8,344,8,348,9,329,9,331,9,345,9,349,10,332,10,334,10,346,10,350,11,333,11,335,11,347,11,351,12,360,12,362,12,392,12,394,13,361,13,363,13,393,13,395,14,364,14,366,14,396,14,398,15,365,15,367,15,397,15,399,16,368,16,370,16,384,16,385,17,369,17,371,17,386,17,387,18,372,18,374,18,388,18,389,19,373,19,375,19,390,19,391,20,376,20,377,20,400,20,401,21,378,21,379,21,402,21,403,22,380,22,381,22,404,22,405,23,382,23,383,23,406,23,407,24,152,24,408,24,472,24,504,25,153,25,409,25,473,25,505,26,154,26,410,26,474,26,506,27,155,27,411,27,475,27,507,28,156,28,412,28,476,28,508,29,157,29,413,29,477,29,509,30,158,30,414,30,478,30,510,31,159,31,415,31,479,31,511,32,160,32,416,32,480,32,512,33,161,33,417,33,481,33,513,34,162,34,418,34,482,34,514,35,163,35,419,35,483,35,515,36,164,36,420,36,484,36,516,37,165,37,421,37,485,37,517,38,166,38,422,38,486,38,518,39,167,39,423,39,487,39,519,40,168,40,424,40,456,40,520,41,169,41,425,41,457,41,521,42,170,42,426,42,458,42,522,43,171,43,427,43,459,43,523,44,172,44,428,44,460,44,524,45,173,45,429,45,461,45,525,46,174,46,430,46,462,46,526,47,175,47,431,47,463,47,527,48,176,48,432,48,464,48,528,49,177,49,433,49,465,49,529,50,178,50,434,50,466,50,530,51,179,51,435,51,467,51,531,52,180,52,436,52,468,52,532,53,181,53,437,53,469,53,533,54,182,54,438,54,470,54,534,55,183,55,439,55,471,55,535,56,184,56,440,56,488,56,536,57,185,57,441,57,489,57,537,58,186,58,442,58,490,58,538,59,187,59,443,59,491,59,539,60,188,60,444,60,492,60,540,61,189,61,445,61,493,61,541,62,190,62,446,62,494,62,542,63,191,63,447,63,495,63,543,64,192,64,448,64,496,64,544,65,193,65,449,65,497,65,545,66,194,66,450,66,498,66,546,67,195,67,451,67,499,67,547,68,196,68,452,68,500,68,548,69,197,69,453,69,501,69,549,70,198,70,454,70,502,70,550,71,199,71,455,71,503,71,551,72,200,72,552,72,568,72,584,73,201,73,553,73,569,73,585,74,202,74,554,74,570,74,586,75,203,75,555,75,571,75,587,76,204,76,556,76,572,76,588,77,205,77,557,77,573,77,589,78,206,78,558,78,574,78,590,79,207,79,559,79,575,79,591,80,208,80,560,80,576,80,592,81,209,81,561,81,577,81,593,82,210,82,562,82,578,82,594,83,211,83,563,83,579,83,595,84,212,84,564,84,580,84,596,85,213,85,565,85,581,85,597,86,214,86,566,86,582,86,598,87,215,87,567,87,583,87,599,88,96,88,408,88,424,88,440,89,97,89,409,89,425,89,441,90,98,90,410,90,426,90,442,91,99,91,411,91,427,91,443,92,100,92,412,92,428,92,444,93,101,93,413,93,429,93,445,94,102,94,414,94,430,94,446,95,103,95,415,95,431,95,447,96,416,96,432,96,448,97,417,97,433,97,449,98,418,98,434,98,450,99,419,99,435,99,451,100,420,100,436,100,452,101,421,101,437,101,453,102,422,102,438,102,454,103,423,103,439,103,455,104,108,104,456,104,504,104,552,105,109,105,457,105,505,105,553,106,110,106,458,106,506,106,554,107,111,107,459,107,507,107,555,108,460,108,508,108,556,109,461,109,509,109,557,110,462,110,510,110,558,111,463,111,511,111,559,112,116,112,464,112,512,112,560,113,117,113,465,113,513,113,561,114,118,114,466,114,514,114,562,115,119,115,467,115,515,115,563,116,468,116,516,116,564,117,469,117,517,117,565,118,470,118,518,118,566,119,471,119,519,119,567,120,122,120,472,120,536,120,568,121,123,121,473,121,537,121,569,122,474,122,538,122,570,123,475,123,539,123,571,124,126,124,476,124,540,124,572,125,127,125,477,125,541,125,573,126,478,126,542,126,574,127,479,127,543,127,575,128,130,128,480,128,544,128,576,129,131,129,481,129,545,129,577,130,482,130,546,130,578,131,483,131,547,131,579,132,134,132,484,132,548,132,580,133,135,133,485,133,549,133,581,134,486,134,550,134,582,135,487,135,551,135,583,136,137,136,488,136,520,136,584,137,489,137,521,137,585,138,139,138,490,138,522,138,586,139,491,139,523,139,587,140,141,140,492,140,524,140,588,141,493,141,525,141,589,142,143,142,494,142,526,142,590,143,495,143,527,143,591,144,145,144,496,144,528,144,592,145,497,145,529,145,593,146,147,146,498,146,530,146,594,147,499,147,531,147,595,148,149,148,500,148,532,148,596,149,501,149,533,149,597,150,151,150,502,150,534,150,598,151,503,151,535,151,599,152,216,152,248,152,264,153,217,153,249,153,265,154,218,154,248,154,266,155,219,155,249,155,267,156,220,156,250,156,264,157,221,157,251,157,265,158,222,158,250,158,266,159,223,159,251,159,267,160,216,160,252,160,268,161,217,161,253,161,269,162,218,162,252,162,270,163,219,163,253,163,271,164,220,164,254,164,268,165,221,165,255,165,269,166,222,166,254,166,270,167,223,167,255,167,271,168,224,168,240,168,272,169,225,169,241,169,272,170,226,170,242,170,273,171,227,171,243,171,273,172,228,172,240,172,274,173,229,173,241,173,274,174,230,174,242,174,275,175,231,175,243,175,275,176,224,176,244,176,276,177,225,177,245,177,276,178,226,178,246,178,277,179,227,179,247,179,277,180,228,180,244,180,278,181,229,181,245,181,278,182,230,182,246,182,279,183,231,183,247,183,279,184,232,184,256,184,280,185,233,185,256,185,281,186,234,186,257,186,280,187,235,187,257,187,281,188,236,188,258,188,282,189,237,189,258,189,283,190,238,190,259,190,282,191,239,191,259,191,283,192,232,192,260,192,284,193,233,193,260,193,285,194,234,194,261,194,284,195,235,195,261,195,285,196,236,196,262,196,286,197,237,197,262,197,287,198,238,198,263,198,286,199,239,199,263,199,287,200,288,200,296,200,304,201,289,201,297,201,304,202,290,202,296,202,305,203,291,203,297,203,305,204,288,204,298,204,306,205,289,205,299,205,306,206,290,206,298,206,307,207,291,207,299,207,307,208,292,208,300,208,308,209,293,209,301,209,308,210,294,210,300,210,309,211,295,211,301,211,309,212,292,212,302,212,310,213,293,213,303,213,310,214,294,214,302,214,311,215,295,215,303,215,311,216,220,216,312,217,221,217,313,218,222,218,314,219,223,219,315,220,316,221,317,222,318,223,319,224,225,224,320,225,321,226,227,226,322,227,323,228,229,228,324,229,325,230,231,230,326,231,327,232,234,232,328,233,235,233,329,234,330,235,331,236,238,236,332,237,239,237,333,238,334,239,335,240,244,240,336,241,245,241,337,242,246,242,338,243,247,243,339,244,340,245,341,246,342,247,343,248,252,248,344,249,253,249,345,250,254,250,346,251,255,251,347,252,348,253,349,254,350,255,351,256,260,256,352,257,261,257,353,258,262,258,354,259,263,259,355,260,356,261,357,262,358,263,359,264,266,264,360,265,267,265,361,266,362,267,363,268,270,268,364,269,271,269,365,270,366,271,367,272,274,272,368,273,275,273,369,274,370,275,371,276,278,276,372,277,279,277,373,278,374,279,375,280,281,280,376,281,377,282,283,282,378,283,379,284,285,284,380,285,381,286,287,286,382,287,383,288,289,288,384,289,385,290,291,290,386,291,387,292,293,292,388,293,389,294,295,294,390,295,391,296,298,296,392,297,299,297,393,298,394,299,395,300,302,300,396,301,303,301,397,302,398,303,399,304,305,304,400,305,401,306,307,306,402,307,403,308,309,308,404,309,405,310,311,310,406,311,407,312,408,312,416,313,409,313,417,314,410,314,418,315,411,315,419,316,412,316,420,317,413,317,421,318,414,318,422,319,415,319,423,320,424,320,432,321,425,321,433,322,426,322,434,323,427,323,435,324,428,324,436,325,429,325,437,326,430,326,438,327,431,327,439,328,440,328,448,329,441,329,449,330,442,330,450,331,443,331,451,332,444,332,452,333,445,333,453,334,446,334,454,335,447,335,455,336,456,336,460,337,457,337,461,338,458,338,462,339,459,339,463,340,464,340,468,341,465,341,469,342,466,342,470,343,467,343,471,344,472,344,474,345,473,345,475,346,476,346,478,347,477,347,479,348,480,348,482,349,481,349,483,350,484,350,486,351,485,351,487,352,488,352,489,353,490,353,491,354,492,354,493,355,494,355,495,356,496,356,497,357,498,357,499,358,500,358,501,359,502,359,503,360,504,360,508,361,505,361,509,362,506,362,510,363,507,363,511,364,512,364,516,365,513,365,517,366,514,366,518,367,515,367,519,368,520,368,521,369,522,369,523,370,524,370,525,371,526,371,527,372,528,372,529,373,530,373,531,374,532,374,533,375,534,375,535,376,536,376,538,377,537,377,539,378,540,378,542,379,541,379,543,380,544,380,546,381,545,381,547,382,548,382,550,383,549,383,551,384,552,384,556,385,553,385,557,386,554,386,558,387,555,387,559,388,560,388,564,389,561,389,565,390,562,390,566,391,563,391,567,392,568,392,570,393,569,393,571,394,572,394,574,395,573,395,575,396,576,396,578,397,577,397,579,398,580,398,582,399,581,399,583,400,584,400,585,401,586,401,587,402,588,402,589,403,590,403,591,404,592,404,593,405,594,405,595,406,596,406,597,407,598,407,599,408,456,409,457,410,458,411,459,412,460,413,461,414,462,415,463,416,464,417,465,418,466,419,467,420,468,421,469,422,470,423,471,424,488,425,489,426,490,427,491,428,492,429,493,430,494,431,495,432,496,433,497,434,498,435,499,436,500,437,501,438,502,439,503,440,472,441,473,442,474,443,475,444,476,445,477,446,478,447,479,448,480,449,481,450,482,451,483,452,484,453,485,454,486,455,487,504,568,505,569,506,570,507,571,508,572,509,573,510,574,511,575,512,576,513,577,514,578,515,579,516,580,517,581,518,582,519,583,520,552,521,553,522,554,523,555,524,556,525,557,526,558,527,559,528,560,529,561,530,562,531,563,532,564,533,565,534,566,535,567,536,584,537,585,538,586,539,587,540,588,541,589,542,590,543,591,544,592,545,593,546,594,547,595,548,596,549,597,550,598,551,599,
-};
-// tetraplex vertices
-float tetraVerts[] = {
-	0.5,0.5,0.5,0.5,	0.5,0.5,0.5,-0.5,	0.5,0.5,-0.5,0.5,	0.5,0.5,-0.5,-0.5,
-	0.5,-0.5,0.5,0.5,	0.5,-0.5,0.5,-0.5,	0.5,-0.5,-0.5,0.5,	0.5,-0.5,-0.5,-0.5,
-	-0.5,0.5,0.5,0.5,	-0.5,0.5,0.5,-0.5,	-0.5,0.5,-0.5,0.5,	-0.5,0.5,-0.5,-0.5,
-	-0.5,-0.5,0.5,0.5,	-0.5,-0.5,0.5,-0.5,	-0.5,-0.5,-0.5,0.5,	-0.5,-0.5,-0.5,-0.5,
-	0,0,0,1,	0,0,0,-1,	0,0,1,0,	0,0,-1,0,	0,1,0,0,	0,-1,0,0,	1,0,0,0,	-1,0,0,0,
-	0.5*phi,0.5,0.5/phi,0,		0.5*phi,0.5,-0.5/phi,0,		0.5*phi,-0.5,0.5/phi,0,		0.5*phi,-0.5,-0.5/phi,0,
-	-0.5*phi,0.5,0.5/phi,0,		-0.5*phi,0.5,-0.5/phi,0,	-0.5*phi,-0.5,0.5/phi,0,	-0.5*phi,-0.5,-0.5/phi,0,
-	0.5*phi,0.5/phi,0,0.5,		0.5*phi,0.5/phi,0,-0.5,		0.5*phi,-0.5/phi,0,0.5,		0.5*phi,-0.5/phi,0,-0.5,
-	-0.5*phi,0.5/phi,0,0.5,		-0.5*phi,0.5/phi,0,-0.5,	-0.5*phi,-0.5/phi,0,0.5,	-0.5*phi,-0.5/phi,0,-0.5,
-	0.5*phi,0,0.5,0.5/phi,		0.5*phi,0,0.5,-0.5/phi,		0.5*phi,0,-0.5,0.5/phi,		0.5*phi,0,-0.5,-0.5/phi,
-	-0.5*phi,0,0.5,0.5/phi,		-0.5*phi,0,0.5,-0.5/phi,	-0.5*phi,0,-0.5,0.5/phi,	-0.5*phi,0,-0.5,-0.5/phi,
-	0.5,0.5*phi,0,0.5/phi,		0.5,0.5*phi,0,-0.5/phi,		0.5,-0.5*phi,0,0.5/phi,		0.5,-0.5*phi,0,-0.5/phi,
-	-0.5,0.5*phi,0,0.5/phi,		-0.5,0.5*phi,0,-0.5/phi,	-0.5,-0.5*phi,0,0.5/phi,	-0.5,-0.5*phi,0,-0.5/phi,
-	0.5,0.5/phi,0.5*phi,0,		0.5,0.5/phi,-0.5*phi,0,		0.5,-0.5/phi,0.5*phi,0,		0.5,-0.5/phi,-0.5*phi,0,
-	-0.5,0.5/phi,0.5*phi,0,		-0.5,0.5/phi,-0.5*phi,0,	-0.5,-0.5/phi,0.5*phi,0,	-0.5,-0.5/phi,-0.5*phi,0,
-	0.5,0,0.5/phi,0.5*phi,		0.5,0,0.5/phi,-0.5*phi,		0.5,0,-0.5/phi,0.5*phi,		0.5,0,-0.5/phi,-0.5*phi,
-	-0.5,0,0.5/phi,0.5*phi,		-0.5,0,0.5/phi,-0.5*phi,	-0.5,0,-0.5/phi,0.5*phi,	-0.5,0,-0.5/phi,-0.5*phi,
-	0.5/phi,0.5*phi,0.5,0,		0.5/phi,0.5*phi,-0.5,0,		0.5/phi,-0.5*phi,0.5,0,		0.5/phi,-0.5*phi,-0.5,0,
-	-0.5/phi,0.5*phi,0.5,0,		-0.5/phi,0.5*phi,-0.5,0,	-0.5/phi,-0.5*phi,0.5,0,	-0.5/phi,-0.5*phi,-0.5,0,
-	0.5/phi,0.5,0,0.5*phi,		0.5/phi,0.5,0,-0.5*phi,		0.5/phi,-0.5,0,0.5*phi,		0.5/phi,-0.5,0,-0.5*phi,
-	-0.5/phi,0.5,0,0.5*phi,		-0.5/phi,0.5,0,-0.5*phi,	-0.5/phi,-0.5,0,0.5*phi,	-0.5/phi,-0.5,0,-0.5*phi,
-	0.5/phi,0,0.5*phi,0.5,		0.5/phi,0,0.5*phi,-0.5,		0.5/phi,0,-0.5*phi,0.5,		0.5/phi,0,-0.5*phi,-0.5,
-	-0.5/phi,0,0.5*phi,0.5,		-0.5/phi,0,0.5*phi,-0.5,	-0.5/phi,0,-0.5*phi,0.5,	-0.5/phi,0,-0.5*phi,-0.5,
-	0,0.5*phi,0.5/phi,0.5,		0,0.5*phi,0.5/phi,-0.5,		0,0.5*phi,-0.5/phi,0.5,		0,0.5*phi,-0.5/phi,-0.5,
-	0,-0.5*phi,0.5/phi,0.5,		0,-0.5*phi,0.5/phi,-0.5,	0,-0.5*phi,-0.5/phi,0.5,	0,-0.5*phi,-0.5/phi,-0.5,
-	0,0.5,0.5*phi,0.5/phi,		0,0.5,0.5*phi,-0.5/phi,		0,0.5,-0.5*phi,0.5/phi,		0,0.5,-0.5*phi,-0.5/phi,
-	0,-0.5,0.5*phi,0.5/phi,		0,-0.5,0.5*phi,-0.5/phi,	0,-0.5,-0.5*phi,0.5/phi,	0,-0.5,-0.5*phi,-0.5/phi,
-	0,0.5/phi,0.5,0.5*phi,		0,0.5/phi,0.5,-0.5*phi,		0,0.5/phi,-0.5,0.5*phi,		0,0.5/phi,-0.5,-0.5*phi,
-	0,-0.5/phi,0.5,0.5*phi,		0,-0.5/phi,0.5,-0.5*phi,	0,-0.5/phi,-0.5,0.5*phi,	0,-0.5/phi,-0.5,-0.5*phi,
-};
-// tetraplex edges: connections between vertex indices
-int tetraOrdering[] = {
-	0,24,0,32,0,40,0,48,0,56,0,64,0,72,0,80,0,88,0,96,0,104,0,112,1,24,1,33,1,41,1,49,1,56,1,65,1,72,1,81,1,89,1,97,1,105,1,113,2,25,2,32,2,42,2,48,2,57,2,66,2,73,2,80,2,90,2,98,2,106,2,114,3,25,3,33,3,43,3,49,3,57,3,67,3,73,3,81,3,91,3,99,3,107,3,115,4,26,4,34,4,40,4,50,4,58,4,64,4,74,4,82,4,88,4,100,4,108,4,116,5,26,5,35,5,41,5,51,5,58,5,65,5,74,5,83,5,89,5,101,5,109,5,117,6,27,6,34,6,42,6,50,6,59,6,66,6,75,6,82,6,90,6,102,6,110,6,118,7,27,7,35,7,43,7,51,7,59,7,67,7,75,7,83,7,91,7,103,7,111,7,119,8,28,8,36,8,44,8,52,8,60,8,68,8,76,8,84,8,92,8,96,8,104,8,112,9,28,9,37,9,45,9,53,9,60,9,69,9,76,9,85,9,93,9,97,9,105,9,113,10,29,10,36,10,46,10,52,10,61,10,70,10,77,10,84,10,94,10,98,10,106,10,114,11,29,11,37,11,47,11,53,11,61,11,71,11,77,11,85,11,95,11,99,11,107,11,115,12,30,12,38,12,44,12,54,12,62,12,68,12,78,12,86,12,92,12,100,12,108,12,116,13,30,13,39,13,45,13,55,13,62,13,69,13,78,13,87,13,93,13,101,13,109,13,117,14,31,14,38,14,46,14,54,14,63,14,70,14,79,14,86,14,94,14,102,14,110,14,118,15,31,15,39,15,47,15,55,15,63,15,71,15,79,15,87,15,95,15,103,15,111,15,119,16,64,16,66,16,68,16,70,16,80,16,82,16,84,16,86,16,112,16,114,16,116,16,118,17,65,17,67,17,69,17,71,17,81,17,83,17,85,17,87,17,113,17,115,17,117,17,119,18,56,18,58,18,60,18,62,18,88,18,89,18,92,18,93,18,104,18,105,18,108,18,109,19,57,19,59,19,61,19,63,19,90,19,91,19,94,19,95,19,106,19,107,19,110,19,111,20,48,20,49,20,52,20,53,20,72,20,73,20,76,20,77,20,96,20,97,20,98,20,99,21,50,21,51,21,54,21,55,21,74,21,75,21,78,21,79,21,100,21,101,21,102,21,103,22,24,22,25,22,26,22,27,22,32,22,33,22,34,22,35,22,40,22,41,22,42,22,43,23,28,23,29,23,30,23,31,23,36,23,37,23,38,23,39,23,44,23,45,23,46,23,47,24,25,24,32,24,33,24,40,24,41,24,48,24,49,24,56,24,72,25,32,25,33,25,42,25,43,25,48,25,49,25,57,25,73,26,27,26,34,26,35,26,40,26,41,26,50,26,51,26,58,26,74,27,34,27,35,27,42,27,43,27,50,27,51,27,59,27,75,28,29,28,36,28,37,28,44,28,45,28,52,28,53,28,60,28,76,29,36,29,37,29,46,29,47,29,52,29,53,29,61,29,77,30,31,30,38,30,39,30,44,30,45,30,54,30,55,30,62,30,78,31,38,31,39,31,46,31,47,31,54,31,55,31,63,31,79,32,34,32,40,32,42,32,48,32,64,32,66,32,80,33,35,33,41,33,43,33,49,33,65,33,67,33,81,34,40,34,42,34,50,34,64,34,66,34,82,35,41,35,43,35,51,35,65,35,67,35,83,36,38,36,44,36,46,36,52,36,68,36,70,36,84,37,39,37,45,37,47,37,53,37,69,37,71,37,85,38,44,38,46,38,54,38,68,38,70,38,86,39,45,39,47,39,55,39,69,39,71,39,87,40,41,40,56,40,58,40,64,40,88,41,56,41,58,41,65,41,89,42,43,42,57,42,59,42,66,42,90,43,57,43,59,43,67,43,91,44,45,44,60,44,62,44,68,44,92,45,60,45,62,45,69,45,93,46,47,46,61,46,63,46,70,46,94,47,61,47,63,47,71,47,95,48,49,48,72,48,73,48,80,48,96,48,98,49,72,49,73,49,81,49,97,49,99,50,51,50,74,50,75,50,82,50,100,50,102,51,74,51,75,51,83,51,101,51,103,52,53,52,76,52,77,52,84,52,96,52,98,53,76,53,77,53,85,53,97,53,99,54,55,54,78,54,79,54,86,54,100,54,102,55,78,55,79,55,87,55,101,55,103,56,58,56,72,56,88,56,89,56,104,56,105,57,59,57,73,57,90,57,91,57,106,57,107,58,74,58,88,58,89,58,108,58,109,59,75,59,90,59,91,59,110,59,111,60,62,60,76,60,92,60,93,60,104,60,105,61,63,61,77,61,94,61,95,61,106,61,107,62,78,62,92,62,93,62,108,62,109,63,79,63,94,63,95,63,110,63,111,64,66,64,80,64,82,64,88,64,112,64,116,65,67,65,81,65,83,65,89,65,113,65,117,66,80,66,82,66,90,66,114,66,118,67,81,67,83,67,91,67,115,67,119,68,70,68,84,68,86,68,92,68,112,68,116,69,71,69,85,69,87,69,93,69,113,69,117,70,84,70,86,70,94,70,114,70,118,71,85,71,87,71,95,71,115,71,119,72,76,72,96,72,97,72,104,72,105,73,77,73,98,73,99,73,106,73,107,74,78,74,100,74,101,74,108,74,109,75,79,75,102,75,103,75,110,75,111,76,96,76,97,76,104,76,105,77,98,77,99,77,106,77,107,78,100,78,101,78,108,78,109,79,102,79,103,79,110,79,111,80,84,80,96,80,98,80,112,80,114,81,85,81,97,81,99,81,113,81,115,82,86,82,100,82,102,82,116,82,118,83,87,83,101,83,103,83,117,83,119,84,96,84,98,84,112,84,114,85,97,85,99,85,113,85,115,86,100,86,102,86,116,86,118,87,101,87,103,87,117,87,119,88,92,88,104,88,108,88,112,88,116,89,93,89,105,89,109,89,113,89,117,90,94,90,106,90,110,90,114,90,118,91,95,91,107,91,111,91,115,91,119,92,104,92,108,92,112,92,116,93,105,93,109,93,113,93,117,94,106,94,110,94,114,94,118,95,107,95,111,95,115,95,119,96,98,96,104,96,112,97,99,97,105,97,113,98,106,98,114,99,107,99,115,100,102,100,108,100,116,101,103,101,109,101,117,102,110,102,118,103,111,103,119,104,105,104,112,105,113,106,107,106,114,107,115,108,109,108,116,109,117,110,111,110,118,111,119,112,116,113,117,114,118,115,119,
-};
-// Note:
-// polytope name	# of verts		# of edges		# of cells
-// 4-simplex		5				10				5-cell
-// tesseract		16				32				8-cell
-// 4-orthoplex		8				24				16-cell
-// octaplex			24				96				24-cell
-// dodecaplex		600				1200			120-cell
-// tetraplex		120				720				600-cell
-int vertNumList[] = { 5, 16, 8, 24, 600, 120 };
-int edgeNumList[] = { 10, 32, 24, 96, 1200, 720 };
-float * vertList[] = { simplexVerts, tessVerts, orthoVerts, octaVerts, dodecaVerts, tetraVerts };
-int * orderingList[] = { simplexOrdering, tessOrdering, orthoOrdering, octaOrdering, dodecaOrdering, tetraOrdering };
-LinearMapR4 * vertsMats;
-LinearMapR4 * edgesMats;
-
-float * unitVerts;	// points to one of the vertex arrays above
-float * verts;		// has a copy of unitVerts, but is changed based on xw rotation
-int * ordering;		// points to one of the ordering arrays above
+// The polytopes are not typed in: they are stored as their descriptions in PolytopeTable.h
+//    (a Coxeter diagram and the ringed nodes: the generating reflections and the orbit of
+//    one vertex), and expanded the first time they are shown. All are centered at the origin.
+// They are numbered by polytopeRegistry: first the built-in polytopes, then the stress
+//    scenes of StressScene4D.h (with stressSceneSize vertices), then any files loaded.
+PolytopeRegistry polytopeRegistry;
+int firstStressScene;		// The registry number of the first stress scene
+const Polytope4D* curPolytope;	// The polytope for the current mode, set by SelectPolytope()
+float * instanceMats;	// per-instance model matrices (16 floats each) for the instanced render path
+FrameArena frameArena;	// holds the rotated vertices and instanceMats; sized per polytope and reset every frame
+
+float * vertsX;		// the rotated vertices, one array per coordinate, in the vertex order of curPolytope
+float * vertsY;
+float * vertsZ;
+float * vertsW;		// not needed for rendering, but kept for completeness
+const int* ordering;		// the edges of curPolytope
 int idx = 0;
 int nVertices = 5;
 int nEdges = 10;
@@ -208,6 +100,146 @@ bool rotateOn = true;
 // *******************************
 GlGeomSphere texSphere(4, 4);
 GlGeomCylinder texCylinder(4, 4, 4);
+unsigned int sphereInstanceVBO;		// Per-instance model matrices for the vertex spheres
+unsigned int cylinderInstanceVBO;	// Per-instance model matrices for the edge cylinders
+GlStreamRing instanceRing;			// Persistently mapped buffer the instance matrices are written into (OpenGL 4.4)
+bool useInstanceRing = false;		// If false, the matrices are uploaded to the two VBO's above with glBufferData
+
+// *******************************
+// Screen-space level of detail for the instanced render path.
+// Level 0 is texSphere and texCylinder, at meshRes. Each further level halves the resolution.
+// Every sphere and cylinder picks its level from its radius on the screen, in pixels,
+//    and the instances are grouped by level so that each level is still one draw call.
+// A level only changes once the radius is lodHysteresis past the threshold, so
+//    instances near a threshold do not flicker between two meshes.
+// *******************************
+const int NumLods = 4;
+GlGeomSphere lodSpheres[NumLods - 1];		// Levels 1, 2, 3
+GlGeomCylinder lodCylinders[NumLods - 1];
+float lodMinRadius[NumLods - 1] = { 40.0f, 20.0f, 10.0f };	// Smallest radius in pixels for levels 0, 1, 2
+float lodHysteresis = 0.15f;
+const unsigned char LodNone = 0xff;			// A culled edge, or no level picked yet
+std::vector<unsigned char> vertexLods;		// Level of each sphere and cylinder in the last frame
+std::vector<unsigned char> edgeLods;
+int lodSerial = 0;							// The polytope (its GetSerial()) vertexLods and edgeLods belong to
+std::vector<float> lodScreenX;				// Scratch: each rotated vertex, in pixels, and its depth
+std::vector<float> lodScreenY;
+std::vector<float> lodDepth;
+long long lodInstanceCounts[2][NumLods];	// Statistics: spheres and cylinders drawn at each level
+long long lodNumCulled = 0;					// Statistics: edges culled as shorter than a pixel
+
+// *******************************
+// GPU-resident unit polytope, for the rpGpuRotate render path.
+// The current polytope's vertices and edges are uploaded once (when the mode changes)
+//    and read by vertexShader_PolytopeGpu through texture buffers.
+// *******************************
+unsigned int polytopeVertBuffer;	// Buffer holding the unit 4D vertices (4 floats each)
+unsigned int polytopeEdgeBuffer;	// Buffer holding the edges (2 ints each)
+unsigned int polytopeVertTex;		// Texture buffer object for polytopeVertBuffer (texture unit 1)
+unsigned int polytopeEdgeTex;		// Texture buffer object for polytopeEdgeBuffer (texture unit 2)
+int gpuPolytopeSerial = 0;			// The polytope (its GetSerial()) currently in the buffers
+int gpuPolytopeMode = -1;			// The mode it belongs to
+bool gpuPolytopeMorph = false;		// Whether the buffers hold the mode's morph, instead of its polytope
+int gpuRotationLoc;					// Uniform locations in shaderProgramGpu
+int gpuVertScaleLoc;
+int gpuShapeRadiusLoc;
+int gpuPrimitiveKindLoc;
+int gpuMorphingLoc;
+int gpuWythoffWeightsLoc;
+int gpuMorphRadiusLoc;
+int procModeLoc;					// Uniform locations in shaderProgramProc
+int procTexTimeLoc;
+
+// *******************************
+// Morphing the polytope through the uniform polytopes of its Coxeter diagram
+//    (the rpGpuRotate render path, with morphMode on). See WythoffMorph4D.
+// The morph's corner images and edges are uploaded once per mode, and the vertex
+//    shader places the vertices for morphPosition: scrubbing it costs one uniform.
+// *******************************
+WythoffMorph4D polytopeMorphs[numBuiltinPolytopes];	// Built the first time each mode is morphed
+bool polytopeMorphReversed[numBuiltinPolytopes];	// The diagram was reversed, as RegularPolytope4D does
+float polytopeMorphRadius[numBuiltinPolytopes];		// The circumradius of the mode's own polytope
+
+// *******************************
+// Ray-cast impostors for the polytope (the rpImpostor render path).
+// Each sphere is a quad and each cylinder a box, with a fixed number of vertices
+//    whatever meshRes is; the fragment shader finds the exact surface.
+// *******************************
+unsigned int impostorVAO[2];		// [0]: the quad for spheres, [1]: the box for cylinders
+unsigned int impostorVBO[2];		// Corners of the quad and of the box
+unsigned int impostorBoxEBO;
+unsigned int impostorInstanceVBO[2];	// Per instance: the sphere's center, or the cylinder's two ends
+int impostorRadiusLoc;				// Uniform locations in shaderProgramImpostor
+int impostorPrimitiveKindLoc;
+
+// *******************************
+// Wireframe rendering of the polytope (the rpWireframe render path).
+// The rotated x, y and z arrays are copied as they are into one buffer,
+//    and the edge list is the element buffer: one GL_LINES and one GL_POINTS draw.
+// *******************************
+unsigned int wireVAO;
+unsigned int wireVBO;				// vertsX, then vertsY, then vertsZ
+unsigned int wireEBO;				// The edges (2 ints each)
+int wireSerial = 0;					// The polytope (its GetSerial()) whose edges are currently in wireEBO
+int wireLinesLocs[6];			// Uniform locations: lineWidth, pointSize, viewportSize, primitiveKind,
+int wirePointsLocs[6];			//    skeletonColoring, skeletonScale
+float wireLineWidth = 1.5f;			// Line width and point size in pixels, when shapeRadius is 1
+float wirePointSize = 5.0f;
+
+// *******************************
+// Skeleton graph queries (see SkeletonGraph4D), shown as colors by the rpGpuRotate
+//    and rpWireframe render paths when skeletonColoring is on.
+// The graph is built once per polytope. Its values (a distance or a color number, or -1
+//    for the usual color) are recomputed when the coloring or the source changes, and
+//    are read by the shaders from two texture buffers, one float per vertex and per edge.
+// *******************************
+SkeletonGraph4D skeletonGraph;
+int skeletonGraphSerial = 0;		// The polytope (its GetSerial()) skeletonGraph was built from
+int skeletonDiameter = -1;			// Its diameter, once found
+bool skeletonDiameterExact = false;
+int skeletonAttribSerial = 0;		// The polytope, coloring and source of the values in the buffers
+int skeletonAttribColoring = scNone;
+int skeletonAttribSource = -1;
+float skeletonAttribScale = 1.0f;	// 1/(largest distance), for the shaders' distance colors
+unsigned int skeletonVertBuffer;
+unsigned int skeletonEdgeBuffer;
+unsigned int skeletonVertTex;		// Texture buffer object for skeletonVertBuffer (texture unit 3)
+unsigned int skeletonEdgeTex;		// Texture buffer object for skeletonEdgeBuffer (texture unit 4)
+int gpuSkeletonColoringLoc;			// Uniform locations in shaderProgramGpu
+int gpuSkeletonScaleLoc;
+
+// *******************************
+// Multi-draw-indirect rendering of the whole scene (the rpIndirect render path).
+// All the meshes share the buffers of sceneArena. Each frame, one draw record per
+//    object (modelview matrix, material and texture) is loaded into a shader storage
+//    buffer, and one draw command per mesh into the indirect buffer.
+// The polytope's spheres and cylinders have one record each kind: the vertex shader
+//    places them from the GPU-resident polytope (see UploadPolytopeToGpu()), so the
+//    records and commands are a few hundred bytes whatever the polytope.
+// *******************************
+typedef struct {
+	float modelviewMatrix[16];
+	float emissiveColor[4];
+	float ambientColor[4];
+	float diffuseColor[4];
+	float specularColor[4];		// [3] is the specular exponent
+	int flags[4];				// Texture kind (0 none, 1 bitmap, 2 procedural), texture number, use Fresnel,
+								//    and 0, or 1 for the polytope's spheres, 2 for its cylinders
+} DrawRecord;					// Must match phDrawRecord in EduPhong.glsl (std430 layout)
+
+GlMeshArena sceneArena;
+int arenaSphere, arenaCylinder, arenaLightSphere, arenaWalls, arenaFloor;	// Mesh numbers in sceneArena
+const int MaxDrawRecords = 4 + numLightSpheres;	// Walls, floor, light spheres, polytope spheres and cylinders
+const int MaxDrawCommands = 5;
+unsigned int drawRecordSSBO;		// The draw records (shader storage binding 0), MaxDrawRecords long
+unsigned int indirectBuffer;		// The draw commands, MaxDrawCommands long
+unsigned int drawRecordNumVBO;		// 0, 1, 2, ...: the record number of each instance
+int drawRecordNumCapacity = 0;		// Number of entries in drawRecordNumVBO
+int indirectModeLoc;				// Uniform locations in shaderProgramIndirect
+int indirectTexTimeLoc;
+int indirectRotationLoc;
+int indirectVertScaleLoc;
+int indirectShapeRadiusLoc;
 // ************************
 // General data helping with setting up VAO (Vertex Array Objects)
 //    and Vertex Buffer Objects.
@@ -235,12 +267,12 @@ void SetupForTextures()
 	materialUnderTexture.SpecularExponent = 40.0;
 	// Load texture maps
 	RgbImage texMap;
-	glUseProgram(shaderProgramBitmap);
-	glActiveTexture(GL_TEXTURE0);
+	GlStateCache::UseProgram(shaderProgramBitmap);
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
 	glGenTextures(NumTextures, TextureNames);
 	for (int i = 0; i < NumTextures; i++) {
 		texMap.LoadBmpFile(TextureFiles[i]);            // Read i-th texture from the i-th file.
-		glBindTexture(GL_TEXTURE_2D, TextureNames[i]);  // Bind (select) the i-th OpenGL texture
+		GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[i]);  // Bind (select) the i-th OpenGL texture
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 		// Set best quality filtering.   Also see below for disabling mipmaps.
@@ -260,9 +292,230 @@ void SetupForTextures()
 #endif
 	}
 	// Make sure that the shaderProgramBitmap uses the GL_TEXTURE_0 texture.
-	glUseProgram(shaderProgramBitmap);
-	glUniform1i(glGetUniformLocation(shaderProgramBitmap, "theTextureMap"), 0);
-	glActiveTexture(GL_TEXTURE0);
+	GlStateCache::UseProgram(shaderProgramBitmap);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramBitmap, "theTextureMap"), 0);
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
+}
+
+// **********************
+// Builds polytope from vertices and edges, with the 2-faces and cells of topo: any class
+//   with GetNumFaces(), GetFaceSize(), GetFace() and the same for cells (RegularPolytope4D,
+//   Off4DFile, PolytopeTopology4D). Their items are contiguous, so only the starts are made here.
+// **********************
+template <class Topology>
+bool BuildWithTopology(Polytope4D& polytope, const float* verts, int numVerts, const int* edges, int numEdges,
+	const Topology& topo) {
+	int numFaces = topo.GetNumFaces();
+	int numCells = topo.GetNumCells();
+	std::vector<int> faceStart(1, 0);
+	std::vector<int> cellStart(1, 0);
+	for (int f = 0; f < numFaces; f++) {
+		faceStart.push_back(faceStart.back() + topo.GetFaceSize(f));
+	}
+	for (int c = 0; c < numCells; c++) {
+		cellStart.push_back(cellStart.back() + topo.GetCellSize(c));
+	}
+	return polytope.Build(verts, numVerts, edges, numEdges,
+		faceStart.data(), numFaces > 0 ? topo.GetFace(0) : 0, numFaces,
+		cellStart.data(), numCells > 0 ? topo.GetCell(0) : 0, numCells);
+}
+
+// **********************
+// Reports how close together Polytope4D::Build() put the ends of the edges
+//    (see Reorder4D.h): the edge spans in the order the polytope came in, and after.
+// **********************
+void PrintEdgeSpans(const Polytope4D& polytope) {
+	const EdgeSpanStats& before = polytope.GetEdgeSpanBefore();
+	const EdgeSpanStats& after = polytope.GetEdgeSpanAfter();
+	printf("   Edge span: mean %.1f, median %d, max %d as generated; mean %.1f, median %d, max %d as stored.\n",
+		before.mean, before.median, before.max, after.mean, after.median, after.max);
+}
+
+// **********************
+// Expands polytope k from its entry in polytopeTable (a Coxeter diagram and the
+//   ringed nodes) to its full vertex and edge arrays (and 2-faces and cells, for
+//   the regular ones). This is the builder of the registry's first entries.
+// **********************
+bool BuildBuiltinPolytope(int k, Polytope4D& polytope) {
+	double startTime = glfwGetTime();
+	const PolytopeInfo& info = polytopeTable[k];
+	bool ok;
+	if (info.regular) {
+		RegularPolytope4D poly;
+		ok = poly.Generate(info.m01, info.m12, info.m23, info.edgeLength);
+		ok = ok && BuildWithTopology(polytope, poly.GetVerts(), poly.GetNumVerts(), poly.GetEdges(), poly.GetNumEdges(), poly);
+	}
+	else {
+		UniformPolytope4D poly;
+		ok = poly.Generate(info.m01, info.m12, info.m23, info.ringMask, info.edgeLength);
+		ok = ok && polytope.Build(poly.GetVerts(), poly.GetNumVerts(), poly.GetEdges(), poly.GetNumEdges());
+	}
+	polytope.SetInfo(info.name, psBuiltin, k);
+	if (!ok) {
+		fprintf(stderr, "Error: could not generate the %s.\n", info.name);
+		return false;
+	}
+	if (polytope.GetNumVerts() != info.numVerts || polytope.GetNumEdges() != info.numEdges) {
+		fprintf(stderr, "Error: the %s has %d vertices and %d edges, expected %d and %d.\n",
+			info.name, polytope.GetNumVerts(), polytope.GetNumEdges(), info.numVerts, info.numEdges);
+		return false;
+	}
+	printf("Expanded the %s from %d bytes to %d in %.1f ms.\n", info.name, (int)sizeof(PolytopeInfo),
+		(int)polytope.GetNumBytes(), 1000.0 * (glfwGetTime() - startTime));
+	PrintEdgeSpans(polytope);
+	return true;
+}
+
+// **********************
+// Generates a stress scene with stressSceneSize vertices.
+// **********************
+bool BuildStressScene(int kind, Polytope4D& polytope) {
+	double startTime = glfwGetTime();
+	StressScene4D scene;
+	bool ok = scene.Generate(kind, stressSceneSize)
+		&& polytope.Build(scene.GetVerts(), scene.GetNumVerts(), scene.GetEdges(), scene.GetNumEdges());
+	polytope.SetInfo(StressScene4D::GetName(kind), psGenerated);
+	if (!ok) {
+		fprintf(stderr, "Error: could not generate the %s.\n", StressScene4D::GetName(kind));
+		return false;
+	}
+	printf("Generated the %s (%d vertices, %d edges) in %.1f ms.\n", StressScene4D::GetName(kind),
+		polytope.GetNumVerts(), polytope.GetNumEdges(), 1000.0 * (glfwGetTime() - startTime));
+	PrintEdgeSpans(polytope);
+	return true;
+}
+
+// **********************
+// Adds the built-in polytopes and the stress scenes to polytopeRegistry.
+// Nothing is built until it is first shown.
+// **********************
+void RegisterPolytopes() {
+	for (int k = 0; k < numBuiltinPolytopes; k++) {
+		polytopeRegistry.AddLazy(polytopeTable[k].name, [k](Polytope4D& p) { return BuildBuiltinPolytope(k, p); });
+	}
+	firstStressScene = polytopeRegistry.GetCount();
+	for (int kind = 0; kind < numStressScenes; kind++) {
+		polytopeRegistry.AddLazy(StressScene4D::GetName(kind), [kind](Polytope4D& p) { return BuildStressScene(kind, p); });
+	}
+}
+
+// **********************
+// The stress scenes are generated again, at the new stressSceneSize, when next shown.
+// **********************
+void InvalidateStressScenes() {
+	for (int kind = 0; kind < numStressScenes; kind++) {
+		polytopeRegistry.Invalidate(firstStressScene + kind);
+	}
+}
+
+// **********************
+// Loads a polytope file and adds it to polytopeRegistry. Returns its number, or -1.
+// Binary polytope files (PolytopeFile.h) are used in place, from the mapping: they
+//    are already in the order Polytope4D::Build() would give them. Unless validate
+//    is false, their indices and antipodes are checked first (MappedPolytope::Validate()).
+// 4OFF files (Off4D.h) are used as they are.
+// Any other file is read as bare points, x y z w on each line: if hull is true they
+//    are replaced by their convex hull (ConvexHull4D.h), otherwise their edges are
+//    the pairs at the smallest distance (EdgeFinder4D.h).
+// **********************
+int LoadPolytope(const char* filename, bool hull, bool validate) {
+	double startTime = glfwGetTime();
+	char magic[8] = { 0 };
+	FILE* file = fopen(filename, "rb");
+	if (file == 0) {
+		fprintf(stderr, "Unable to open file '%s' for reading.\n", filename);
+		return -1;
+	}
+	size_t magicLen = fread(magic, 1, sizeof(magic), file);
+	fclose(file);
+
+	Polytope4D polytope;
+	bool ok = false;
+	if (magicLen == sizeof(magic) && memcmp(magic, "POLY4D", 6) == 0) {
+		std::shared_ptr<MappedPolytope> mapped = std::make_shared<MappedPolytope>();
+		if (mapped->Open(filename) && (!validate || mapped->Validate())) {
+			PolytopeArrays arrays;
+			mapped->GetArrays(arrays);
+			polytope.Borrow(arrays, mapped);
+			ok = true;
+		}
+		polytope.SetInfo(filename, psFile);
+	}
+	else if (magicLen >= 4 && memcmp(magic, "4OFF", 4) == 0) {
+		Off4DFile off;
+		if (off.Read(filename)) {
+			ok = BuildWithTopology(polytope, off.GetVerts(), off.GetNumVerts(), off.GetEdges(), off.GetNumEdges(), off);
+		}
+		polytope.SetInfo(filename, psFile);
+	}
+	else {
+		std::vector<float> points;
+		float v[4];
+		file = fopen(filename, "r");
+		while (file != 0 && fscanf(file, "%f %f %f %f", v, v + 1, v + 2, v + 3) == 4) {
+			points.insert(points.end(), v, v + 4);
+		}
+		if (file != 0) {
+			fclose(file);
+		}
+		int numPoints = (int)points.size() / 4;
+		if (numPoints < 2) {
+			fprintf(stderr, "File '%s' has no polytope or points in it.\n", filename);
+		}
+		else if (hull) {
+			ConvexHull4D theHull;
+			if (theHull.Build(points.data(), numPoints)) {
+				ok = BuildWithTopology(polytope, theHull.GetVerts(), theHull.GetNumVerts(),
+					theHull.GetEdges(), theHull.GetNumEdges(), theHull.GetTopology());
+			}
+		}
+		else {
+			std::vector<int> edges;
+			FindEdges4D(points.data(), numPoints, edges);
+			ok = polytope.Build(points.data(), numPoints, edges.data(), (int)edges.size() / 2);
+		}
+		polytope.SetInfo(filename, psPoints);
+	}
+	if (!ok) {
+		fprintf(stderr, "Could not load a polytope from '%s'.\n", filename);
+		return -1;
+	}
+	printf("Loaded '%s' (%d vertices, %d edges) in %.1f ms.\n", filename,
+		polytope.GetNumVerts(), polytope.GetNumEdges(), 1000.0 * (glfwGetTime() - startTime));
+	PrintEdgeSpans(polytope);
+	return polytopeRegistry.Add(std::move(polytope));
+}
+
+// **********************
+// Writes polytope k to a binary polytope file (PolytopeFile.h), in the order it is
+//    stored in, so that loading the file again copies and reorders nothing.
+// **********************
+bool SavePolytope(int k, const char* filename) {
+	const Polytope4D& polytope = polytopeRegistry.Get(k);
+	if (!WritePolytopeFile(filename, polytope)) {
+		return false;
+	}
+	printf("Wrote '%s' (%d vertices, %d edges) to '%s'.\n", polytope.GetName(),
+		polytope.GetNumVerts(), polytope.GetNumEdges(), filename);
+	return true;
+}
+
+// **********************
+// The polytopes the 'P' key cycles through, and their names, for the console.
+// **********************
+int GetNumPolytopes() {
+	return polytopeRegistry.GetCount();
+}
+
+const char* GetPolytopeName(int k) {
+	return polytopeRegistry.GetName(k);
+}
+
+// **********************
+// Whether polytope k can morph: only the built-in ones have a Coxeter diagram.
+// **********************
+bool PolytopeHasMorph(int k) {
+	return k < numBuiltinPolytopes;
 }
 
 // **********************
@@ -270,17 +523,109 @@ void SetupForTextures()
 //  It is called only once.
 // **********************
 void MySetupSurfaces() {
-	// change vertices of dodecaplex such that the edge lengths are all 0.6
-	for (int i = 0; i < 4 * vertNumList[4]; i++) {
-		dodecaVerts[i] /= (3 - sq5)/0.6f;
-	}
-	// change vertices of tetraplex such that all edge lengths are 1
-	for (int i = 0; i < 4 * vertNumList[5]; i++) {
-		tetraVerts[i] *= phi;
-	}
+	RegisterPolytopes();
 
 	texSphere.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
 	texCylinder.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+	for (int k = 1; k < NumLods; k++) {
+		SphereLod(k).InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+		CylinderLod(k).InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+	}
+	RemeshLods();
+
+	// Per-instance model matrices for the instanced render path.
+	// The VAO's of the spheres and cylinders are reused when they are remeshed, so
+	//    the instance attributes only need to be attached once.
+	glGenBuffers(1, &sphereInstanceVBO);
+	glGenBuffers(1, &cylinderInstanceVBO);
+	AttachLodInstanceMatrices(sphereInstanceVBO, cylinderInstanceVBO);
+	useInstanceRing = GlStreamRing::IsSupported();
+
+	// Buffers and texture buffer objects for the GPU-resident polytope.
+	// They are filled in by UploadPolytopeToGpu() the first time each mode is rendered.
+	glGenBuffers(1, &polytopeVertBuffer);
+	glGenBuffers(1, &polytopeEdgeBuffer);
+	glGenTextures(1, &polytopeVertTex);
+	glGenTextures(1, &polytopeEdgeTex);
+	GlStateCache::UseProgram(shaderProgramGpu);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramGpu, "unitVerts"), 1);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramGpu, "edgeEnds"), 2);
+	gpuRotationLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "rotation4");
+	gpuVertScaleLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "vertScale");
+	gpuShapeRadiusLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "shapeRadius");
+	gpuPrimitiveKindLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "primitiveKind");
+	gpuMorphingLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "morphing");
+	gpuWythoffWeightsLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "wythoffWeights");
+	gpuMorphRadiusLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "morphRadius");
+	gpuSkeletonColoringLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "skeletonColoring");
+	gpuSkeletonScaleLoc = GlShaderMgr::GetUniformLocation(shaderProgramGpu, "skeletonScale");
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramGpu, "vertAttribs"), 3);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramGpu, "edgeAttribs"), 4);
+	procModeLoc = GlShaderMgr::GetUniformLocation(shaderProgramProc, "mode");
+	procTexTimeLoc = GlShaderMgr::GetUniformLocation(shaderProgramProc, "texTime");
+
+	// The proxy geometry for the impostors
+	float quadCorners[] = { -1,-1,0,	1,-1,0,		-1,1,0,		1,1,0 };	// A triangle strip
+	float boxCorners[] = {
+		-1,-1,-1,	1,-1,-1,	-1,1,-1,	1,1,-1,
+		-1,-1,1,	1,-1,1,		-1,1,1,		1,1,1,
+	};
+	unsigned int boxElts[] = {
+		0,2,1, 1,2,3,	4,5,6, 5,7,6,	0,1,4, 1,5,4,
+		2,6,3, 3,6,7,	0,4,2, 2,4,6,	1,3,5, 3,7,5,
+	};
+	glGenVertexArrays(2, impostorVAO);
+	glGenBuffers(2, impostorVBO);
+	glGenBuffers(2, impostorInstanceVBO);
+	glGenBuffers(1, &impostorBoxEBO);
+	for (int k = 0; k < 2; k++) {
+		GlStateCache::BindVertexArray(impostorVAO[k]);
+		glBindBuffer(GL_ARRAY_BUFFER, impostorVBO[k]);
+		if (k == 0) {
+			glBufferData(GL_ARRAY_BUFFER, sizeof(quadCorners), quadCorners, GL_STATIC_DRAW);
+		}
+		else {
+			glBufferData(GL_ARRAY_BUFFER, sizeof(boxCorners), boxCorners, GL_STATIC_DRAW);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, impostorBoxEBO);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(boxElts), boxElts, GL_STATIC_DRAW);
+		}
+		glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(vertPos_loc);
+		// The spheres use only the first endpoint: it advances 3 floats per instance instead of 6.
+		glBindBuffer(GL_ARRAY_BUFFER, impostorInstanceVBO[k]);
+		for (int e = 0; e <= k; e++) {
+			glVertexAttribPointer(instanceMatrix_loc + e, 3, GL_FLOAT, GL_FALSE, 3 * (k + 1) * sizeof(float), (void*)(3 * e * sizeof(float)));
+			glEnableVertexAttribArray(instanceMatrix_loc + e);
+			glVertexAttribDivisor(instanceMatrix_loc + e, 1);
+		}
+	}
+	GlStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	impostorRadiusLoc = GlShaderMgr::GetUniformLocation(shaderProgramImpostor, "shapeRadius");
+	impostorPrimitiveKindLoc = GlShaderMgr::GetUniformLocation(shaderProgramImpostor, "primitiveKind");
+
+	// The wireframe buffers are filled when first rendered
+	glGenVertexArrays(1, &wireVAO);
+	glGenBuffers(1, &wireVBO);
+	glGenBuffers(1, &wireEBO);
+	const char* wireUniformNames[6] = { "lineWidth", "pointSize", "viewportSize", "primitiveKind",
+		"skeletonColoring", "skeletonScale" };
+	for (int k = 0; k < 6; k++) {
+		wireLinesLocs[k] = GlShaderMgr::GetUniformLocation(shaderProgramWireLines, wireUniformNames[k]);
+		wirePointsLocs[k] = GlShaderMgr::GetUniformLocation(shaderProgramWirePoints, wireUniformNames[k]);
+	}
+	GlStateCache::UseProgram(shaderProgramWireLines);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramWireLines, "vertAttribs"), 3);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramWireLines, "edgeAttribs"), 4);
+	GlStateCache::UseProgram(shaderProgramWirePoints);
+	GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramWirePoints, "vertAttribs"), 3);
+
+	// The skeleton values are filled in by UpdateSkeletonAttribs() when a coloring is first shown
+	glGenBuffers(1, &skeletonVertBuffer);
+	glGenBuffers(1, &skeletonEdgeBuffer);
+	glGenTextures(1, &skeletonVertTex);
+	glGenTextures(1, &skeletonEdgeTex);
+	glEnable(GL_PROGRAM_POINT_SIZE);		// The point size comes from the vertex shader
 
 	// Initialize the VAO's, VBO's and EBO's for the ground plane, the back wall
 	// and the surface of rotation. Gives them the "vertPos" location,
@@ -305,7 +650,7 @@ void MySetupSurfaces() {
 	};
 	unsigned int floorElts[] = { 0, 3, 1, 2 };
 	glBindBuffer(GL_ARRAY_BUFFER, myVBO[iFloor]);
-	glBindVertexArray(myVAO[iFloor]);
+	GlStateCache::BindVertexArray(myVAO[iFloor]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(floorVerts), floorVerts, GL_STATIC_DRAW);
 	glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(vertPos_loc);
@@ -325,7 +670,7 @@ void MySetupSurfaces() {
 	};
 	unsigned int wallEltsB[] = { 0, 3, 1, 2 };
 	glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWallB]);
-	glBindVertexArray(myVAO[iWallB]);
+	GlStateCache::BindVertexArray(myVAO[iWallB]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(wallVertsB), wallVertsB, GL_STATIC_DRAW);
 	glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(vertPos_loc);
@@ -345,7 +690,7 @@ void MySetupSurfaces() {
 	};
 	unsigned int wallEltsL[] = { 0, 3, 1, 2 };
 	glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWallL]);
-	glBindVertexArray(myVAO[iWallL]);
+	GlStateCache::BindVertexArray(myVAO[iWallL]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(wallVertsL), wallVertsL, GL_STATIC_DRAW);
 	glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(vertPos_loc);
@@ -365,7 +710,7 @@ void MySetupSurfaces() {
 	};
 	unsigned int wallEltsF[] = { 0, 3, 1, 2 };
 	glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWallF]);
-	glBindVertexArray(myVAO[iWallF]);
+	GlStateCache::BindVertexArray(myVAO[iWallF]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(wallVertsF), wallVertsF, GL_STATIC_DRAW);
 	glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(vertPos_loc);
@@ -385,7 +730,7 @@ void MySetupSurfaces() {
 	};
 	unsigned int wallEltsR[] = { 0, 3, 1, 2 };
 	glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWallR]);
-	glBindVertexArray(myVAO[iWallR]);
+	GlStateCache::BindVertexArray(myVAO[iWallR]);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(wallVertsR), wallVertsR, GL_STATIC_DRAW);
 	glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(vertPos_loc);
@@ -396,14 +741,823 @@ void MySetupSurfaces() {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iWallR]);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wallEltsR) * sizeof(unsigned int), wallEltsR, GL_STATIC_DRAW);
 
+	// The same geometry again, in the shared buffers used by the multi-draw-indirect path.
+	// A draw command has a single primitive type, so the triangle strips become triangles.
+	if (shaderProgramIndirect != 0) {
+		const float* quads[4] = { wallVertsB, wallVertsL, wallVertsF, wallVertsR };
+		const unsigned int* strips[4] = { wallEltsB, wallEltsL, wallEltsF, wallEltsR };
+		float wallVerts[4 * 32];
+		unsigned int wallElts[4 * 6];
+		for (int i = 0; i < 4; i++) {
+			memcpy(wallVerts + 32 * i, quads[i], 32 * sizeof(float));
+			StripQuadToTriangles(strips[i], 4 * i, wallElts + 6 * i);
+		}
+		unsigned int floorTris[6];
+		StripQuadToTriangles(floorElts, 0, floorTris);
+
+		sceneArena.SetAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+		arenaSphere = sceneArena.AddMesh();
+		arenaCylinder = sceneArena.AddMesh();
+		arenaLightSphere = sceneArena.AddMesh();
+		arenaWalls = sceneArena.AddMesh();
+		arenaFloor = sceneArena.AddMesh();
+		sceneArena.SetMesh(arenaSphere, texSphere);
+		sceneArena.SetMesh(arenaCylinder, texCylinder);
+		sceneArena.SetMesh(arenaLightSphere, myLightSphere);
+		sceneArena.SetMesh(arenaWalls, wallVerts, 16, wallElts, 24);
+		sceneArena.SetMesh(arenaFloor, floorVerts, 4, floorTris, 6);
+		sceneArena.Upload();
+
+		// The records and commands are rewritten every frame, but never grow.
+		glGenBuffers(1, &drawRecordSSBO);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawRecordSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, MaxDrawRecords * sizeof(DrawRecord), 0, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glGenBuffers(1, &indirectBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, MaxDrawCommands * sizeof(GlDrawElementsIndirectCommand), 0, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glGenBuffers(1, &drawRecordNumVBO);
+		GlStateCache::BindVertexArray(sceneArena.GetVAO());
+		glBindBuffer(GL_ARRAY_BUFFER, drawRecordNumVBO);
+		glVertexAttribIPointer(drawRecord_loc, 1, GL_INT, sizeof(int), (void*)0);
+		glEnableVertexAttribArray(drawRecord_loc);
+		glVertexAttribDivisor(drawRecord_loc, 1);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// Walls use the procedural texture (with theTextureMap) and sceneTextures[i] holds TextureNames[i].
+		// The polytope's texture buffers are on units 1 and 2, as for shaderProgramGpu.
+		GlStateCache::UseProgram(shaderProgramIndirect);
+		GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "theTextureMap"), 0);
+		GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "unitVerts"), 1);
+		GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "edgeEnds"), 2);
+		for (int i = 0; i < NumTextures; i++) {
+			char name[32];
+			sprintf(name, "sceneTextures[%d]", i);
+			GlStateCache::Uniform1i(GlShaderMgr::GetUniformLocation(shaderProgramIndirect, name), 3 + i);
+		}
+		indirectModeLoc = GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "mode");
+		indirectTexTimeLoc = GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "texTime");
+		indirectRotationLoc = GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "rotation4");
+		indirectVertScaleLoc = GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "vertScale");
+		indirectShapeRadiusLoc = GlShaderMgr::GetUniformLocation(shaderProgramIndirect, "shapeRadius");
+	}
+
 	check_for_opengl_errors();
 }
 
+// **********************
+// The two triangles of the quad drawn as the triangle strip strip[0..3],
+//   keeping the strip's orientation, with firstVert added to each element.
+// **********************
+void StripQuadToTriangles(const unsigned int* strip, unsigned int firstVert, unsigned int* tris) {
+	tris[0] = firstVert + strip[0];
+	tris[1] = firstVert + strip[1];
+	tris[2] = firstVert + strip[2];
+	tris[3] = firstVert + strip[2];
+	tris[4] = firstVert + strip[1];
+	tris[5] = firstVert + strip[3];
+}
+
+// **********************
+// Attaches an instance buffer to a VAO. The buffer holds one 4x4 model matrix
+//   (16 floats, by columns) per instance, read from the four attribute
+//   locations starting at instanceMatrix_loc, advancing once per instance.
+// The first instance is byteOffset bytes into the buffer.
+// **********************
+void AttachInstanceMatrices(unsigned int vao, unsigned int instanceVBO, size_t byteOffset) {
+	GlStateCache::BindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	for (int c = 0; c < 4; c++) {
+		glVertexAttribPointer(instanceMatrix_loc + c, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(byteOffset + 4 * c * sizeof(float)));
+		glEnableVertexAttribArray(instanceMatrix_loc + c);
+		glVertexAttribDivisor(instanceMatrix_loc + c, 1);
+	}
+	GlStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// The i-th rotated vertex, projected to xyz
+inline VectorR3 RotatedVert(int i) {
+	return VectorR3(vertsX[i], vertsY[i], vertsZ[i]);
+}
+
+// **********************
+// The sphere and cylinder meshes of each level of detail.
+// **********************
+GlGeomSphere& SphereLod(int k) {
+	return k == 0 ? texSphere : lodSpheres[k - 1];
+}
+
+GlGeomCylinder& CylinderLod(int k) {
+	return k == 0 ? texCylinder : lodCylinders[k - 1];
+}
+
+// Remeshes levels 1 and up from meshRes. Level 0 is remeshed as texSphere and texCylinder.
+void RemeshLods() {
+	for (int k = 1; k < NumLods; k++) {
+		int res = meshRes >> k;
+		res = res < 3 ? 3 : res;
+		lodSpheres[k - 1].Remesh(res, res);
+		lodCylinders[k - 1].Remesh(res, res, res);
+	}
+}
+
+void AttachLodInstanceMatrices(unsigned int sphereVBO, unsigned int cylinderVBO) {
+	for (int k = 0; k < NumLods; k++) {
+		AttachInstanceMatrices(SphereLod(k).GetVAO(), sphereVBO);
+		AttachInstanceMatrices(CylinderLod(k).GetVAO(), cylinderVBO);
+	}
+}
+
+// **********************
+// The level of detail for a radius of radiusPx pixels, given last frame's level.
+// Moving to a finer level needs lodHysteresis more than the threshold,
+//    and moving to a coarser level needs lodHysteresis less.
+// **********************
+int PickLod(float radiusPx, int previous) {
+	int finer = NumLods - 1;
+	int coarser = NumLods - 1;
+	for (int k = NumLods - 2; k >= 0; k--) {
+		if (radiusPx >= lodMinRadius[k] * (1.0f + lodHysteresis)) {
+			finer = k;
+		}
+		if (radiusPx >= lodMinRadius[k] * (1.0f - lodHysteresis)) {
+			coarser = k;
+		}
+	}
+	if (previous >= NumLods) {
+		return coarser;		// No history: either choice is fine
+	}
+	if (finer < previous) {
+		return finer;
+	}
+	if (coarser > previous) {
+		return coarser;
+	}
+	return previous;
+}
+
+// **********************
+// Picks the level of detail of every sphere and (if withEdges) of every cylinder,
+//   culls the edges shorter than a pixel on the screen, and writes the instance
+//   matrices into sphereMats and cylinderMats grouped by level.
+// The instances of level k are sphereStart[k] up to sphereStart[k+1], and likewise
+//   for cylinderStart. sphereStart[NumLods] and cylinderStart[NumLods] are the totals.
+// A culled edge is hidden inside the spheres at its ends anyway, since they are
+//   no thinner than the cylinder.
+// **********************
+void BucketInstancesByLod(const LinearMapR4& polytopeMat, int nCylinders,
+						  float* sphereMats, float* cylinderMats, int* sphereStart, int* cylinderStart) {
+	if (lodSerial != curPolytope->GetSerial() || (int)vertexLods.size() != nVertices || (int)edgeLods.size() != nEdges) {
+		vertexLods.assign(nVertices, LodNone);
+		edgeLods.assign(nEdges, LodNone);
+		lodSerial = curPolytope->GetSerial();
+	}
+	lodScreenX.resize(nVertices);
+	lodScreenY.resize(nVertices);
+	lodDepth.resize(nVertices);
+
+	// The projection is a symmetric frustum: pixels per unit of length at unit distance from the eye.
+	const LinearMapR4& proj = theProjectionMatrix;
+	float halfWidth = 0.5f * (float)screenWidth;
+	float halfHeight = 0.5f * (float)screenHeight;
+	float pixelsPerUnit = halfHeight * (float)proj.m22;
+	// CalcVertexMatrix and CalcEdgeMatrix both scale the radius by shapeRadius
+	float radius = (float)(shapeRadius * sqrt(polytopeMat.m11 * polytopeMat.m11 + polytopeMat.m21 * polytopeMat.m21
+		+ polytopeMat.m31 * polytopeMat.m31));
+	const float minDepth = 1.0e-6f;
+
+	int counts[2][NumLods];
+	memset(counts, 0, sizeof(counts));
+	for (int i = 0; i < nVertices; i++) {
+		VectorR3 v = RotatedVert(i);
+		polytopeMat.AffineTransformPosition(v);
+		float depth = (float)(-v.z);
+		lodDepth[i] = depth;
+		float radiusPx = 1.0e10f;
+		if (depth > minDepth) {
+			lodScreenX[i] = halfWidth * (float)(proj.m11 * v.x + proj.m13 * v.z) / depth;
+			lodScreenY[i] = halfHeight * (float)(proj.m22 * v.y + proj.m23 * v.z) / depth;
+			radiusPx = radius * pixelsPerUnit / depth;
+		}
+		int lod = PickLod(radiusPx, vertexLods[i]);
+		vertexLods[i] = (unsigned char)lod;
+		counts[0][lod]++;
+	}
+	for (int e = 0; e < nCylinders; e++) {
+		int v1 = ordering[2 * e];
+		int v2 = ordering[2 * e + 1];
+		float nearDepth = lodDepth[v1] < lodDepth[v2] ? lodDepth[v1] : lodDepth[v2];
+		float radiusPx = 1.0e10f;
+		if (nearDepth > minDepth) {
+			float dx = lodScreenX[v2] - lodScreenX[v1];
+			float dy = lodScreenY[v2] - lodScreenY[v1];
+			if (dx * dx + dy * dy < 1.0f) {
+				edgeLods[e] = LodNone;
+				lodNumCulled++;
+				continue;
+			}
+			radiusPx = radius * pixelsPerUnit / nearDepth;
+		}
+		int lod = PickLod(radiusPx, edgeLods[e]);
+		edgeLods[e] = (unsigned char)lod;
+		counts[1][lod]++;
+	}
+
+	int next[2][NumLods];
+	sphereStart[0] = 0;
+	cylinderStart[0] = 0;
+	for (int k = 0; k < NumLods; k++) {
+		next[0][k] = sphereStart[k];
+		next[1][k] = cylinderStart[k];
+		sphereStart[k + 1] = sphereStart[k] + counts[0][k];
+		cylinderStart[k + 1] = cylinderStart[k] + counts[1][k];
+		lodInstanceCounts[0][k] += counts[0][k];
+		lodInstanceCounts[1][k] += counts[1][k];
+	}
+
+	LinearMapR4 identity;
+	identity.SetIdentity();
+	LinearMapR4 instMat;
+	for (int i = 0; i < nVertices; i++) {
+		CalcVertexMatrix(identity, RotatedVert(i), instMat);
+		instMat.DumpByColumns(sphereMats + 16 * next[0][vertexLods[i]]++);
+	}
+	for (int e = 0; e < nCylinders; e++) {
+		if (edgeLods[e] == LodNone) {
+			continue;
+		}
+		CalcEdgeMatrix(identity, RotatedVert(ordering[2 * e]), RotatedVert(ordering[2 * e + 1]), instMat);
+		instMat.DumpByColumns(cylinderMats + 16 * next[1][edgeLods[e]]++);
+	}
+}
+
+// **********************
+// Model matrices for a vertex sphere and an edge cylinder.
+// The matrix is formed by multiplying base on the right, so base can be
+//    the polytope's modelview matrix (per-object rendering), or the identity
+//    (instanced rendering, where the shader applies the modelview matrix).
+// **********************
+void CalcVertexMatrix(const LinearMapR4& base, const VectorR3& v, LinearMapR4& mat) {
+	mat = base;
+	mat.Mult_glTranslate(v.x, v.y, v.z);
+	mat.Mult_glScale(shapeRadius);
+}
+
+void CalcEdgeMatrix(const LinearMapR4& base, const VectorR3& v1, const VectorR3& v2, LinearMapR4& mat) {
+	x_1 = (float)v1.x; y_1 = (float)v1.y; z_1 = (float)v1.z;
+	x_2 = (float)v2.x; y_2 = (float)v2.y; z_2 = (float)v2.z;
+	normD = sqrt(pow(x_2 - x_1, 2) + pow(y_2 - y_1, 2) + pow(z_2 - z_1, 2));
+	mat = base;
+	mat.Mult_glTranslate(x_1, y_1, z_1);
+	mat.Mult_glTranslate(0.5*(x_2 - x_1), 0.5*(y_2 - y_1), 0.5*(z_2 - z_1));
+	if (pow(z_2 - z_1, 2) + pow(x_2 - x_1, 2) > 0) {
+		mat.Mult_glRotate(atan2(sqrt(pow(x_2 - x_1, 2) + pow(z_2 - z_1, 2)), y_2 - y_1), z_2 - z_1, 0, x_1 - x_2);
+	}
+	mat.Mult_glScale(0.8, 0.5 * normD, 0.8);
+	mat.Mult_glScale(shapeRadius, 1, shapeRadius);
+}
+
+// **********************
+// Loads vertex data (numTexels vec4's) and edges into the GPU buffers
+//    of the rpGpuRotate render path.
+// **********************
+void LoadGpuPolytopeBuffers(const float* texels, int numTexels, const int* edges, int numEdges) {
+	glBindBuffer(GL_TEXTURE_BUFFER, polytopeVertBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, 4 * numTexels * sizeof(float), texels, GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, polytopeEdgeBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, 2 * numEdges * sizeof(int), edges, GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	GlStateCache::ActiveTexture(GL_TEXTURE1);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeVertTex);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, polytopeVertBuffer);
+	GlStateCache::ActiveTexture(GL_TEXTURE2);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeEdgeTex);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32I, polytopeEdgeBuffer);
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
+}
+
+// **********************
+// Loads the unit polytope for the current mode into the GPU buffers.
+// Only needs to be done when the mode changes (or its polytope is rebuilt).
+// The shader reads the vertices interleaved, so they are interleaved here, unless the
+//    polytope (from a polytope file) has them so already.
+// **********************
+void UploadPolytopeToGpu() {
+	std::vector<float> texels;
+	const float* verts = curPolytope->GetAosVerts();		// A polytope file has them interleaved already
+	if (verts == 0) {
+		texels.resize(4 * (size_t)nVertices);
+		curPolytope->CopyVerts(texels.data());
+		verts = texels.data();
+	}
+	LoadGpuPolytopeBuffers(verts, nVertices, ordering, nEdges);
+	gpuPolytopeSerial = curPolytope->GetSerial();
+	gpuPolytopeMode = mode;
+	gpuPolytopeMorph = false;
+}
+
+// **********************
+// The morph of polytope k, built the first time it is asked for.
+// Its diagram is the one polytopeTable gives; a regular polytope's is reversed
+//    when RegularPolytope4D reverses it, so the morph starts in the same orientation.
+// **********************
+WythoffMorph4D& GetPolytopeMorph(int k) {
+	WythoffMorph4D& morph = polytopeMorphs[k];
+	if (morph.GetNumVerts() == 0) {
+		double startTime = glfwGetTime();
+		const PolytopeInfo& info = polytopeTable[k];
+		bool reversed = info.regular && info.m01 < info.m23;
+		if (!morph.Generate(reversed ? info.m23 : info.m01, info.m12, reversed ? info.m01 : info.m23)) {
+			fprintf(stderr, "Error: could not generate the morph of the %s.\n", info.name);
+		}
+		polytopeMorphReversed[k] = reversed;
+		polytopeMorphRadius[k] = polytopeRegistry.Get(k).GetCircumradius();
+		printf("Built the morph of the %s (%d vertices, %d edges) in %.1f ms.\n", info.name,
+			morph.GetNumVerts(), morph.GetNumEdges(), 1000.0 * (glfwGetTime() - startTime));
+	}
+	return morph;
+}
+
+// **********************
+// Where polytope k is on the path of its morph: 0 to 3, from the polytope
+//    with node 0 of its diagram ringed to the one with node 3 ringed.
+// The polytopes that are not on the path (such as the runcinated ones) start at 0.
+// Only the built-in polytopes have a morph.
+// **********************
+double MorphStartPosition(int k) {
+	if (!PolytopeHasMorph(k)) {
+		return 0.0;
+	}
+	WythoffMorph4D& morph = GetPolytopeMorph(k);
+	const PolytopeInfo& info = polytopeTable[k];
+	if (info.regular) {
+		return polytopeMorphReversed[k] ? 3.0 : 0.0;
+	}
+	double position = morph.GetPathPosition(info.ringMask);
+	return position < 0.0 ? 0.0 : position;
+}
+
+// **********************
+// Loads the morph for the current mode into the GPU buffers.
+// Only needs to be done when the mode changes, not when morphPosition does.
+// **********************
+void UploadMorphToGpu() {
+	WythoffMorph4D& morph = GetPolytopeMorph(mode);
+	LoadGpuPolytopeBuffers(morph.GetCorners(), 4 * morph.GetNumVerts(), morph.GetEdges(), morph.GetNumEdges());
+	gpuPolytopeSerial = 0;
+	gpuPolytopeMode = mode;
+	gpuPolytopeMorph = true;
+}
+
+// **********************
+// Renders the polytope with the rotation done in the vertex shader.
+// The CPU work is the same for every polytope: compose the rotation,
+//    set a few uniforms and issue two instanced draw calls.
+// **********************
+void RenderPolytopeGpu(const LinearMapR4& polytopeMat) {
+	float matEntries[16];
+	bool uploaded = morphMode ? (gpuPolytopeMorph && gpuPolytopeMode == mode)
+		: (!gpuPolytopeMorph && gpuPolytopeSerial == curPolytope->GetSerial());
+	if (!uploaded) {
+		if (morphMode) {
+			UploadMorphToGpu();
+		}
+		else {
+			UploadPolytopeToGpu();
+		}
+	}
+	int numVerts = nVertices;
+	int numEdges = nEdges;
+
+	selectShaderProgram(shaderProgramGpu);
+	materialUnderTexture.LoadIntoShaders();
+	polytopeMat.DumpByColumns(matEntries);
+	GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
+	composeRotation4D(thetas, matEntries);
+	GlStateCache::UniformMatrix4fv(gpuRotationLoc, matEntries);
+	GlStateCache::Uniform1f(gpuVertScaleLoc, (float)(vScale / sq2));
+	GlStateCache::Uniform1f(gpuShapeRadiusLoc, (float)shapeRadius);
+	GlStateCache::Uniform1i(gpuMorphingLoc, morphMode);
+	if (morphMode) {
+		float weights[4];
+		WythoffMorph4D::GetPathWeights(morphPosition, weights);
+		GlStateCache::Uniform4f(gpuWythoffWeightsLoc, weights[0], weights[1], weights[2], weights[3]);
+		GlStateCache::Uniform1f(gpuMorphRadiusLoc, polytopeMorphRadius[mode]);
+		numVerts = polytopeMorphs[mode].GetNumVerts();
+		numEdges = polytopeMorphs[mode].GetNumEdges();
+	}
+
+	// The morph has vertices of its own, so it is never colored by the skeleton
+	bool skeletonColors = !morphMode && UpdateSkeletonAttribs();
+	GlStateCache::Uniform1i(gpuSkeletonColoringLoc, skeletonColors ? skeletonColoring : scNone);
+	GlStateCache::Uniform1f(gpuSkeletonScaleLoc, skeletonAttribScale);
+
+	GlStateCache::ActiveTexture(GL_TEXTURE1);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeVertTex);
+	GlStateCache::ActiveTexture(GL_TEXTURE2);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeEdgeTex);
+	if (skeletonColors) {
+		GlStateCache::ActiveTexture(GL_TEXTURE3);
+		GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonVertTex);
+		GlStateCache::ActiveTexture(GL_TEXTURE4);
+		GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonEdgeTex);
+	}
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
+	GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[2]);
+	GlStateCache::Uniform1i(applyTextureLocation, !skeletonColors);	// The texture would hide the colors
+
+	GlStateCache::Uniform1i(gpuPrimitiveKindLoc, 0);
+	texSphere.RenderInstanced(numVerts);
+	if (!vertsOnly) {
+		GlStateCache::Uniform1i(gpuPrimitiveKindLoc, 1);
+		texCylinder.RenderInstanced(numEdges);
+	}
+
+	GlStateCache::Uniform1i(applyTextureLocation, false);
+	selectShaderProgram(shaderProgramBitmap);
+}
+
+// **********************
+// Renders the rotated polytope's spheres and cylinders as ray-cast impostors.
+// Only the centers and the edge endpoints are sent; instanceMats is used as scratch space.
+// **********************
+void RenderPolytopeImpostors(const LinearMapR4& polytopeMat) {
+	float matEntries[16];
+	int nCylinders = vertsOnly ? 0 : nEdges;
+	float* centers = instanceMats;
+	float* ends = instanceMats + 3 * nVertices;
+	for (int i = 0; i < nVertices; i++) {
+		centers[3 * i] = vertsX[i];
+		centers[3 * i + 1] = vertsY[i];
+		centers[3 * i + 2] = vertsZ[i];
+	}
+	for (idx = 0; idx < nCylinders; idx++) {
+		int v1 = ordering[2 * idx];
+		int v2 = ordering[2 * idx + 1];
+		float* e = ends + 6 * idx;
+		e[0] = vertsX[v1]; e[1] = vertsY[v1]; e[2] = vertsZ[v1];
+		e[3] = vertsX[v2]; e[4] = vertsY[v2]; e[5] = vertsZ[v2];
+	}
+
+	selectShaderProgram(shaderProgramImpostor);
+	materialUnderTexture.LoadIntoShaders();
+	polytopeMat.DumpByColumns(matEntries);
+	GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
+	GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[2]);
+	GlStateCache::Uniform1i(applyTextureLocation, true);
+
+	// The sphere radius matches CalcVertexMatrix, the cylinder radius CalcEdgeMatrix.
+	glBindBuffer(GL_ARRAY_BUFFER, impostorInstanceVBO[0]);
+	glBufferData(GL_ARRAY_BUFFER, 3 * nVertices * sizeof(float), centers, GL_STREAM_DRAW);
+	GlStateCache::Uniform1i(impostorPrimitiveKindLoc, 0);
+	GlStateCache::Uniform1f(impostorRadiusLoc, (float)shapeRadius);
+	GlStateCache::BindVertexArray(impostorVAO[0]);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, nVertices);
+	if (nCylinders > 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, impostorInstanceVBO[1]);
+		glBufferData(GL_ARRAY_BUFFER, 6 * nCylinders * sizeof(float), ends, GL_STREAM_DRAW);
+		GlStateCache::Uniform1i(impostorPrimitiveKindLoc, 1);
+		GlStateCache::Uniform1f(impostorRadiusLoc, (float)(0.8 * shapeRadius));
+		GlStateCache::BindVertexArray(impostorVAO[1]);
+		glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0, nCylinders);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GlStateCache::Uniform1i(applyTextureLocation, false);
+	selectShaderProgram(shaderProgramBitmap);
+}
+
+// **********************
+// Renders the rotated polytope's edges as anti-aliased lines and its vertices as round points.
+// Nothing is built per vertex or per edge: the rotated coordinates are uploaded as they are.
+// **********************
+void RenderPolytopeWireframe(const LinearMapR4& polytopeMat) {
+	float matEntries[16];
+	size_t coordBytes = nVertices * sizeof(float);
+	GlStateCache::BindVertexArray(wireVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, wireVBO);
+	glBufferData(GL_ARRAY_BUFFER, 3 * coordBytes, NULL, GL_STREAM_DRAW);	// Orphan last frame's buffer
+	glBufferSubData(GL_ARRAY_BUFFER, 0, coordBytes, vertsX);
+	glBufferSubData(GL_ARRAY_BUFFER, coordBytes, coordBytes, vertsY);
+	glBufferSubData(GL_ARRAY_BUFFER, 2 * coordBytes, coordBytes, vertsZ);
+	if (wireSerial != curPolytope->GetSerial()) {
+		// The edges, and the offsets of the y and z arrays, only change with the polytope.
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, wireEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, 2 * nEdges * sizeof(int), ordering, GL_STATIC_DRAW);
+		for (int k = 0; k < 3; k++) {
+			glVertexAttribPointer(k, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(k * coordBytes));
+			glEnableVertexAttribArray(k);
+		}
+		wireSerial = curPolytope->GetSerial();
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	bool skeletonColors = UpdateSkeletonAttribs();
+	if (skeletonColors) {
+		GlStateCache::ActiveTexture(GL_TEXTURE3);
+		GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonVertTex);
+		GlStateCache::ActiveTexture(GL_TEXTURE4);
+		GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonEdgeTex);
+		GlStateCache::ActiveTexture(GL_TEXTURE0);
+	}
+
+	polytopeMat.DumpByColumns(matEntries);
+	float lineWidth = (float)(wireLineWidth * shapeRadius);
+	float pointSize = (float)(wirePointSize * shapeRadius);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	for (int k = vertsOnly ? 1 : 0; k < 2; k++) {
+		unsigned int program = k == 0 ? shaderProgramWireLines : shaderProgramWirePoints;
+		int* locs = k == 0 ? wireLinesLocs : wirePointsLocs;
+		GlStateCache::UseProgram(program);
+		GlStateCache::UniformMatrix4fv(phGetModelviewMatLoc(program), matEntries);
+		GlStateCache::Uniform1f(locs[0], lineWidth);
+		GlStateCache::Uniform1f(locs[1], pointSize);
+		GlStateCache::Uniform2f(locs[2], (float)screenWidth, (float)screenHeight);
+		GlStateCache::Uniform1i(locs[3], k == 0 ? 1 : 0);
+		GlStateCache::Uniform1i(locs[4], skeletonColors ? skeletonColoring : scNone);
+		GlStateCache::Uniform1f(locs[5], skeletonAttribScale);
+		if (k == 0) {
+			glDrawElements(GL_LINES, 2 * nEdges, GL_UNSIGNED_INT, (void*)0);
+		}
+		else {
+			glDrawArrays(GL_POINTS, 0, nVertices);
+		}
+	}
+	glDisable(GL_BLEND);
+	selectShaderProgram(shaderProgramBitmap);
+}
+
+// **********************
+// Prints the number of vertices at each distance from the source, and the diameter.
+// The built-in polytopes are uniform, so every vertex is as far from the others as
+//    any other is: the largest distance from any one vertex is the diameter.
+// Otherwise the diameter is found by SkeletonGraph4D::Diameter(), within a budget of searches.
+// **********************
+void PrintSkeletonShells(const std::vector<int>& dist, int eccentricity) {
+	std::vector<int> shellSizes;
+	SkeletonGraph4D::Shells(dist, shellSizes);
+	printf("   Shells:");
+	const int maxPrinted = 12;
+	for (int k = 0; k < (int)shellSizes.size() && k < maxPrinted; k++) {
+		printf(" %d", shellSizes[k]);
+	}
+	printf("%s\n", (int)shellSizes.size() > maxPrinted ? " ..." : "");
+	if (skeletonDiameter < 0) {
+		double startTime = glfwGetTime();
+		if (curPolytope->GetSource() == psBuiltin) {
+			skeletonDiameter = eccentricity;
+			skeletonDiameterExact = true;
+		}
+		else {
+			skeletonDiameter = skeletonGraph.Diameter(skeletonSource, 16, skeletonDiameterExact);
+		}
+		printf("   Diameter %s%d (%.1f ms).\n", skeletonDiameterExact ? "" : "at least ",
+			skeletonDiameter, 1000.0 * (glfwGetTime() - startTime));
+	}
+}
+
+// **********************
+// Builds skeletonGraph for the current polytope, if it is not already.
+// **********************
+void BuildSkeletonGraph() {
+	if (skeletonGraphSerial != curPolytope->GetSerial()) {
+		double startTime = glfwGetTime();
+		skeletonGraph.Build(nVertices, ordering, nEdges);
+		skeletonGraphSerial = curPolytope->GetSerial();
+		skeletonDiameter = -1;
+		printf("Skeleton graph of %s: %d vertices, %d edges, degree up to %d (%.1f ms).\n", curPolytope->GetName(),
+			nVertices, nEdges, skeletonGraph.GetMaxDegree(), 1000.0 * (glfwGetTime() - startTime));
+	}
+}
+
+// **********************
+// Brings the skeleton values in skeletonVertTex and skeletonEdgeTex up to date with
+//    the current polytope, skeletonColoring and skeletonSource, building the polytope's
+//    skeleton graph first if needed.
+// Returns false if skeletonColoring is off.
+// **********************
+bool UpdateSkeletonAttribs() {
+	if (skeletonColoring == scNone) {
+		return false;
+	}
+	BuildSkeletonGraph();
+	if (skeletonSource < 0 || skeletonSource >= nVertices) {
+		skeletonSource = 0;
+	}
+	if (skeletonAttribSerial == skeletonGraphSerial && skeletonAttribColoring == skeletonColoring
+		&& (skeletonColoring != scDistance || skeletonAttribSource == skeletonSource)) {
+		return true;
+	}
+
+	std::vector<float> vertValues(nVertices, -1.0f);
+	std::vector<float> edgeValues(nEdges, -1.0f);
+	std::vector<int> values;
+	double startTime = glfwGetTime();
+	if (skeletonColoring == scDistance) {
+		int eccentricity = skeletonGraph.Distances(skeletonSource, values);
+		for (int v = 0; v < nVertices; v++) {
+			vertValues[v] = (float)values[v];
+		}
+		for (int e = 0; e < nEdges; e++) {
+			edgeValues[e] = (float)Min(values[ordering[2 * e]], values[ordering[2 * e + 1]]);
+		}
+		skeletonAttribScale = eccentricity > 0 ? 1.0f / eccentricity : 1.0f;
+		printf("Graph distances from vertex %d: up to %d (%.1f ms).\n", skeletonSource, eccentricity,
+			1000.0 * (glfwGetTime() - startTime));
+		PrintSkeletonShells(values, eccentricity);
+	}
+	else if (skeletonColoring == scVertexColors) {
+		int numColors = skeletonGraph.ColorVertices(values);
+		for (int v = 0; v < nVertices; v++) {
+			vertValues[v] = (float)values[v];
+		}
+		printf("Vertex coloring: %d colors (%.1f ms).\n", numColors, 1000.0 * (glfwGetTime() - startTime));
+	}
+	else {
+		int numColors = skeletonGraph.ColorEdges(values);
+		for (int e = 0; e < nEdges; e++) {
+			edgeValues[e] = (float)values[e];
+		}
+		printf("Edge coloring: %d colors (%.1f ms).\n", numColors, 1000.0 * (glfwGetTime() - startTime));
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, skeletonVertBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, nVertices * sizeof(float), vertValues.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, skeletonEdgeBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, nEdges * sizeof(float), edgeValues.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	GlStateCache::ActiveTexture(GL_TEXTURE3);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonVertTex);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, skeletonVertBuffer);
+	GlStateCache::ActiveTexture(GL_TEXTURE4);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, skeletonEdgeTex);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, skeletonEdgeBuffer);
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
+
+	skeletonAttribSerial = skeletonGraphSerial;
+	skeletonAttribColoring = skeletonColoring;
+	skeletonAttribSource = skeletonSource;
+	return true;
+}
+
+// **********************
+// Finds the automorphism group of the current polytope's skeleton (see Automorphism4D),
+//    and checks that its generators are rotations or reflections of the polytope in R^4.
+//    If they all are, the group is the polytope's symmetry group.
+// The search gives up after a number of refinements that shrinks as the polytope grows,
+//    so it stays within a second or so; the order found is then only a lower bound.
+// For the built-in polytopes, the order of the Coxeter group of their diagram is also
+//    printed: the symmetry group is at least that large.
+// **********************
+void PrintPolytopeSymmetry() {
+	SelectPolytope();
+	BuildSkeletonGraph();
+	double startTime = glfwGetTime();
+	SkeletonAutomorphisms automorphisms;
+	long long maxNodes = Max(1000LL, 200000000LL / Max(nVertices, 1));
+	double order = automorphisms.Find(skeletonGraph, maxNodes);
+	printf("Symmetry of %s: the skeleton has %s%.*g automorphisms (%d generators, %lld refinements, %.1f ms).\n",
+		curPolytope->GetName(), automorphisms.IsExact() ? "" : "at least ", order < 1.0e15 ? 15 : 4, order,
+		automorphisms.GetNumGenerators(), automorphisms.GetNumNodes(), 1000.0 * (glfwGetTime() - startTime));
+	const std::vector<int>& orbitSizes = automorphisms.GetOrbitSizes();
+	printf("   Orbits of the base vertices:");
+	const int maxPrinted = 12;
+	for (int k = 0; k < (int)orbitSizes.size() && k < maxPrinted; k++) {
+		printf("%s%d", k == 0 ? " " : " x ", orbitSizes[k]);
+	}
+	printf("%s\n", (int)orbitSizes.size() > maxPrinted ? " ..." : "");
+
+	std::vector<float> verts(4 * (size_t)nVertices);
+	curPolytope->CopyVerts(verts.data());
+	int numOrthogonal = 0;
+	double maxError = 0.0;
+	std::vector<int> perm;
+	for (int k = 0; k < automorphisms.GetNumGenerators(); k++) {
+		double error;
+		automorphisms.GetGenerator(k, perm);
+		numOrthogonal += ActsOrthogonally(verts.data(), nVertices, perm.data(), error);
+		maxError = Max(maxError, error);
+	}
+	if (numOrthogonal == automorphisms.GetNumGenerators()) {
+		printf("   Every generator is a rotation or reflection of the polytope (error %.1e).\n", maxError);
+	}
+	else {
+		printf("   %d of the %d generators are not rotations or reflections of the polytope:\n",
+			automorphisms.GetNumGenerators() - numOrthogonal, automorphisms.GetNumGenerators());
+		printf("   the skeleton is more symmetric than the polytope.\n");
+	}
+
+	int k = curPolytope->GetBuiltinIndex();
+	if (k >= 0) {
+		CoxeterGroup4D group;
+		std::vector<int> table;
+		const PolytopeInfo& info = polytopeTable[k];
+		if (group.Set(info.m01, info.m12, info.m23)) {
+			printf("   The Coxeter group [%d,%d,%d] of its diagram has order %d.\n", info.m01, info.m12, info.m23,
+				group.EnumerateCosets(0, table));
+		}
+	}
+}
+
+// **********************
+// The vertex of the current polytope nearest the viewer, as it is now rotated:
+//    the one farthest along the view direction, in 4D, that the view's z axis pulls back to.
+// **********************
+int NearestPolytopeVertex() {
+	SelectPolytope();
+	float rotation[16];
+	float polytopeEntries[16];
+	LinearMapR4 polytopeMat;
+	CalcPolytopeMatrix(polytopeMat);
+	polytopeMat.DumpByColumns(polytopeEntries);
+	composeRotation4D(thetas, rotation);
+	double toViewer[4];			// View z is toViewer . (x,y,z,w), plus a constant
+	for (int j = 0; j < 4; j++) {
+		toViewer[j] = 0.0;
+		for (int k = 0; k < 3; k++) {
+			toViewer[j] += polytopeEntries[2 + 4 * k] * rotation[k + 4 * j];
+		}
+	}
+	const float* x = curPolytope->GetX();
+	const float* y = curPolytope->GetY();
+	const float* z = curPolytope->GetZ();
+	const float* w = curPolytope->GetW();
+	int nearest = 0;
+	double nearestZ = -DBL_MAX;
+	for (int v = 0; v < nVertices; v++) {
+		double viewZ = toViewer[0] * x[v] + toViewer[1] * y[v] + toViewer[2] * z[v] + toViewer[3] * w[v];
+		if (viewZ > nearestZ) {
+			nearest = v;
+			nearestZ = viewZ;
+		}
+	}
+	return nearest;
+}
+
+// **********************
+// The polytope's modelview matrix (before its vertices are placed).
+// **********************
+void CalcPolytopeMatrix(LinearMapR4& polytopeMat) {
+	polytopeMat = viewMatrix;
+	polytopeMat.Mult_glTranslate(0, 4.0, 0);
+	polytopeMat.Mult_glScale(polytopeScale);
+}
+
+// **********************
+// Points curPolytope, nVertices, nEdges and ordering at the polytope for the current mode.
+// **********************
+void SelectPolytope() {
+	if (mode < 0 || mode >= polytopeRegistry.GetCount()) {
+		printf("Warning: invalid mode detected. Switching to simplex mode...\n");
+		mode = 0;
+	}
+	curPolytope = &polytopeRegistry.Get(mode);
+	nVertices = curPolytope->GetNumVerts();
+	nEdges = curPolytope->GetNumEdges();
+	ordering = curPolytope->GetEdgeIndices();
+}
+
+// **********************
+// Rotates the selected polytope into vertsX, vertsY, vertsZ, vertsW, and allocates instanceMats.
+// The frame arena is reset, with extraBytes more room for the caller.
+// Returns false if the arena could not be allocated.
+// **********************
+bool RotatePolytope(size_t extraBytes) {
+	// The arena only reallocates when a larger polytope is selected.
+	size_t coordBytes = FrameArena::Padded(nVertices * sizeof(float));
+	size_t instanceBytes = 16 * (nVertices + nEdges) * sizeof(float);
+	if (!frameArena.Reserve(4 * coordBytes + FrameArena::Padded(instanceBytes) + extraBytes)) {
+		return false;
+	}
+	frameArena.Reset();
+	vertsX = frameArena.Alloc<float>(nVertices);
+	vertsY = frameArena.Alloc<float>(nVertices);
+	vertsZ = frameArena.Alloc<float>(nVertices);
+	vertsW = frameArena.Alloc<float>(nVertices);
+	instanceMats = frameArena.Alloc<float>(16 * (nVertices + nEdges));
+
+	// Compose the six plane rotations once, then rotate all the vertices with it.
+	// For centrally symmetric polytopes only half of them are actually rotated.
+	float rotation[16];
+	composeRotation4D(thetas, rotation);
+	curPolytope->Rotate(rotation, (float)(vScale / sq2), vertsX, vertsY, vertsZ, vertsW);
+	return true;
+}
+
 void MyRemeshGeometries()
 {
 	// IT IS NOT NECESSARY TO REMESH EITHER THE FLOOR OR THE BACK WALL
 	texSphere.Remesh(meshRes, meshRes);
 	texCylinder.Remesh(meshRes, meshRes, meshRes);
+	RemeshLods();
+	if (shaderProgramIndirect != 0) {
+		sceneArena.SetMesh(arenaSphere, texSphere);			// Uploaded when next rendered
+		sceneArena.SetMesh(arenaCylinder, texCylinder);
+	}
 	check_for_opengl_errors();      // Watch the console window for error messages!
 }
 
@@ -414,42 +1568,38 @@ void MyRenderGeometries() {
 
 	selectShaderProgram(shaderProgramProc);
 
-	glUniform1i(glGetUniformLocation(shaderProgramProc, "mode"), mode); // updates mode in MyShaders to mode
+	GlStateCache::Uniform1i(procModeLoc, mode); // updates mode in MyShaders to mode
 	if (tSpinMode || abs(textureTime) < 0.0000001) {
-		glUniform1f(glGetUniformLocation(shaderProgramProc, "texTime"), (float)textureTime); // updates texTime in MyShaders to textureTime
+		GlStateCache::Uniform1f(procTexTimeLoc, (float)textureTime); // updates texTime in MyShaders to textureTime
 	}
 
+	// The walls and the floor all use the view matrix as their modelview matrix.
+	// It is dumped once, and loaded once into each of the two shader programs.
+	float viewEntries[16];
+	viewMatrix.DumpByColumns(viewEntries);
+
 	if (polytopeOnly){
-		// back wall
-		glBindVertexArray(myVAO[iWallB]);
 		materialUnderTexture.LoadIntoShaders();
-		viewMatrix.DumpByColumns(matEntries);
-		glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-		glBindTexture(GL_TEXTURE_2D, TextureNames[0]);
-		glUniform1i(applyTextureLocation, true);
+		GlStateCache::UniformMatrix4fv(modelviewMatLocation, viewEntries);
+		GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[0]);
+		GlStateCache::Uniform1i(applyTextureLocation, true);
+
+		// back wall
+		GlStateCache::BindVertexArray(myVAO[iWallB]);
 		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
 
 		// left wall
-		glBindVertexArray(myVAO[iWallL]);
-		materialUnderTexture.LoadIntoShaders();
-		viewMatrix.DumpByColumns(matEntries);
-		glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+		GlStateCache::BindVertexArray(myVAO[iWallL]);
 		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
 
 		// front wall
-		glBindVertexArray(myVAO[iWallF]);
-		materialUnderTexture.LoadIntoShaders();
-		viewMatrix.DumpByColumns(matEntries);
-		glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+		GlStateCache::BindVertexArray(myVAO[iWallF]);
 		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
 
 		// right wall
-		glBindVertexArray(myVAO[iWallR]);
-		materialUnderTexture.LoadIntoShaders();
-		viewMatrix.DumpByColumns(matEntries);
-		glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+		GlStateCache::BindVertexArray(myVAO[iWallR]);
 		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-		glUniform1i(applyTextureLocation, false);
+		GlStateCache::Uniform1i(applyTextureLocation, false);
 	}
 
 	// Render floor
@@ -457,137 +1607,301 @@ void MyRenderGeometries() {
 	selectShaderProgram(shaderProgramBitmap);
 
 	{
-		glBindVertexArray(myVAO[iFloor]);
+		GlStateCache::BindVertexArray(myVAO[iFloor]);
 		materialUnderTexture.LoadIntoShaders();
-		viewMatrix.DumpByColumns(matEntries);
-		glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-		glBindTexture(GL_TEXTURE_2D, TextureNames[1]);
-		glUniform1i(applyTextureLocation, true);
+		GlStateCache::UniformMatrix4fv(modelviewMatLocation, viewEntries);
+		GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[1]);
+		GlStateCache::Uniform1i(applyTextureLocation, true);
 		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-		glUniform1i(applyTextureLocation, false);
+		GlStateCache::Uniform1i(applyTextureLocation, false);
 		check_for_opengl_errors();
 	}
 
 	// Render the wireframe
 
 	{
-		LinearMapR4 polytopeMat = viewMatrix;
-		polytopeMat.Mult_glTranslate(0, 4.0, 0);
-		polytopeMat.Mult_glScale(polytopeScale);
+		LinearMapR4 polytopeMat;
+		CalcPolytopeMatrix(polytopeMat);
 
 		{
-			if (mode < 0 || mode > nPolytopes) {	
-				printf("Warning: invalid mode detected. Switching to simplex mode...\n");
-				mode = 0;
+			SelectPolytope();
+
+			if (renderPath == rpGpuRotate || morphMode) {		// The morph is only placed by the GPU
+				RenderPolytopeGpu(polytopeMat);
 			}
-			nVertices = vertNumList[mode];
-			nEdges = edgeNumList[mode];
-			unitVerts = vertList[mode];
-			ordering = orderingList[mode];
-
-			verts = (float*)malloc(4 * nVertices * sizeof(float));
-			vertsMats = (LinearMapR4*)malloc(4 * nVertices * sizeof(LinearMapR4));
-			edgesMats = (LinearMapR4*)malloc(4 * nEdges * sizeof(LinearMapR4));
-			if (verts == NULL) {
-				fprintf(stderr, "Error: cannot allocate %d bytes for vertex array.\n", 4 * nVertices * sizeof(float));
-				if (vertsMats == NULL) {
-					fprintf(stderr, "Error: cannot allocate %d bytes for vertex matrices array.\n", 4 * nVertices * sizeof(LinearMapR4));
+			else {
+				if (!RotatePolytope(0)) {
+					return;
 				}
-				if (edgesMats == NULL) {
-					fprintf(stderr, "Error: cannot allocate %d bytes for edge matrices array.\n", 4 * nEdges * sizeof(LinearMapR4));
+
+				if (renderPath == rpImpostor) {
+					RenderPolytopeImpostors(polytopeMat);
 				}
-				return;
-			}
+				else if (renderPath == rpWireframe) {
+					RenderPolytopeWireframe(polytopeMat);
+				}
+				else if (renderPath == rpInstanced) {
+					// Build all the model matrices first, then draw all the spheres with one
+					//    draw call and all the cylinders with another.
+					// The shader multiplies each instance matrix by modelviewMatrix.
+					int nCylinders = vertsOnly ? 0 : nEdges;
+					float* sphereMats;
+					float* cylinderMats;
+					size_t sphereOffset = 0;
+					size_t cylinderOffset = 0;
+					if (useInstanceRing) {
+						// Write the matrices straight into the mapped ring buffer. Both VAO's read
+						//    the ring from its start, and baseInstance selects this frame's matrices.
+						const size_t matBytes = 16 * sizeof(float);
+						if (instanceRing.Reserve((nVertices + nEdges + 1) * matBytes)) {
+							AttachLodInstanceMatrices(instanceRing.GetBuffer(), instanceRing.GetBuffer());
+						}
+						instanceRing.BeginFrame();
+						sphereMats = (float*)instanceRing.Alloc(nVertices * matBytes, matBytes, &sphereOffset);
+						cylinderMats = (float*)instanceRing.Alloc(nCylinders * matBytes, matBytes, &cylinderOffset);
+						if (sphereMats == NULL || cylinderMats == NULL) {
+							fprintf(stderr, "Warning: streaming buffer unavailable. Using glBufferData for instance matrices.\n");
+							useInstanceRing = false;
+							AttachLodInstanceMatrices(sphereInstanceVBO, cylinderInstanceVBO);
+						}
+					}
+					if (!useInstanceRing) {
+						sphereMats = instanceMats;
+						cylinderMats = instanceMats + 16 * nVertices;
+					}
 
-			for (int i = 0; i < 4 * nVertices; i++) {
-				verts[i] = unitVerts[i];
-				verts[i] *= (float)(vScale / sq2);
-			}
-			
-			for (int i = 0; i < nVertices; i++) {
-				float c1 = (float)cos(PI2*thetas[0]);	float s1 = (float)sin(PI2*thetas[0]);
-				float c2 = (float)cos(PI2*thetas[1]);	float s2 = (float)sin(PI2*thetas[1]);
-				float c3 = (float)cos(PI2*thetas[2]);	float s3 = (float)sin(PI2*thetas[2]);
-				float c4 = (float)cos(PI2*thetas[3]);	float s4 = (float)sin(PI2*thetas[3]);
-				float c5 = (float)cos(PI2*thetas[4]);	float s5 = (float)sin(PI2*thetas[4]);
-				float c6 = (float)cos(PI2*thetas[5]);	float s6 = (float)sin(PI2*thetas[5]);
-				verts[4 * i + 0] = (float)(vScale / sq2) * (
-					unitVerts[4 * i + 0] * (c1*c2*c3) +
-					unitVerts[4 * i + 1] * (c1*c2*s3*s5 - c5 * (c4*s1 - c1 * s2*s4)) +
-					unitVerts[4 * i + 2] * (c6*(s1*s4 + c1 * c4*s2) - s6 * (s5*(c4*s1 - c1 * s2*s4) + c1 * c2*c5*s3)) +
-					unitVerts[4 * i + 3] * (-s6 * (s1*s4 + c1 * c4*s2) - c6 * (s5*(c4*s1 - c1 * s2*s4) + c1 * c2*c5*s3))
-					);
-				verts[4 * i + 1] = (float)(vScale / sq2) * (
-					unitVerts[4 * i + 0] * (c2*c3*s1) +
-					unitVerts[4 * i + 1] * (c5*(c1*c4 + s1 * s2*s4) + c2 * s1*s3*s5) +
-					unitVerts[4 * i + 2] * (s6*(s5*(c1*c4 + s1 * s2*s4) - c2 * c5*s1*s3) - c6 * (c1*s4 - c4 * s1*s2)) +
-					unitVerts[4 * i + 3] * (s6*(c1*s4 - c4 * s1*s2) + c6 * (s5*(c1*c4 + s1 * s2*s4) - c2 * c5*s1*s3))
-					);
-				verts[4 * i + 2] = (float)(vScale / sq2) * (
-					unitVerts[4 * i + 0] * (-c3 * s2) +
-					unitVerts[4 * i + 1] * (c2*c5*s4 - s2 * s3*s5) +
-					unitVerts[4 * i + 2] * (s6*(c5*s2*s3 + c2 * s4*s5) + c2 * c4*c6) +
-					unitVerts[4 * i + 3] * (c6*(c5*s2*s3 + c2 * s4*s5) - c2 * c4*s6)
-					);
-				// this calculation is optional since we cannot render the fourth dimensional coordinate
-				verts[4 * i + 3] = (float)(vScale / sq2) * (
-					unitVerts[4 * i + 0] * (s3)+
-					unitVerts[4 * i + 1] * (-c3 * s5) +
-					unitVerts[4 * i + 2] * (c3*c5*s6) +
-					unitVerts[4 * i + 3] * (c3*c5*c6)
-					);
-			}
+					// Group the instances by level of detail, dropping edges shorter than a pixel.
+					int sphereStart[NumLods + 1];
+					int cylinderStart[NumLods + 1];
+					BucketInstancesByLod(polytopeMat, nCylinders, sphereMats, cylinderMats, sphereStart, cylinderStart);
+					nCylinders = cylinderStart[NumLods];
 
-			// initializing the matrices for the vertices (spheres) and edges (cylinders)
-			for (int i = 0; i < nVertices; i++) {
-				vertsMats[i] = polytopeMat;
-			}
-			for (int i = 0; i < nEdges; i++) {
-				edgesMats[i] = polytopeMat;
-			}
+					selectShaderProgram(shaderProgramInstanced);
+					materialUnderTexture.LoadIntoShaders();
+					polytopeMat.DumpByColumns(matEntries);
+					GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
+					GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[2]);
+					GlStateCache::Uniform1i(applyTextureLocation, true);
 
-			for (int i = 0; i < nVertices; i++) {
-				vertsMats[i].Mult_glTranslate(verts[4 * i], verts[4 * i + 1], verts[4 * i + 2]);
-				vertsMats[i].Mult_glScale(shapeRadius);
-				vertsMats[i].DumpByColumns(matEntries);
-				glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-				glBindTexture(GL_TEXTURE_2D, TextureNames[2]);
-				glUniform1i(applyTextureLocation, true);
-				texSphere.Render();
-				glUniform1i(applyTextureLocation, false);
-				vertsMats[i].Mult_glScale(1 / shapeRadius);
-			}
+					const size_t matBytes = 16 * sizeof(float);
+					if (useInstanceRing) {
+						int sphereBase = (int)(sphereOffset / matBytes);
+						int cylinderBase = (int)(cylinderOffset / matBytes);
+						for (int k = 0; k < NumLods; k++) {
+							int numSpheres = sphereStart[k + 1] - sphereStart[k];
+							int numCylinders = cylinderStart[k + 1] - cylinderStart[k];
+							if (numSpheres > 0) {
+								SphereLod(k).RenderInstanced(numSpheres, sphereBase + sphereStart[k]);
+							}
+							if (numCylinders > 0) {
+								CylinderLod(k).RenderInstanced(numCylinders, cylinderBase + cylinderStart[k]);
+							}
+						}
+						instanceRing.EndFrame();
+					}
+					else {
+						// Without base instances, each level's instance attributes are pointed at its group.
+						glBindBuffer(GL_ARRAY_BUFFER, sphereInstanceVBO);
+						glBufferData(GL_ARRAY_BUFFER, nVertices * matBytes, sphereMats, GL_STREAM_DRAW);
+						if (nCylinders > 0) {
+							glBindBuffer(GL_ARRAY_BUFFER, cylinderInstanceVBO);
+							glBufferData(GL_ARRAY_BUFFER, nCylinders * matBytes, cylinderMats, GL_STREAM_DRAW);
+						}
+						for (int k = 0; k < NumLods; k++) {
+							int numSpheres = sphereStart[k + 1] - sphereStart[k];
+							int numCylinders = cylinderStart[k + 1] - cylinderStart[k];
+							if (numSpheres > 0) {
+								AttachInstanceMatrices(SphereLod(k).GetVAO(), sphereInstanceVBO, sphereStart[k] * matBytes);
+								SphereLod(k).RenderInstanced(numSpheres);
+							}
+							if (numCylinders > 0) {
+								AttachInstanceMatrices(CylinderLod(k).GetVAO(), cylinderInstanceVBO, cylinderStart[k] * matBytes);
+								CylinderLod(k).RenderInstanced(numCylinders);
+							}
+						}
+					}
+
+					GlStateCache::Uniform1i(applyTextureLocation, false);
+					selectShaderProgram(shaderProgramBitmap);
+				}
+				else {
+					// Every sphere and cylinder uses the same texture: bind it once for all of them.
+					LinearMapR4 objMat;
+					GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[2]);
+					GlStateCache::Uniform1i(applyTextureLocation, true);
+					for (int i = 0; i < nVertices; i++) {
+						CalcVertexMatrix(polytopeMat, RotatedVert(i), objMat);
+						objMat.DumpByColumns(matEntries);
+						GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
+						texSphere.Render();
+					}
 
-			if (!vertsOnly) {
-				int i, j;
-				for (idx = 0; idx < nEdges; idx++) {
-					i = ordering[2 * idx];
-					j = ordering[2 * idx + 1];
-					x_1 = verts[4 * i]; y_1 = verts[4 * i + 1]; z_1 = verts[4 * i + 2];
-					x_2 = verts[4 * j]; y_2 = verts[4 * j + 1]; z_2 = verts[4 * j + 2];
-					normD = sqrt(pow(x_2 - x_1, 2) + pow(y_2 - y_1, 2) + pow(z_2 - z_1, 2));
-					edgesMats[idx] = vertsMats[i];
-					edgesMats[idx].Mult_glTranslate(0.5*(x_2 - x_1), 0.5*(y_2 - y_1), 0.5*(z_2 - z_1));
-					if (pow(z_2 - z_1, 2) + pow(x_2 - x_1, 2) > 0) {
-						edgesMats[idx].Mult_glRotate(atan2(sqrt(pow(x_2 - x_1, 2) + pow(z_2 - z_1, 2)), y_2 - y_1), z_2 - z_1, 0, x_1 - x_2);
+					if (!vertsOnly) {
+						for (idx = 0; idx < nEdges; idx++) {
+							CalcEdgeMatrix(polytopeMat, RotatedVert(ordering[2 * idx]), RotatedVert(ordering[2 * idx + 1]), objMat);
+							objMat.DumpByColumns(matEntries);
+							GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
+							texCylinder.Render();
+						}
 					}
-					edgesMats[idx].Mult_glScale(0.8, 0.5 * normD, 0.8);
-					edgesMats[idx].Mult_glScale(shapeRadius, 1, shapeRadius);
-					edgesMats[idx].DumpByColumns(matEntries);
-					glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-					glBindTexture(GL_TEXTURE_2D, TextureNames[2]);
-					glUniform1i(applyTextureLocation, true);
-					texCylinder.Render();
-					glUniform1i(applyTextureLocation, false);
+					GlStateCache::Uniform1i(applyTextureLocation, false);
 				}
-			}
 
-			free(verts);
-			free(vertsMats);
-			free(edgesMats);
+			}
 		}
 		/**/
 	}
 
 	check_for_opengl_errors();      // Watch the console window for error messages!
 }
+
+// **********************
+// Fills in the draw record for an object of the multi-draw-indirect path.
+// **********************
+void FillDrawRecord(DrawRecord& rec, const LinearMapR4& modelviewMat, const phMaterial& mat,
+	int textureKind, int textureNum) {
+	modelviewMat.DumpByColumns(rec.modelviewMatrix);
+	mat.EmissiveColor.Dump(rec.emissiveColor);
+	mat.AmbientColor.Dump(rec.ambientColor);
+	mat.DiffuseColor.Dump(rec.diffuseColor);
+	mat.SpecularColor.Dump(rec.specularColor);
+	rec.emissiveColor[3] = rec.ambientColor[3] = rec.diffuseColor[3] = 0.0f;
+	rec.specularColor[3] = mat.SpecularExponent;
+	rec.flags[0] = textureKind;
+	rec.flags[1] = textureNum;
+	rec.flags[2] = mat.UseFresnel ? 1 : 0;
+	rec.flags[3] = 0;
+}
+
+// **********************
+// Renders the whole scene (walls, floor, light spheres and polytope) with
+//    one glMultiDrawElementsIndirect. There is one draw command per mesh,
+//    so the number of commands does not depend on the number of objects.
+// The polytope is rotated and placed by the vertex shader, as in RenderPolytopeGpu(),
+//    so the CPU work per frame is the same for every polytope.
+// Returns false, and switches to the instanced render path, if OpenGL 4.3 is not available.
+// **********************
+bool MyRenderSceneIndirect() {
+	if (shaderProgramIndirect == 0) {
+		fprintf(stderr, "Warning: multi-draw-indirect needs OpenGL 4.3. Using the instanced render path.\n");
+		renderPath = rpInstanced;
+		return false;
+	}
+
+	SelectPolytope();
+	if (gpuPolytopeMorph || gpuPolytopeSerial != curPolytope->GetSerial()) {
+		UploadPolytopeToGpu();			// The indirect path is not used for morphs
+	}
+	DrawRecord records[MaxDrawRecords];
+	GlDrawElementsIndirectCommand cmds[MaxDrawCommands];
+	int numCmds = 0;
+	int numRecords = 0;
+
+	// Walls and floor
+	if (polytopeOnly) {
+		FillDrawRecord(records[numRecords], viewMatrix, materialUnderTexture, 2, 0);
+		sceneArena.GetDrawCommand(arenaWalls, 1, numRecords++, &cmds[numCmds++]);
+	}
+	FillDrawRecord(records[numRecords], viewMatrix, materialUnderTexture, 1, 1);
+	sceneArena.GetDrawCommand(arenaFloor, 1, numRecords++, &cmds[numCmds++]);
+
+	// Light spheres
+	int firstRecord = numRecords;
+	for (int i = 0; i < numLightSpheres; i++) {
+		LinearMapR4 lightMat;
+		phMaterial emissiveMaterial;
+		if (MyGetLightSphere(i, lightMat, emissiveMaterial)) {
+			FillDrawRecord(records[numRecords++], lightMat, emissiveMaterial, 0, 0);
+		}
+	}
+	if (numRecords > firstRecord) {
+		sceneArena.GetDrawCommand(arenaLightSphere, numRecords - firstRecord, firstRecord, &cmds[numCmds++]);
+	}
+
+	// The polytope's spheres and cylinders: one record for all the spheres, and one for all the cylinders
+	LinearMapR4 polytopeMat;
+	CalcPolytopeMatrix(polytopeMat);
+	int numInstances = nVertices;
+	FillDrawRecord(records[numRecords], polytopeMat, materialUnderTexture, 1, 2);
+	records[numRecords].flags[3] = 1;
+	sceneArena.GetDrawCommand(arenaSphere, nVertices, numRecords++, &cmds[numCmds++]);
+	if (!vertsOnly && nEdges > 0) {
+		FillDrawRecord(records[numRecords], polytopeMat, materialUnderTexture, 1, 2);
+		records[numRecords].flags[3] = 2;
+		sceneArena.GetDrawCommand(arenaCylinder, nEdges, numRecords++, &cmds[numCmds++]);
+		numInstances = Max(numInstances, nEdges);
+	}
+
+	// Load the records and commands. The record numbers 0,1,2,... only grow: an instance
+	//    of the polytope reads the number its draw's baseInstance plus its instance number.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawRecordSSBO);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, numRecords * sizeof(DrawRecord), records);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawRecordSSBO);
+	int numRecordNums = numRecords + numInstances;
+	if (numRecordNums > drawRecordNumCapacity) {
+		drawRecordNumCapacity = 2 * numRecordNums;
+		std::vector<int> recordNums(drawRecordNumCapacity);
+		for (int i = 0; i < drawRecordNumCapacity; i++) {
+			recordNums[i] = i;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, drawRecordNumVBO);
+		glBufferData(GL_ARRAY_BUFFER, drawRecordNumCapacity * sizeof(int), recordNums.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, numCmds * sizeof(GlDrawElementsIndirectCommand), cmds);
+
+	float matEntries[16];
+	GlStateCache::UseProgram(shaderProgramIndirect);
+	GlStateCache::Uniform1i(indirectModeLoc, mode);
+	if (tSpinMode || abs(textureTime) < 0.0000001) {
+		GlStateCache::Uniform1f(indirectTexTimeLoc, (float)textureTime);
+	}
+	composeRotation4D(thetas, matEntries);
+	GlStateCache::UniformMatrix4fv(indirectRotationLoc, matEntries);
+	GlStateCache::Uniform1f(indirectVertScaleLoc, (float)(vScale / sq2));
+	GlStateCache::Uniform1f(indirectShapeRadiusLoc, (float)shapeRadius);
+	GlStateCache::ActiveTexture(GL_TEXTURE1);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeVertTex);
+	GlStateCache::ActiveTexture(GL_TEXTURE2);
+	GlStateCache::BindTexture(GL_TEXTURE_BUFFER, polytopeEdgeTex);
+	for (int i = 0; i < NumTextures; i++) {
+		GlStateCache::ActiveTexture(GL_TEXTURE3 + i);
+		GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[i]);
+	}
+	GlStateCache::ActiveTexture(GL_TEXTURE0);
+	GlStateCache::BindTexture(GL_TEXTURE_2D, TextureNames[0]);
+
+	sceneArena.Upload();			// Only does work after a remesh
+	GlStateCache::BindVertexArray(sceneArena.GetVAO());
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, numCmds, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	check_for_opengl_errors();
+	return true;
+}
+
+// Prints statistics gathered while rendering. Called once when the program exits.
+void MyPrintRenderStats() {
+	printf("Frame arena: high-water mark %zu bytes, capacity %zu bytes, reallocated %d times.\n",
+		frameArena.GetHighWaterMark(), frameArena.GetCapacity(), frameArena.GetNumGrows());
+	if (useInstanceRing) {
+		printf("Instance ring buffer: %d x %zu bytes, waited on a fence %d times.\n",
+			GlStreamRing::NumSections, instanceRing.GetSectionSize(), instanceRing.GetNumWaits());
+	}
+	long long numSpheres = 0, numCylinders = 0;
+	for (int k = 0; k < NumLods; k++) {
+		numSpheres += lodInstanceCounts[0][k];
+		numCylinders += lodInstanceCounts[1][k];
+	}
+	if (numSpheres > 0) {
+		printf("Level of detail (finest to coarsest):");
+		for (int k = 0; k < NumLods; k++) {
+			printf(" %.1f%%/%.1f%%", 100.0 * lodInstanceCounts[0][k] / numSpheres,
+				numCylinders > 0 ? 100.0 * lodInstanceCounts[1][k] / numCylinders : 0.0);
+		}
+		printf(" of spheres/cylinders; %lld sub-pixel edges culled.\n", lodNumCulled);
+	}
+	GlStateCache::PrintStats();
+}
@@ -10,19 +10,64 @@
 //
 //
 
+#include <stddef.h>
+
 extern double shapeRadius;
 extern double shapeMin;
 extern double shapeMax;
 extern double shapeScale;
 
+class LinearMapR4;      // Used in the function prototypes, declared in LinearMapR4.h
+class VectorR3;         // Used in the function prototypes, declared in LinearMapR3.h
+class GlGeomSphere;     // Used in the function prototypes, declared in GlGeomSphere.h
+class GlGeomCylinder;   // Used in the function prototypes, declared in GlGeomCylinder.h
+
 //
 // Function Prototypes
 //
 void MySetupSurfaces();                // Called once, before rendering begins.
+void RegisterPolytopes();              // Adds the built-in polytopes and stress scenes to the registry
+void InvalidateStressScenes();         // Rebuilds the stress scenes when next shown, at the new stressSceneSize
+int LoadPolytope(const char* filename, bool hull, bool validate);     // Adds a polytope file to the registry, returns its number or -1
+bool SavePolytope(int k, const char* filename);       // Writes polytope k as a binary polytope file
+int GetNumPolytopes();
+const char* GetPolytopeName(int k);
+bool PolytopeHasMorph(int k);
 void SetupForTextures();               // Loads textures, sets Phong material
 void MyRemeshGeometries();             // Called when mesh changes, must update resolutions.
 
 void MyRenderGeometries();            // Called to render the two surfaces
+bool MyRenderSceneIndirect();         // Renders everything with one multi-draw-indirect call (rpIndirect)
+void MyPrintRenderStats();            // Called when the program exits
+
+void AttachInstanceMatrices(unsigned int vao, unsigned int instanceVBO, size_t byteOffset = 0);  // Per-instance mat4 at instanceMatrix_loc
+void CalcVertexMatrix(const LinearMapR4& base, const VectorR3& v, LinearMapR4& mat);
+void CalcEdgeMatrix(const LinearMapR4& base, const VectorR3& v1, const VectorR3& v2, LinearMapR4& mat);
+void CalcPolytopeMatrix(LinearMapR4& polytopeMat);
+void StripQuadToTriangles(const unsigned int* strip, unsigned int firstVert, unsigned int* tris);
+
+GlGeomSphere& SphereLod(int k);                                 // The meshes of level of detail k (0 is the finest)
+GlGeomCylinder& CylinderLod(int k);
+void RemeshLods();                                              // Remeshes the coarser levels of detail from meshRes
+void AttachLodInstanceMatrices(unsigned int sphereVBO, unsigned int cylinderVBO);   // For every level of detail
+int PickLod(float radiusPx, int previous);                      // Level of detail for a screen radius, with hysteresis
+void BucketInstancesByLod(const LinearMapR4& polytopeMat, int nCylinders,
+                          float* sphereMats, float* cylinderMats, int* sphereStart, int* cylinderStart);
+
+void SelectPolytope();                                          // Points the globals at the polytope for the current mode
+bool RotatePolytope(size_t extraBytes);                         // Rotates it, allocating from the frame arena
+
+void LoadGpuPolytopeBuffers(const float* texels, int numTexels, const int* edges, int numEdges);
+void UploadPolytopeToGpu();                                     // Loads the current polytope into GPU buffers
+void UploadMorphToGpu();                                        // Loads the morph of the current mode into GPU buffers
+double MorphStartPosition(int k);                               // Where polytope k is on its morph's path (0 to 3)
+void RenderPolytopeGpu(const LinearMapR4& polytopeMat);         // Renders with the 4D rotation done in the vertex shader
+void RenderPolytopeImpostors(const LinearMapR4& polytopeMat);   // Renders the rotated polytope as ray-cast impostors
+void RenderPolytopeWireframe(const LinearMapR4& polytopeMat);   // Renders the rotated polytope as lines and points
+void BuildSkeletonGraph();                                      // The skeleton graph of the current polytope, built once
+bool UpdateSkeletonAttribs();                                   // Loads the skeletonColoring values into GPU buffers, if on
+int NearestPolytopeVertex();                                    // The vertex of the rotated polytope nearest the viewer
+void PrintPolytopeSymmetry();                                   // Finds and checks the symmetry group of the current polytope
 
 
 
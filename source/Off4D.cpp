@@ -0,0 +1,365 @@
+//
+//  Off4D.cpp
+//
+//   A streaming reader for 4OFF polytope files. See Off4D.h.
+//
+
+#include "Off4D.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+
+namespace {
+
+// **********************
+// The file, read in chunks. Every token is parsed straight from the buffer: the
+//    buffer is refilled whenever fewer than MaxToken bytes are left, so a token
+//    never runs past its end.
+// **********************
+class OffStream
+{
+public:
+	OffStream() : file(0), pos(0), end(0), atEof(false), line(1) {}
+	~OffStream() { if (file != 0) fclose(file); }
+
+	bool Open(const char* filename);
+
+	bool SkipSpace();					// Skips whitespace, newlines and comments. False at the end of the file.
+	bool AtLineEnd();					// Skips spaces and comments on this line. True at a newline or the end.
+	void SkipLine();					// Skips to the start of the next line
+	bool ReadWord(char* word, int maxLen);
+	bool ReadInt(int& value);			// False if it is not a number, or does not fit in an int
+	bool ReadFloat(float& value);
+
+	int GetLine() const { return line; }
+
+private:
+	static const int ChunkSize = 1 << 20;
+	static const int MaxToken = 256;
+
+	void Refill()
+	{
+		if (end - pos < MaxToken && !atEof) {
+			size_t left = end - pos;
+			memmove(buffer.data(), pos, left);
+			size_t numRead = fread(buffer.data() + left, 1, ChunkSize, file);
+			atEof = (numRead < (size_t)ChunkSize);
+			pos = buffer.data();
+			end = pos + left + numRead;
+			*end = 0;		// A sentinel, so the parsers always stop at the end
+		}
+	}
+
+	FILE* file;
+	std::vector<char> buffer;
+	char* pos;
+	char* end;
+	bool atEof;
+	int line;
+};
+
+bool OffStream::Open(const char* filename)
+{
+	file = fopen(filename, "rb");
+	if (file == 0) {
+		return false;
+	}
+	buffer.resize(ChunkSize + MaxToken + 1);
+	pos = end = buffer.data();
+	Refill();
+	return true;
+}
+
+bool OffStream::SkipSpace()
+{
+	for (;;) {
+		Refill();
+		if (pos == end) {
+			return false;
+		}
+		char c = *pos;
+		if (c == '\n') {
+			line++;
+			pos++;
+		}
+		else if (c == ' ' || c == '\t' || c == '\r') {
+			pos++;
+		}
+		else if (c == '#') {
+			SkipLine();
+		}
+		else {
+			return true;
+		}
+	}
+}
+
+bool OffStream::AtLineEnd()
+{
+	for (;;) {
+		Refill();
+		if (pos == end || *pos == '\n') {
+			return true;
+		}
+		if (*pos == '#') {
+			while (pos != end && *pos != '\n') {
+				pos++;
+				Refill();
+			}
+			return true;
+		}
+		if (*pos != ' ' && *pos != '\t' && *pos != '\r') {
+			return false;
+		}
+		pos++;
+	}
+}
+
+void OffStream::SkipLine()
+{
+	for (;;) {
+		char* newline = (char*)memchr(pos, '\n', end - pos);
+		if (newline != 0) {
+			pos = newline + 1;
+			line++;
+			return;
+		}
+		pos = end;
+		Refill();
+		if (pos == end) {
+			return;
+		}
+	}
+}
+
+bool OffStream::ReadWord(char* word, int maxLen)
+{
+	if (!SkipSpace()) {
+		return false;
+	}
+	int n = 0;
+	while (pos != end && *pos > ' ' && n < maxLen - 1) {
+		word[n++] = *pos++;
+	}
+	word[n] = 0;
+	return true;
+}
+
+bool OffStream::ReadInt(int& value)
+{
+	if (!SkipSpace()) {
+		return false;
+	}
+	const char* p = pos;
+	bool negative = (*p == '-');
+	if (*p == '-' || *p == '+') {
+		p++;
+	}
+	if (*p < '0' || *p > '9') {
+		return false;
+	}
+	long long v = 0;
+	for (; *p >= '0' && *p <= '9'; p++) {
+		v = 10 * v + (*p - '0');
+		if (v > 0x7fffffffLL) {
+			return false;
+		}
+	}
+	value = (int)(negative ? -v : v);
+	pos = (char*)p;
+	return true;
+}
+
+// Decimal numbers, as [sign] digits [. digits] [e [sign] digits]. The first 19 significant
+//    digits are kept exactly, which is more than enough for a float.
+bool OffStream::ReadFloat(float& value)
+{
+	static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	if (!SkipSpace()) {
+		return false;
+	}
+	const char* p = pos;
+	bool negative = (*p == '-');
+	if (*p == '-' || *p == '+') {
+		p++;
+	}
+	uint64_t mantissa = 0;
+	int numDigits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	for (; *p >= '0' && *p <= '9'; p++) {
+		anyDigits = true;
+		if (numDigits < 19) {
+			mantissa = 10 * mantissa + (*p - '0');
+			numDigits += (mantissa != 0);
+		}
+		else {
+			exponent++;
+		}
+	}
+	if (*p == '.') {
+		for (p++; *p >= '0' && *p <= '9'; p++) {
+			anyDigits = true;
+			if (numDigits < 19) {
+				mantissa = 10 * mantissa + (*p - '0');
+				numDigits += (mantissa != 0);
+				exponent--;
+			}
+		}
+	}
+	if (!anyDigits) {
+		return false;
+	}
+	if (*p == 'e' || *p == 'E') {
+		const char* q = p + 1;
+		bool negativeExp = (*q == '-');
+		if (*q == '-' || *q == '+') {
+			q++;
+		}
+		if (*q >= '0' && *q <= '9') {
+			int e = 0;
+			while (*q >= '0' && *q <= '9') {
+				e = (e < 10000) ? 10 * e + (*q - '0') : e;
+				q++;
+			}
+			exponent += negativeExp ? -e : e;
+			p = q;
+		}
+	}
+	double v = (double)mantissa;
+	if (exponent < 0) {
+		v = (exponent >= -22) ? v / powersOf10[-exponent] : v * pow(10.0, exponent);
+	}
+	else if (exponent > 0) {
+		v = (exponent <= 22) ? v * powersOf10[exponent] : v * pow(10.0, exponent);
+	}
+	value = (float)(negative ? -v : v);
+	pos = (char*)p;
+	return true;
+}
+
+}	// namespace
+
+bool Off4DFile::Read(const char* filename)
+{
+	verts.clear();
+	edges.clear();
+	faceStart.assign(1, 0);
+	faceVerts.clear();
+	cellStart.assign(1, 0);
+	cellVerts.clear();
+
+	OffStream in;
+	if (!in.Open(filename)) {
+		fprintf(stderr, "Unable to open file '%s' for reading.\n", filename);
+		return false;
+	}
+	char word[16];
+	if (!in.ReadWord(word, sizeof(word)) || strcmp(word, "4OFF") != 0) {
+		fprintf(stderr, "File '%s' is not a 4OFF file.\n", filename);
+		return false;
+	}
+
+	// The counts: vertices, 2-faces, edges, cells; or vertices, 2-faces, cells.
+	int counts[4];
+	int numCounts = 0;
+	in.SkipSpace();
+	while (numCounts < 4 && !in.AtLineEnd() && in.ReadInt(counts[numCounts])) {
+		numCounts++;
+	}
+	if (numCounts < 3 || !in.AtLineEnd()) {
+		fprintf(stderr, "File '%s', line %d: expected the numbers of vertices, faces and cells.\n",
+			filename, in.GetLine());
+		return false;
+	}
+	int numVerts = counts[0];
+	int numFaces = counts[1];
+	int numEdges = (numCounts == 4) ? counts[2] : 0;
+	int numCells = (numCounts == 4) ? counts[3] : counts[2];
+	if (numVerts < 0 || numFaces < 0 || numEdges < 0 || numCells < 0) {
+		fprintf(stderr, "File '%s', line %d: negative count.\n", filename, in.GetLine());
+		return false;
+	}
+
+	// The counts are only trusted as far as the data bears them out: the arrays grow
+	//    as it is read, so a bad header ends in a bad line, not a huge allocation.
+	for (int i = 0; i < numVerts; i++) {
+		float v[4];
+		if (!in.ReadFloat(v[0]) || !in.ReadFloat(v[1]) || !in.ReadFloat(v[2]) || !in.ReadFloat(v[3])) {
+			fprintf(stderr, "File '%s', line %d: bad vertex.\n", filename, in.GetLine());
+			return false;
+		}
+		verts.insert(verts.end(), v, v + 4);
+		in.SkipLine();
+	}
+
+	// The 2-faces, collecting their sides as the edges. The edges with smaller vertex v
+	//    are a linked list from firstEdgeAt[v]; it is short, and when the faces are
+	//    numbered along with their vertices, as usual, it stays in the cache.
+	std::vector<int> firstEdgeAt(numVerts, -1);
+	std::vector<int> nextEdge;
+	for (int f = 0; f < numFaces; f++) {
+		int size;
+		if (!in.ReadInt(size) || size < 3) {
+			fprintf(stderr, "File '%s', line %d: bad face.\n", filename, in.GetLine());
+			return false;
+		}
+		int first = (int)faceVerts.size();
+		for (int k = 0; k < size; k++) {
+			int v;
+			if (!in.ReadInt(v) || v < 0 || v >= numVerts) {
+				fprintf(stderr, "File '%s', line %d: bad vertex number in a face.\n", filename, in.GetLine());
+				return false;
+			}
+			faceVerts.push_back(v);
+		}
+		for (int k = 0; k < size; k++) {
+			int a = faceVerts[first + k];
+			int b = faceVerts[first + (k + 1) % size];
+			int lo = std::min(a, b);
+			int hi = std::max(a, b);
+			int e = firstEdgeAt[lo];
+			while (e >= 0 && edges[2 * e + 1] != hi) {
+				e = nextEdge[e];
+			}
+			if (e < 0) {
+				nextEdge.push_back(firstEdgeAt[lo]);
+				firstEdgeAt[lo] = GetNumEdges();
+				edges.push_back(lo);
+				edges.push_back(hi);
+			}
+		}
+		faceStart.push_back((int)faceVerts.size());
+		in.SkipLine();		// Skips a color, if any
+	}
+
+	// The cells, as the vertices of their 2-faces.
+	for (int c = 0; c < numCells; c++) {
+		int size;
+		if (!in.ReadInt(size) || size < 4) {
+			fprintf(stderr, "File '%s', line %d: bad cell.\n", filename, in.GetLine());
+			return false;
+		}
+		size_t first = cellVerts.size();
+		for (int k = 0; k < size; k++) {
+			int f;
+			if (!in.ReadInt(f) || f < 0 || f >= numFaces) {
+				fprintf(stderr, "File '%s', line %d: bad face number in a cell.\n", filename, in.GetLine());
+				return false;
+			}
+			cellVerts.insert(cellVerts.end(), faceVerts.begin() + faceStart[f], faceVerts.begin() + faceStart[f + 1]);
+		}
+		std::sort(cellVerts.begin() + first, cellVerts.end());
+		cellVerts.erase(std::unique(cellVerts.begin() + first, cellVerts.end()), cellVerts.end());
+		cellStart.push_back((int)cellVerts.size());
+		in.SkipLine();
+	}
+
+	if (numEdges > 0 && GetNumEdges() != numEdges) {
+		fprintf(stderr, "File '%s': has %d edges, but says %d.\n", filename, GetNumEdges(), numEdges);
+	}
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+//
+// Off4D.h   ---  Header file for Off4D.cpp.
+//
+//   Reads polytopes from 4OFF text files, as written by Stella4D and others:
+//      4OFF
+//      # comments run from '#' to the end of the line
+//      numVerts numFaces numEdges numCells     (or just numVerts numFaces numCells)
+//      x y z w                                 one line per vertex
+//      k v1 v2 ... vk [color]                  one line per 2-face, vertices in order
+//      k f1 f2 ... fk [color]                  one line per cell, as 2-face numbers
+//   The edges are not listed in the file; they are collected from the sides of
+//   the 2-faces as these are read. The file is read in large chunks and parsed
+//   in place, with its own number parser, straight into the arrays below.
+//
+
+#include <vector>
+
+class Off4DFile
+{
+public:
+	// Reads the file. Returns false (after printing why) if it cannot be read,
+	//    or is not a 4OFF file.
+	bool Read(const char* filename);
+
+	int GetNumVerts() const { return (int)verts.size() / 4; }
+	const float* GetVerts() const { return verts.data(); }		// 4 floats per vertex
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge, smaller first
+
+	// The 2-faces, as in the file; the vertices are in order around each face.
+	int GetNumFaces() const { return (int)faceStart.size() - 1; }
+	int GetFaceSize(int i) const { return faceStart[i + 1] - faceStart[i]; }
+	const int* GetFace(int i) const { return faceVerts.data() + faceStart[i]; }
+
+	// The cells, as in the file, each as its vertices in increasing order
+	//    (so cellStart and cellVerts can go to PolytopeTopology4D::BuildFromCells).
+	int GetNumCells() const { return (int)cellStart.size() - 1; }
+	int GetCellSize(int i) const { return cellStart[i + 1] - cellStart[i]; }
+	const int* GetCell(int i) const { return cellVerts.data() + cellStart[i]; }
+	const std::vector<int>& GetCellStart() const { return cellStart; }
+	const std::vector<int>& GetCellVerts() const { return cellVerts; }
+
+private:
+	std::vector<float> verts;
+	std::vector<int> edges;
+	std::vector<int> faceStart;		// Face i is faceVerts[faceStart[i]] up to faceVerts[faceStart[i+1]-1]
+	std::vector<int> faceVerts;
+	std::vector<int> cellStart;		// Likewise for the cells
+	std::vector<int> cellVerts;
+};
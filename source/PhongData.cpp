@@ -8,6 +8,7 @@
 #include "LinearR4.h"
 #include "GlGeomSphere.h"
 #include "GlShaderMgr.h"
+#include "GlStateCache.h"
 #include "TextureProj.h"
 
 extern phGlobal globalPhongData;
@@ -153,16 +154,26 @@ void MyRenderSpheresForLights() {
    float matEntries[16];	// Holds 16 floats (since cannot load doubles into a shader that uses floats)
    phMaterial myEmissiveMaterial;
 
-   for (int i = 0; i < 3; i++) {
-        if (myLights[i].IsEnabled) {
-            LinearMapR4 modelviewMat = viewMatrix;
-            modelviewMat.Mult_glTranslate(myLightPositions[i].x, myLightPositions[i].y,myLightPositions[i].z);
-            modelviewMat.Mult_glScale(0.2);
+   for (int i = 0; i < numLightSpheres; i++) {
+        LinearMapR4 modelviewMat;
+        if (MyGetLightSphere(i, modelviewMat, myEmissiveMaterial)) {
             modelviewMat.DumpByColumns(matEntries);
-            glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-            myEmissiveMaterial.EmissiveColor = myLights[i].DiffuseColor;
+            GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
             myEmissiveMaterial.LoadIntoShaders();
             myLightSphere.Render();
         }
     }
 }
+
+// The modelview matrix and material of the small sphere for light i.
+// Returns false if the light is off, and the sphere should not be drawn.
+bool MyGetLightSphere(int i, LinearMapR4& modelviewMat, phMaterial& emissiveMaterial) {
+    if (!myLights[i].IsEnabled) {
+        return false;
+    }
+    modelviewMat = viewMatrix;
+    modelviewMat.Mult_glTranslate(myLightPositions[i].x, myLightPositions[i].y, myLightPositions[i].z);
+    modelviewMat.Mult_glScale(0.2);
+    emissiveMaterial.EmissiveColor = myLights[i].DiffuseColor;
+    return true;
+}
@@ -21,8 +21,14 @@ extern phMaterial myMaterials[3];
 // myLights[3] is the spotlight.
 extern phLight myLights[6];
 
+// Small spheres showing the positions of the first numLightSpheres lights.
+class GlGeomSphere;
+const int numLightSpheres = 3;
+extern GlGeomSphere myLightSphere;
+
 void MySetupGlobalLight();
 void MySetupLights();
 void LoadAllLights();
 void MySetupMaterials();
-void MyRenderSpheresForLights();
\ No newline at end of file
+void MyRenderSpheresForLights();
+bool MyGetLightSphere(int i, LinearMapR4& modelviewMat, phMaterial& emissiveMaterial);
@@ -0,0 +1,357 @@
+//
+//  Polytope4D.cpp
+//
+//   The polytope data model and registry. See Polytope4D.h.
+//
+
+#include "Polytope4D.h"
+#include "Rotate4D.h"
+#include "Reorder4D.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <utility>
+#include <vector>
+
+// **********************
+// Polytope4D
+// **********************
+
+int Polytope4D::nextSerial = 1;
+
+Polytope4D& Polytope4D::operator=(Polytope4D&& other)
+{
+	if (this != &other) {
+		Clear();
+		rawBlock = other.rawBlock;
+		owner = std::move(other.owner);
+		numBytes = other.numBytes;
+		x = other.x; y = other.y; z = other.z; w = other.w;
+		aosVerts = other.aosVerts;
+		edges = other.edges;
+		faceStart = other.faceStart;
+		faceVerts = other.faceVerts;
+		cellStart = other.cellStart;
+		cellVerts = other.cellVerts;
+		numVerts = other.numVerts;
+		numHalf = other.numHalf;
+		numEdges = other.numEdges;
+		numFaces = other.numFaces;
+		numCells = other.numCells;
+		memcpy(boundsMin, other.boundsMin, sizeof(boundsMin));
+		memcpy(boundsMax, other.boundsMax, sizeof(boundsMax));
+		circumradius = other.circumradius;
+		spanBefore = other.spanBefore;
+		spanAfter = other.spanAfter;
+		name.swap(other.name);
+		source = other.source;
+		builtinIndex = other.builtinIndex;
+		serial = other.serial;
+		other.rawBlock = 0;			// The block now belongs to this one
+		other.Clear();
+	}
+	return *this;
+}
+
+void Polytope4D::Clear()
+{
+	free(rawBlock);
+	rawBlock = 0;
+	owner.reset();
+	numBytes = 0;
+	x = y = z = w = 0;
+	aosVerts = 0;
+	edges = 0;
+	faceStart = faceVerts = cellStart = cellVerts = 0;
+	numVerts = numHalf = numEdges = numFaces = numCells = 0;
+	for (int k = 0; k < 4; k++) {
+		boundsMin[k] = boundsMax[k] = 0.0f;
+	}
+	circumradius = 0.0f;
+	spanBefore = spanAfter = EdgeSpanStats{ 0.0, 0, 0 };
+}
+
+void Polytope4D::SetInfo(const char* theName, int theSource, int theBuiltinIndex)
+{
+	name = theName;
+	source = theSource;
+	builtinIndex = theBuiltinIndex;
+}
+
+bool Polytope4D::Build(const float* verts, int nVerts, const int* theEdges, int nEdges,
+	const int* theFaceStart, const int* theFaceVerts, int nFaces,
+	const int* theCellStart, const int* theCellVerts, int nCells)
+{
+	Clear();
+	bool withFaces = (theFaceStart != 0 && nFaces > 0);
+	bool withCells = (theCellStart != 0 && nCells > 0);
+	int numFaceVerts = withFaces ? theFaceStart[nFaces] : 0;
+	int numCellVerts = withCells ? theCellStart[nCells] : 0;
+
+	// Lay out the block: every array starts on a cache line.
+	size_t sizes[9] = {
+		nVerts * sizeof(float), nVerts * sizeof(float), nVerts * sizeof(float), nVerts * sizeof(float),
+		nEdges * sizeof(PolytopeEdge),
+		withFaces ? (nFaces + 1) * sizeof(int) : 0, numFaceVerts * sizeof(int),
+		withCells ? (nCells + 1) * sizeof(int) : 0, numCellVerts * sizeof(int),
+	};
+	size_t offsets[9];
+	size_t total = 0;
+	for (int k = 0; k < 9; k++) {
+		offsets[k] = total;
+		total += (sizes[k] + Alignment - 1) & ~(Alignment - 1);
+	}
+	rawBlock = malloc(total + Alignment);
+	if (rawBlock == 0) {
+		return false;
+	}
+	char* base = (char*)(((size_t)rawBlock + Alignment - 1) & ~(Alignment - 1));
+	numBytes = total;
+	float* newX = (float*)(base + offsets[0]);
+	float* newY = (float*)(base + offsets[1]);
+	float* newZ = (float*)(base + offsets[2]);
+	float* newW = (float*)(base + offsets[3]);
+	PolytopeEdge* newEdges = (PolytopeEdge*)(base + offsets[4]);
+	int* newFaceStart = (int*)(base + offsets[5]);
+	int* newFaceVerts = (int*)(base + offsets[6]);
+	int* newCellStart = (int*)(base + offsets[7]);
+	int* newCellVerts = (int*)(base + offsets[8]);
+	x = newX; y = newY; z = newZ; w = newW;
+	edges = newEdges;
+	if (withFaces) {
+		faceStart = newFaceStart;
+		faceVerts = newFaceVerts;
+	}
+	if (withCells) {
+		cellStart = newCellStart;
+		cellVerts = newCellVerts;
+	}
+	numVerts = nVerts;
+	numEdges = nEdges;
+	numFaces = withFaces ? nFaces : 0;
+	numCells = withCells ? nCells : 0;
+	serial = nextSerial++;
+
+	// The vertices, in the order for rotating, and the bounds.
+	std::vector<int> oldIndex;
+	numHalf = orderAntipodalPairs(verts, nVerts, oldIndex);
+	OrderForCache(verts, theEdges, nEdges, oldIndex);
+	std::vector<int> newIndex(nVerts);
+	for (int k = 0; k < 4; k++) {
+		boundsMin[k] = nVerts > 0 ? FLT_MAX : 0.0f;
+		boundsMax[k] = nVerts > 0 ? -FLT_MAX : 0.0f;
+	}
+	float maxNormSq = 0.0f;
+	for (int i = 0; i < nVerts; i++) {
+		const float* v = verts + 4 * oldIndex[i];
+		newX[i] = v[0]; newY[i] = v[1]; newZ[i] = v[2]; newW[i] = v[3];
+		newIndex[oldIndex[i]] = i;
+		for (int k = 0; k < 4; k++) {
+			boundsMin[k] = v[k] < boundsMin[k] ? v[k] : boundsMin[k];
+			boundsMax[k] = v[k] > boundsMax[k] ? v[k] : boundsMax[k];
+		}
+		float normSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3];
+		maxNormSq = normSq > maxNormSq ? normSq : maxNormSq;
+	}
+	circumradius = sqrtf(maxNormSq);
+
+	// Everything else is renumbered, and the edges sorted to follow the vertices.
+	spanBefore = GetEdgeSpanStats(theEdges, nEdges);
+	for (int e = 0; e < nEdges; e++) {
+		newEdges[e].v[0] = newIndex[theEdges[2 * e]];
+		newEdges[e].v[1] = newIndex[theEdges[2 * e + 1]];
+	}
+	SortEdges((int*)newEdges, nEdges);
+	spanAfter = GetEdgeSpanStats((const int*)newEdges, nEdges);
+	if (withFaces) {
+		memcpy(newFaceStart, theFaceStart, (nFaces + 1) * sizeof(int));
+		for (int k = 0; k < numFaceVerts; k++) {
+			newFaceVerts[k] = newIndex[theFaceVerts[k]];
+		}
+	}
+	if (withCells) {
+		memcpy(newCellStart, theCellStart, (nCells + 1) * sizeof(int));
+		for (int k = 0; k < numCellVerts; k++) {
+			newCellVerts[k] = newIndex[theCellVerts[k]];
+		}
+	}
+	return true;
+}
+
+void Polytope4D::Borrow(const PolytopeArrays& arrays, std::shared_ptr<const void> theOwner)
+{
+	Clear();
+	owner = std::move(theOwner);
+	x = arrays.coords[0];
+	y = arrays.coords[1];
+	z = arrays.coords[2];
+	w = arrays.coords[3];
+	aosVerts = arrays.aosVerts;
+	edges = (const PolytopeEdge*)arrays.edges;
+	numVerts = arrays.numVerts;
+	numHalf = arrays.numHalf;
+	numEdges = arrays.numEdges;
+	if (arrays.faceStart != 0 && arrays.numFaces > 0) {
+		faceStart = arrays.faceStart;
+		faceVerts = arrays.faceVerts;
+		numFaces = arrays.numFaces;
+	}
+	if (arrays.cellStart != 0 && arrays.numCells > 0) {
+		cellStart = arrays.cellStart;
+		cellVerts = arrays.cellVerts;
+		numCells = arrays.numCells;
+	}
+	numBytes = (aosVerts != 0 ? 8 : 4) * numVerts * sizeof(float) + numEdges * sizeof(PolytopeEdge)
+		+ (numFaces > 0 ? (numFaces + 1 + faceStart[numFaces]) * sizeof(int) : 0)
+		+ (numCells > 0 ? (numCells + 1 + cellStart[numCells]) * sizeof(int) : 0);
+	memcpy(boundsMin, arrays.boundsMin, sizeof(boundsMin));
+	memcpy(boundsMax, arrays.boundsMax, sizeof(boundsMax));
+	circumradius = arrays.circumradius;
+	spanBefore = spanAfter = arrays.edgeSpan;
+	serial = nextSerial++;
+}
+
+void Polytope4D::GetArrays(PolytopeArrays& arrays) const
+{
+	arrays.coords[0] = x;
+	arrays.coords[1] = y;
+	arrays.coords[2] = z;
+	arrays.coords[3] = w;
+	arrays.aosVerts = aosVerts;
+	arrays.edges = (const int*)edges;
+	arrays.faceStart = faceStart;
+	arrays.faceVerts = faceVerts;
+	arrays.cellStart = cellStart;
+	arrays.cellVerts = cellVerts;
+	arrays.numVerts = numVerts;
+	arrays.numHalf = numHalf;
+	arrays.numEdges = numEdges;
+	arrays.numFaces = numFaces;
+	arrays.numCells = numCells;
+	memcpy(arrays.boundsMin, boundsMin, sizeof(boundsMin));
+	memcpy(arrays.boundsMax, boundsMax, sizeof(boundsMax));
+	arrays.circumradius = circumradius;
+	arrays.edgeSpan = spanAfter;
+}
+
+// Renumbers the vertices in oldIndex (as orderAntipodalPairs() left it) so that the ends
+//    of most edges are close together, while keeping vertex numVerts - 1 - k the antipode of vertex k.
+// Of each antipodal pair, the vertex in one hemisphere goes in the first half, which is then
+//    put in reverse Cuthill-McKee order of the edges inside it. The vertices with edges
+//    across the boundary of the hemisphere come last, so that their antipodes, mirrored
+//    in the second half, come right after them, and those edges are short too.
+// The hemisphere is kept even if the order from Cuthill-McKee is not.
+void Polytope4D::OrderForCache(const float* verts, const int* theEdges, int nEdges, std::vector<int>& oldIndex) const
+{
+	static const float hemisphere[4] = { 0.8563f, 0.4147f, 0.2571f, 0.1698f };	// Not along any axis of symmetry
+	bool symmetric = numHalf < numVerts;
+	if (symmetric) {
+		for (int k = 0; k < numHalf; k++) {
+			const float* v = verts + 4 * oldIndex[k];
+			if (v[0] * hemisphere[0] + v[1] * hemisphere[1] + v[2] * hemisphere[2] + v[3] * hemisphere[3] < 0.0f) {
+				std::swap(oldIndex[k], oldIndex[numVerts - 1 - k]);
+			}
+		}
+	}
+	std::vector<int> position(numVerts);
+	for (int k = 0; k < numVerts; k++) {
+		position[oldIndex[k]] = k;
+	}
+	std::vector<int> halfEdges;
+	std::vector<char> onBoundary(numHalf, 0);
+	halfEdges.reserve(2 * nEdges);
+	for (int e = 0; e < nEdges; e++) {
+		int a = position[theEdges[2 * e]];
+		int b = position[theEdges[2 * e + 1]];
+		if (a < numHalf && b < numHalf) {
+			halfEdges.push_back(a);
+			halfEdges.push_back(b);
+		}
+		else if (a < numHalf || b < numHalf) {
+			onBoundary[a < numHalf ? a : b] = 1;
+			onBoundary[a < numHalf ? numVerts - 1 - b : numVerts - 1 - a] = 1;		// Its antipode's edge
+		}
+	}
+	std::vector<int> halfOrder;
+	ReverseCuthillMcKee(numHalf, halfEdges.data(), (int)halfEdges.size() / 2, halfOrder,
+		symmetric ? onBoundary.data() : 0);
+	std::vector<int> ordered(numVerts);
+	for (int k = 0; k < numHalf; k++) {
+		ordered[k] = oldIndex[halfOrder[k]];
+		if (symmetric) {
+			ordered[numVerts - 1 - k] = oldIndex[numVerts - 1 - halfOrder[k]];
+		}
+	}
+
+	// Some generators already give a good order: keep whichever has more edges whose ends
+	//    are close enough to share the cache. Past CacheWindow, all spans cost the same.
+	const int CacheWindow = 1024;
+	long long oldCost = 0;
+	long long newCost = 0;
+	for (int e = 0; e < nEdges; e++) {
+		int span = abs(position[theEdges[2 * e]] - position[theEdges[2 * e + 1]]);
+		oldCost += span < CacheWindow ? span : CacheWindow;
+	}
+	for (int k = 0; k < numVerts; k++) {
+		position[ordered[k]] = k;
+	}
+	for (int e = 0; e < nEdges; e++) {
+		int span = abs(position[theEdges[2 * e]] - position[theEdges[2 * e + 1]]);
+		newCost += span < CacheWindow ? span : CacheWindow;
+	}
+	if (newCost < oldCost) {
+		oldIndex.swap(ordered);
+	}
+}
+
+void Polytope4D::CopyVerts(float* aosVerts) const
+{
+	for (int i = 0; i < numVerts; i++) {
+		aosVerts[4 * i] = x[i];
+		aosVerts[4 * i + 1] = y[i];
+		aosVerts[4 * i + 2] = z[i];
+		aosVerts[4 * i + 3] = w[i];
+	}
+}
+
+void Polytope4D::Rotate(const float* R, float scale, float* outX, float* outY, float* outZ, float* outW) const
+{
+	rotate4DHalves(R, scale, x, y, z, w, numVerts, numHalf, outX, outY, outZ, outW);
+}
+
+// **********************
+// PolytopeRegistry
+// **********************
+
+int PolytopeRegistry::Add(Polytope4D&& polytope)
+{
+	entries.emplace_back();
+	Entry& entry = entries.back();
+	entry.name = polytope.GetName();
+	entry.built = true;
+	entry.polytope = std::move(polytope);
+	return GetCount() - 1;
+}
+
+int PolytopeRegistry::AddLazy(const char* name, PolytopeBuilder builder)
+{
+	entries.emplace_back();
+	Entry& entry = entries.back();
+	entry.name = name;
+	entry.builder = builder;
+	entry.built = false;
+	return GetCount() - 1;
+}
+
+Polytope4D& PolytopeRegistry::Get(int i)
+{
+	Entry& entry = entries[i];
+	if (!entry.built) {
+		entry.built = true;
+		if (!entry.builder(entry.polytope)) {
+			entry.polytope.Clear();
+		}
+	}
+	return entry.polytope;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+//
+// Polytope4D.h   ---  Header file for Polytope4D.cpp.
+//
+//   The polytopes the viewer shows, and the registry that numbers them.
+//
+//   A Polytope4D owns all its arrays in one block of 64-byte aligned memory:
+//      the vertices, as x, y, z and w arrays laid out for rotate4DHalves()
+//         (see orderAntipodalPairs() in Rotate4D.h: the vertices are reordered
+//         when it is built, and the edges, faces and cells renumbered to match;
+//         the order also keeps the ends of each edge close, see Reorder4D.h),
+//      the edges, sorted by their first vertex (the smaller),
+//      and optionally the 2-faces and cells, as CSR lists (start and items arrays).
+//   It also keeps its bounding box, its circumradius and where it came from.
+//   A Polytope4D can be moved but not copied: a move only hands over the block.
+//   Instead of building its arrays, a polytope can borrow arrays that are already
+//   in its order, such as those of a memory-mapped polytope file (PolytopeFile.h):
+//   it then holds on to their owner, and copies nothing.
+//
+//   The PolytopeRegistry holds the polytopes by number (the 'mode' of the viewer).
+//   Built-ins, generators and file loaders all add entries, either a finished
+//   polytope or a builder that makes it the first time it is asked for. The
+//   entries never move once added, so switching between polytopes allocates nothing.
+//
+
+#include <stddef.h>
+#include <string>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Reorder4D.h"
+
+// Where a polytope came from
+const int psBuiltin = 0;		// PolytopeTable.h
+const int psGenerated = 1;		// A generator, such as StressScene4D
+const int psFile = 2;			// A polytope file (PolytopeFile.h or Off4D.h)
+const int psPoints = 3;			// A file of bare points: their edges or convex hull were found
+
+typedef struct {
+	int v[2];					// The two end vertices
+} PolytopeEdge;
+
+// The arrays of a polytope in the order Build() leaves them, with what Build() works
+//    out about them: what Borrow() takes, and a polytope file stores.
+struct PolytopeArrays {
+	const float* coords[4];		// x, y, z and w
+	const float* aosVerts;		// The same, interleaved: 4 floats per vertex (optional)
+	const int* edges;			// 2 vertex indices per edge, sorted as Build() sorts them
+	const int* faceStart;		// Optional, as in Build()
+	const int* faceVerts;
+	const int* cellStart;		// Optional, as in Build()
+	const int* cellVerts;
+	int numVerts;
+	int numHalf;
+	int numEdges;
+	int numFaces;
+	int numCells;
+	float boundsMin[4];
+	float boundsMax[4];
+	float circumradius;
+	EdgeSpanStats edgeSpan;
+};
+
+class Polytope4D
+{
+public:
+	Polytope4D() {}
+	~Polytope4D() { Clear(); }
+	Polytope4D(Polytope4D&& other) { *this = std::move(other); }
+	Polytope4D& operator=(Polytope4D&& other);
+	Polytope4D(const Polytope4D&) = delete;
+	Polytope4D& operator=(const Polytope4D&) = delete;
+
+	// Builds the polytope from vertices (4 floats each) and edges (2 vertex indices each),
+	//    and optionally 2-faces (vertices in order around each) and cells as CSR lists.
+	//    The vertex indices refer to the order of verts.
+	// Returns false (and leaves the polytope empty) if out of memory.
+	bool Build(const float* verts, int numVerts, const int* edges, int numEdges,
+		const int* faceStart = 0, const int* faceVerts = 0, int numFaces = 0,
+		const int* cellStart = 0, const int* cellVerts = 0, int numCells = 0);
+	// Uses arrays that are already in order in place: nothing is copied. owner (such as
+	//    the file mapping they are in) is held until the polytope is cleared.
+	void Borrow(const PolytopeArrays& arrays, std::shared_ptr<const void> owner);
+	void Clear();
+
+	void SetInfo(const char* theName, int theSource, int theBuiltinIndex = -1);
+	const char* GetName() const { return name.c_str(); }
+	int GetSource() const { return source; }				// psBuiltin, ...
+	int GetBuiltinIndex() const { return builtinIndex; }	// Its entry in polytopeTable, or -1
+	int GetSerial() const { return serial; }				// Different for every Build(), so caches can tell a rebuilt polytope
+
+	int GetNumVerts() const { return numVerts; }
+	int GetNumHalf() const { return numHalf; }				// The vertices that rotate4DHalves() actually rotates
+	bool IsCentrallySymmetric() const { return numHalf < numVerts; }
+	const float* GetX() const { return x; }
+	const float* GetY() const { return y; }
+	const float* GetZ() const { return z; }
+	const float* GetW() const { return w; }
+	void CopyVerts(float* aosVerts) const;					// Interleaved, 4 floats per vertex
+	const float* GetAosVerts() const { return aosVerts; }	// The same, if it has them already (0 if not)
+	void GetArrays(PolytopeArrays& arrays) const;			// For writing it to a file
+
+	int GetNumEdges() const { return numEdges; }
+	const PolytopeEdge* GetEdges() const { return edges; }
+	const int* GetEdgeIndices() const { return (const int*)edges; }	// 2 vertex indices per edge
+
+	bool HasFaces() const { return faceStart != 0; }
+	int GetNumFaces() const { return numFaces; }
+	const int* GetFaceStart() const { return faceStart; }
+	const int* GetFaceVerts() const { return faceVerts; }
+	bool HasCells() const { return cellStart != 0; }
+	int GetNumCells() const { return numCells; }
+	const int* GetCellStart() const { return cellStart; }
+	const int* GetCellVerts() const { return cellVerts; }
+
+	const float* GetBoundsMin() const { return boundsMin; }	// Bounding box, 4 floats each
+	const float* GetBoundsMax() const { return boundsMax; }
+	float GetCircumradius() const { return circumradius; }	// Largest distance of a vertex from the origin
+	size_t GetNumBytes() const { return numBytes; }
+	const EdgeSpanStats& GetEdgeSpanBefore() const { return spanBefore; }	// In the order Build() was given
+	const EdgeSpanStats& GetEdgeSpanAfter() const { return spanAfter; }	// In the order it chose
+
+	// Rotates all the vertices into the four output arrays (each GetNumVerts() long).
+	void Rotate(const float* R, float scale, float* outX, float* outY, float* outZ, float* outW) const;
+
+private:
+	static const size_t Alignment = 64;
+	static int nextSerial;
+
+	void OrderForCache(const float* verts, const int* theEdges, int nEdges, std::vector<int>& oldIndex) const;
+
+	void* rawBlock = 0;			// As returned by malloc
+	std::shared_ptr<const void> owner;		// Of the arrays, if they are borrowed
+	size_t numBytes = 0;
+	const float* x = 0;
+	const float* y = 0;
+	const float* z = 0;
+	const float* w = 0;
+	const float* aosVerts = 0;	// Only if borrowed
+	const PolytopeEdge* edges = 0;
+	const int* faceStart = 0;	// 0 if there are no 2-faces
+	const int* faceVerts = 0;
+	const int* cellStart = 0;	// 0 if there are no cells
+	const int* cellVerts = 0;
+	int numVerts = 0;
+	int numHalf = 0;
+	int numEdges = 0;
+	int numFaces = 0;
+	int numCells = 0;
+	float boundsMin[4] = { 0, 0, 0, 0 };
+	float boundsMax[4] = { 0, 0, 0, 0 };
+	float circumradius = 0;
+	EdgeSpanStats spanBefore = { 0.0, 0, 0 };
+	EdgeSpanStats spanAfter = { 0.0, 0, 0 };
+
+	std::string name;
+	int source = psBuiltin;
+	int builtinIndex = -1;
+	int serial = 0;
+};
+
+// Makes a polytope (calling Build() and SetInfo()). Returns false if it could not.
+typedef std::function<bool(Polytope4D&)> PolytopeBuilder;
+
+class PolytopeRegistry
+{
+public:
+	// Adds a finished polytope. Returns its number.
+	int Add(Polytope4D&& polytope);
+	// Adds a polytope that builder makes the first time Get() is called. Returns its number.
+	int AddLazy(const char* name, PolytopeBuilder builder);
+
+	int GetCount() const { return (int)entries.size(); }
+	const char* GetName(int i) const { return entries[i].name.c_str(); }	// Without building it
+
+	// Polytope i, built now if it has not been yet. If its builder fails, it is empty.
+	Polytope4D& Get(int i);
+
+	// Polytope i is built again by the next Get(). Only for polytopes with a builder.
+	void Invalidate(int i) { entries[i].built = !entries[i].builder; }
+
+private:
+	typedef struct {
+		std::string name;
+		PolytopeBuilder builder;		// Empty for polytopes added by Add()
+		bool built;
+		Polytope4D polytope;
+	} Entry;
+	std::deque<Entry> entries;			// A deque, so adding an entry moves none of the others
+};
@@ -0,0 +1,362 @@
+//
+//  PolytopeFile.cpp
+//
+//   Writing and memory-mapping binary polytope files. See PolytopeFile.h.
+//
+
+#include "PolytopeFile.h"
+#include "Polytope4D.h"
+#include "Rotate4D.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char polytopeFileMagic[8] = { 'P', 'O', 'L', 'Y', '4', 'D', 0, 0 };
+
+static uint64_t AlignUp(uint64_t offset)
+{
+	return (offset + PolytopeFileAlignment - 1) & ~(uint64_t)(PolytopeFileAlignment - 1);
+}
+
+// FNV-1a of the header, as if its checksum field were 0.
+static uint32_t HeaderChecksum(const PolytopeFileHeader& header)
+{
+	PolytopeFileHeader copy = header;
+	copy.checksum = 0;
+	const unsigned char* bytes = (const unsigned char*)&copy;
+	uint32_t hash = 2166136261u;
+	for (size_t k = 0; k < sizeof(copy); k++) {
+		hash = (hash ^ bytes[k]) * 16777619u;
+	}
+	return hash;
+}
+
+// **********************
+// Writing
+// **********************
+
+// Writes bytes at offset, padding with zeros from the current position.
+static bool WriteAt(FILE* file, uint64_t& position, uint64_t offset, const void* data, size_t numBytes)
+{
+	static const char zeros[PolytopeFileAlignment] = { 0 };
+	if (offset > position && fwrite(zeros, 1, (size_t)(offset - position), file) != offset - position) {
+		return false;
+	}
+	position = offset + numBytes;
+	return numBytes == 0 || fwrite(data, 1, numBytes, file) == numBytes;
+}
+
+bool WritePolytopeFile(const char* filename, const Polytope4D& polytope)
+{
+	PolytopeArrays arrays;
+	polytope.GetArrays(arrays);
+	int numVerts = arrays.numVerts;
+	int numEdges = arrays.numEdges;
+	std::vector<float> interleaved;
+	const float* verts = arrays.aosVerts;
+	if (verts == 0) {
+		interleaved.resize(4 * (size_t)numVerts);
+		polytope.CopyVerts(interleaved.data());
+		verts = interleaved.data();
+	}
+	bool withFaces = (arrays.faceStart != 0 && arrays.numFaces > 0);
+	bool withCells = (arrays.cellStart != 0 && arrays.numCells > 0);
+
+	PolytopeFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, polytopeFileMagic, sizeof(header.magic));
+	header.version = PolytopeFileVersion;
+	header.headerSize = sizeof(PolytopeFileHeader);
+	header.numVerts = numVerts;
+	header.numHalf = arrays.numHalf;
+	header.numEdges = numEdges;
+	memcpy(header.boundsMin, arrays.boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, arrays.boundsMax, sizeof(header.boundsMax));
+	header.circumradius = arrays.circumradius;
+	header.spanMean = arrays.edgeSpan.mean;
+	header.spanMedian = arrays.edgeSpan.median;
+	header.spanMax = arrays.edgeSpan.max;
+	uint64_t end = sizeof(PolytopeFileHeader);
+	for (int k = 0; k < 4; k++) {
+		header.coordsOffset[k] = AlignUp(end);
+		end = header.coordsOffset[k] + sizeof(float) * (uint64_t)numVerts;
+	}
+	header.vertsOffset = AlignUp(end);
+	header.edgesOffset = AlignUp(header.vertsOffset + 4 * sizeof(float) * (uint64_t)numVerts);
+	end = header.edgesOffset + 2 * sizeof(int) * (uint64_t)numEdges;
+	if (withFaces) {
+		header.numFaces = arrays.numFaces;
+		header.facesOffset = AlignUp(end);
+		end = header.facesOffset + sizeof(int) * (uint64_t)(arrays.numFaces + 1 + arrays.faceStart[arrays.numFaces]);
+	}
+	if (withCells) {
+		header.numCells = arrays.numCells;
+		header.cellsOffset = AlignUp(end);
+	}
+	header.checksum = HeaderChecksum(header);
+
+	FILE* file = fopen(filename, "wb");
+	if (file == 0) {
+		fprintf(stderr, "Unable to open file '%s' for writing.\n", filename);
+		return false;
+	}
+	uint64_t position = 0;
+	bool ok = WriteAt(file, position, 0, &header, sizeof(header));
+	for (int k = 0; k < 4 && ok; k++) {
+		ok = WriteAt(file, position, header.coordsOffset[k], arrays.coords[k], sizeof(float) * (size_t)numVerts);
+	}
+	ok = ok && WriteAt(file, position, header.vertsOffset, verts, 4 * sizeof(float) * (size_t)numVerts)
+		&& WriteAt(file, position, header.edgesOffset, arrays.edges, 2 * sizeof(int) * (size_t)numEdges);
+	if (ok && withFaces) {
+		ok = WriteAt(file, position, header.facesOffset, arrays.faceStart, sizeof(int) * (size_t)(arrays.numFaces + 1))
+			&& WriteAt(file, position, position, arrays.faceVerts, sizeof(int) * (size_t)arrays.faceStart[arrays.numFaces]);
+	}
+	if (ok && withCells) {
+		ok = WriteAt(file, position, header.cellsOffset, arrays.cellStart, sizeof(int) * (size_t)(arrays.numCells + 1))
+			&& WriteAt(file, position, position, arrays.cellVerts, sizeof(int) * (size_t)arrays.cellStart[arrays.numCells]);
+	}
+	ok = (fclose(file) == 0) && ok;
+	if (!ok) {
+		fprintf(stderr, "Error writing polytope file '%s'.\n", filename);
+	}
+	return ok;
+}
+
+// **********************
+// MappedPolytope
+// **********************
+
+MappedPolytope::MappedPolytope()
+{
+	base = 0;
+	size = 0;
+	header = 0;
+#if defined(_WIN32)
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = 0;
+#else
+	fileDescriptor = -1;
+#endif
+}
+
+bool MappedPolytope::Open(const char* filename)
+{
+	Close();
+#if defined(_WIN32)
+	fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, 0);
+	LARGE_INTEGER fileSize;
+	if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize)) {
+		fprintf(stderr, "Unable to open polytope file '%s'.\n", filename);
+		Close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+	if (size >= sizeof(PolytopeFileHeader)) {
+		mappingHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+		if (mappingHandle != 0) {
+			base = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+#else
+	fileDescriptor = open(filename, O_RDONLY);
+	struct stat fileStat;
+	if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStat) != 0) {
+		fprintf(stderr, "Unable to open polytope file '%s'.\n", filename);
+		Close();
+		return false;
+	}
+	size = (size_t)fileStat.st_size;
+	if (size >= sizeof(PolytopeFileHeader)) {
+		void* mapped = mmap(0, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		base = (mapped == MAP_FAILED) ? 0 : (const unsigned char*)mapped;
+	}
+#endif
+	if (base == 0) {
+		fprintf(stderr, "Unable to map polytope file '%s'.\n", filename);
+		Close();
+		return false;
+	}
+
+	const PolytopeFileHeader* h = (const PolytopeFileHeader*)base;
+	const char* problem = 0;
+	if (memcmp(h->magic, polytopeFileMagic, sizeof(h->magic)) != 0) {
+		problem = "not a polytope file";
+	}
+	else if (h->version != PolytopeFileVersion || h->headerSize < sizeof(PolytopeFileHeader)) {
+		problem = "unsupported version";
+	}
+	else if (h->checksum != HeaderChecksum(*h)) {
+		problem = "damaged header";
+	}
+	else if (h->numVerts > 0x7fffffffu || h->numEdges > 0x7fffffffu || h->numFaces > 0x7fffffffu
+		|| h->numCells > 0x7fffffffu || (h->numHalf != h->numVerts && 2 * (uint64_t)h->numHalf != h->numVerts)) {
+		problem = "bad counts";
+	}
+	if (problem == 0) {
+		// The x, y, z and w arrays, the interleaved vertices and the edges
+		uint64_t blocks[6] = { h->coordsOffset[0], h->coordsOffset[1], h->coordsOffset[2], h->coordsOffset[3],
+			h->vertsOffset, h->edgesOffset };
+		uint64_t coordBytes = sizeof(float) * (uint64_t)h->numVerts;
+		uint64_t blockBytes[6] = { coordBytes, coordBytes, coordBytes, coordBytes, 4 * coordBytes,
+			2 * sizeof(int) * (uint64_t)h->numEdges };
+		for (int k = 0; k < 6 && problem == 0; k++) {
+			if (blocks[k] % PolytopeFileAlignment != 0 || blocks[k] < sizeof(PolytopeFileHeader)) {
+				problem = "misaligned block";
+			}
+			else if (blocks[k] + blockBytes[k] > size) {
+				problem = "truncated";
+			}
+		}
+		if (problem == 0 && (h->facesOffset % PolytopeFileAlignment != 0 || h->cellsOffset % PolytopeFileAlignment != 0)) {
+			problem = "misaligned block";
+		}
+	}
+	if (problem != 0) {
+		fprintf(stderr, "Polytope file '%s': %s.\n", filename, problem);
+		Close();
+		return false;
+	}
+	header = h;
+	if (!CheckCsrBlock(header->facesOffset, header->numFaces)
+		|| !CheckCsrBlock(header->cellsOffset, header->numCells)) {
+		fprintf(stderr, "Polytope file '%s': truncated.\n", filename);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+// Whether the CSR block at offset fits in the file. Reads only its last start entry.
+bool MappedPolytope::CheckCsrBlock(uint64_t offset, uint32_t numLists) const
+{
+	if (offset == 0) {
+		return true;
+	}
+	uint64_t startBytes = sizeof(int) * ((uint64_t)numLists + 1);
+	if (offset < sizeof(PolytopeFileHeader) || offset + startBytes > size) {
+		return false;
+	}
+	int numItems = ((const int*)(base + offset))[numLists];
+	return numItems >= 0 && offset + startBytes + sizeof(int) * (uint64_t)numItems <= size;
+}
+
+bool MappedPolytope::Validate() const
+{
+	if (!IsOpen()) {
+		return false;
+	}
+	int numVerts = GetNumVerts();
+	const int* edges = GetEdges();
+	for (int k = 0; k < 2 * GetNumEdges(); k++) {
+		if (edges[k] < 0 || edges[k] >= numVerts) {
+			fprintf(stderr, "Polytope file: edge %d has a bad vertex index.\n", k / 2);
+			return false;
+		}
+	}
+	for (int block = 0; block < 2; block++) {
+		bool present = (block == 0) ? HasFaces() : HasCells();
+		int numLists = (block == 0) ? GetNumFaces() : GetNumCells();
+		const int* start = (block == 0) ? GetFaceStart() : GetCellStart();
+		const int* items = (block == 0) ? GetFaceVerts() : GetCellVerts();
+		if (!present) {
+			continue;
+		}
+		for (int i = 0; i < numLists; i++) {
+			if (start[0] != 0 || start[i + 1] < start[i]) {
+				fprintf(stderr, "Polytope file: the %s list is not in order.\n", block == 0 ? "2-face" : "cell");
+				return false;
+			}
+		}
+		for (int k = 0; k < start[numLists]; k++) {
+			if (items[k] < 0 || items[k] >= numVerts) {
+				fprintf(stderr, "Polytope file: a %s has a bad vertex index.\n", block == 0 ? "2-face" : "cell");
+				return false;
+			}
+		}
+	}
+
+	// rotate4DHalves() only rotates the first half, and takes the second to be its antipodes
+	if (GetNumHalf() < numVerts) {
+		float maxAbs = 0.0f;
+		for (int k = 0; k < 4; k++) {
+			const float* c = GetCoords(k);
+			for (int i = 0; i < numVerts; i++) {
+				maxAbs = fabsf(c[i]) > maxAbs ? fabsf(c[i]) : maxAbs;
+			}
+		}
+		float tolerance = (float)(antipodeTolerance * maxAbs);
+		for (int k = 0; k < 4; k++) {
+			const float* c = GetCoords(k);
+			for (int i = 0; i < GetNumHalf(); i++) {
+				if (!(fabsf(c[i] + c[numVerts - 1 - i]) <= tolerance)) {
+					fprintf(stderr, "Polytope file: vertex %d is not the antipode of vertex %d.\n", numVerts - 1 - i, i);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void MappedPolytope::GetArrays(PolytopeArrays& arrays) const
+{
+	for (int k = 0; k < 4; k++) {
+		arrays.coords[k] = GetCoords(k);
+	}
+	arrays.aosVerts = GetVerts();
+	arrays.edges = GetEdges();
+	arrays.faceStart = HasFaces() ? GetFaceStart() : 0;
+	arrays.faceVerts = HasFaces() ? GetFaceVerts() : 0;
+	arrays.cellStart = HasCells() ? GetCellStart() : 0;
+	arrays.cellVerts = HasCells() ? GetCellVerts() : 0;
+	arrays.numVerts = GetNumVerts();
+	arrays.numHalf = GetNumHalf();
+	arrays.numEdges = GetNumEdges();
+	arrays.numFaces = HasFaces() ? GetNumFaces() : 0;
+	arrays.numCells = HasCells() ? GetNumCells() : 0;
+	memcpy(arrays.boundsMin, header->boundsMin, sizeof(arrays.boundsMin));
+	memcpy(arrays.boundsMax, header->boundsMax, sizeof(arrays.boundsMax));
+	arrays.circumradius = header->circumradius;
+	arrays.edgeSpan.mean = header->spanMean;
+	arrays.edgeSpan.median = header->spanMedian;
+	arrays.edgeSpan.max = header->spanMax;
+}
+
+void MappedPolytope::Close()
+{
+#if defined(_WIN32)
+	if (base != 0) {
+		UnmapViewOfFile(base);
+	}
+	if (mappingHandle != 0) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fileHandle);
+	}
+	mappingHandle = 0;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (base != 0) {
+		munmap((void*)base, size);
+	}
+	if (fileDescriptor >= 0) {
+		close(fileDescriptor);
+	}
+	fileDescriptor = -1;
+#endif
+	base = 0;
+	size = 0;
+	header = 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+//
+// PolytopeFile.h   ---  Header file for PolytopeFile.cpp.
+//
+//   A binary file format for polytopes that can be used straight from memory:
+//   the file is memory-mapped, and the renderer and the GPU upload get pointers
+//   into the mapping. Nothing is parsed or copied, so opening a file costs only
+//   the page faults on the parts that are actually used.
+//
+//   The file holds a Polytope4D as it is after Build(): the vertices already
+//   paired with their antipodes and in cache order, the edges renumbered and
+//   sorted, and the bounds and edge spans worked out. So a mapped file is handed
+//   to Polytope4D::Borrow() as it is.
+//
+//   Layout (little-endian), with every block starting on a 64 byte boundary:
+//      PolytopeFileHeader
+//      x, y, z, w    float[numVerts] each, as Polytope4D::GetX() etc.
+//      vertices      float[4*numVerts], the same interleaved, as the GPU reads them
+//      edges         int32[2*numEdges]
+//      2-faces       int32 faceStart[numFaces+1], then int32 faceVerts[faceStart[numFaces]]
+//      cells         int32 cellStart[numCells+1], then int32 cellVerts[cellStart[numCells]]
+//   The 2-faces and cells are optional (offset 0 when absent). They are the CSR
+//   lists of PolytopeTopology4D: face vertices in cyclic order, cell vertices sorted.
+//   The header carries a checksum of itself, so a damaged header is caught when
+//   the file is opened; the blocks are only range-checked by Validate().
+//   When numHalf < numVerts, vertex numVerts - 1 - i is the antipode of vertex i.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Polytope4D;
+struct PolytopeArrays;
+
+const int PolytopeFileVersion = 2;
+const int PolytopeFileAlignment = 64;
+
+struct PolytopeFileHeader
+{
+	char magic[8];			// "POLY4D" and two zero bytes
+	uint32_t version;		// PolytopeFileVersion
+	uint32_t headerSize;	// sizeof(PolytopeFileHeader), for later versions to grow it
+	uint32_t checksum;		// FNV-1a of the header, with this field 0
+	uint32_t numVerts;
+	uint32_t numHalf;		// As Polytope4D::GetNumHalf(): numVerts, or numVerts/2 when centrally symmetric
+	uint32_t numEdges;
+	uint32_t numFaces;		// 0 if there are no 2-faces
+	uint32_t numCells;		// 0 if there are no cells
+	float boundsMin[4];
+	float boundsMax[4];
+	float circumradius;
+	int32_t spanMedian;		// Polytope4D::GetEdgeSpanAfter()
+	int32_t spanMax;
+	uint32_t reserved;		// 0
+	double spanMean;
+	uint64_t coordsOffset[4];	// Byte offsets from the start of the file
+	uint64_t vertsOffset;
+	uint64_t edgesOffset;
+	uint64_t facesOffset;	// 0 if there are no 2-faces
+	uint64_t cellsOffset;	// 0 if there are no cells
+};
+
+// Writes polytope to a file, in the order it is already in.
+// Returns false (after printing why) if the file could not be written.
+bool WritePolytopeFile(const char* filename, const Polytope4D& polytope);
+
+// A polytope file, memory-mapped read-only. The pointers stay valid until Close().
+class MappedPolytope
+{
+public:
+	MappedPolytope();
+	~MappedPolytope() { Close(); }
+
+	// Maps the file and checks its header (with its checksum) and block sizes;
+	//    the data itself is not read.
+	// Returns false (after printing why) if it is not a valid polytope file.
+	bool Open(const char* filename);
+	void Close();
+	bool IsOpen() const { return header != 0; }
+
+	// Reads all the indices, and checks that they are in range, and that the second half
+	//    of the vertices is the antipodes of the first when numHalf < numVerts.
+	// The renderer trusts all of these, so this must pass before the arrays are used,
+	//    unless the file is known to have come from WritePolytopeFile().
+	// Returns false (after printing why) if any of them is wrong.
+	bool Validate() const;
+
+	int GetNumVerts() const { return header->numVerts; }
+	int GetNumHalf() const { return header->numHalf; }
+	const float* GetCoords(int k) const { return (const float*)(base + header->coordsOffset[k]); }	// x, y, z or w
+	const float* GetVerts() const { return (const float*)(base + header->vertsOffset); }	// 4 floats per vertex
+	int GetNumEdges() const { return header->numEdges; }
+	const int* GetEdges() const { return (const int*)(base + header->edgesOffset); }		// 2 vertex indices per edge
+
+	bool HasFaces() const { return header->facesOffset != 0; }
+	int GetNumFaces() const { return header->numFaces; }
+	const int* GetFaceStart() const { return (const int*)(base + header->facesOffset); }
+	const int* GetFaceVerts() const { return GetFaceStart() + header->numFaces + 1; }
+
+	bool HasCells() const { return header->cellsOffset != 0; }
+	int GetNumCells() const { return header->numCells; }
+	const int* GetCellStart() const { return (const int*)(base + header->cellsOffset); }
+	const int* GetCellVerts() const { return GetCellStart() + header->numCells + 1; }
+
+	// All of the above, for Polytope4D::Borrow(). The pointers are into the mapping.
+	void GetArrays(PolytopeArrays& arrays) const;
+
+private:
+	MappedPolytope(const MappedPolytope&);				// Not copyable: owns the mapping
+	MappedPolytope& operator=(const MappedPolytope&);
+
+	bool CheckCsrBlock(uint64_t offset, uint32_t numLists) const;
+
+	const unsigned char* base;
+	size_t size;
+	const PolytopeFileHeader* header;
+#if defined(_WIN32)
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+//
+// PolytopeTable.h
+//
+//   The built-in polytopes, as compile-time data: how each one is generated
+//   (see Coxeter4D.h and Wythoff4D.h), its final edge length, and how many
+//   vertices and edges it must come out with.
+//
+
+typedef struct {
+	const char* name;
+	bool regular;		// True: the Schlafli symbol {m01,m12,m23}. False: the Wythoff construction.
+	int m01, m12, m23;	// Coxeter diagram o-m01-o-m12-o-m23-o
+	int ringMask;		// Ringed nodes (bit i for node i), for the Wythoff construction
+	double edgeLength;	// Chosen so the larger ones are about as big as the dodecaplex
+	int numVerts;
+	int numEdges;
+} PolytopeInfo;
+
+constexpr PolytopeInfo polytopeTable[] = {
+	// name						regular	diagram		rings	edge	verts	edges
+	{ "4-simplex",				true,	3, 3, 3,	0x0,	1.0,	5,		10 },		// 5-cell
+	{ "tesseract",				true,	4, 3, 3,	0x0,	1.0,	16,		32 },		// 8-cell
+	{ "4-orthoplex",			true,	3, 3, 4,	0x0,	1.0,	8,		24 },		// 16-cell
+	{ "octaplex",				true,	3, 4, 3,	0x0,	1.0,	24,		96 },		// 24-cell
+	{ "dodecaplex",				true,	5, 3, 3,	0x0,	0.6,	600,	1200 },		// 120-cell
+	{ "tetraplex",				true,	3, 3, 5,	0x0,	1.0,	120,	720 },		// 600-cell
+	{ "rectified tesseract",	false,	4, 3, 3,	0x2,	1.0,	32,		96 },
+	{ "truncated tesseract",	false,	4, 3, 3,	0x3,	1.0,	64,		128 },
+	{ "runcinated tesseract",	false,	4, 3, 3,	0x9,	1.0,	64,		192 },
+	{ "cantellated 24-cell",	false,	3, 4, 3,	0x5,	0.8,	288,	864 },
+	{ "rectified 120-cell",		false,	5, 3, 3,	0x2,	0.5,	1200,	3600 },
+	{ "omnitruncated 120-cell",	false,	5, 3, 3,	0xf,	0.17,	14400,	28800 },
+};
+
+constexpr int numBuiltinPolytopes = sizeof(polytopeTable) / sizeof(polytopeTable[0]);
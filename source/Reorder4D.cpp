@@ -0,0 +1,213 @@
+//
+//  Reorder4D.cpp
+//
+//   Cache-friendly vertex and edge orders. See Reorder4D.h.
+//
+
+#include "Reorder4D.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+
+EdgeSpanStats GetEdgeSpanStats(const int* edges, int numEdges)
+{
+	EdgeSpanStats stats = { 0.0, 0, 0 };
+	if (numEdges <= 0) {
+		return stats;
+	}
+	std::vector<int> spans(numEdges);
+	double sum = 0.0;
+	for (int e = 0; e < numEdges; e++) {
+		spans[e] = abs(edges[2 * e] - edges[2 * e + 1]);
+		sum += spans[e];
+		stats.max = spans[e] > stats.max ? spans[e] : stats.max;
+	}
+	std::nth_element(spans.begin(), spans.begin() + numEdges / 2, spans.end());
+	stats.mean = sum / numEdges;
+	stats.median = spans[numEdges / 2];
+	return stats;
+}
+
+// **********************
+// The graph, as CSR adjacency lists, and the breadth first searches on it.
+// **********************
+class RcmGraph
+{
+public:
+	RcmGraph(int numVerts, const int* edges, int numEdges);
+
+	int GetDegree(int v) const { return start[v + 1] - start[v]; }
+
+	// Breadth first search from root over the vertices not yet numbered.
+	//    Returns the number of levels below the root, and the vertex of least degree
+	//    on the last level in farthest.
+	int Levels(int root, int& farthest);
+	// A vertex of the component of root at (nearly) the largest distance from
+	//    another: the start of the George-Liu search.
+	int PseudoPeripheral(int root);
+	// Numbers the components of the roots breadth first, each vertex's neighbors in order of degree.
+	void Number(const int* roots, int numRoots, std::vector<int>& order);
+
+	bool IsNumbered(int v) const { return numbered[v] != 0; }
+
+private:
+	std::vector<int> start;			// The neighbors of v are adj[start[v]] up to adj[start[v+1]-1]
+	std::vector<int> adj;
+	std::vector<char> numbered;
+	std::vector<int> visited;		// The search that last reached each vertex
+	std::vector<int> queue;
+	int search = 0;
+};
+
+RcmGraph::RcmGraph(int numVerts, const int* edges, int numEdges)
+	: start(numVerts + 1, 0), numbered(numVerts, 0), visited(numVerts, 0)
+{
+	for (int e = 0; e < numEdges; e++) {
+		if (edges[2 * e] != edges[2 * e + 1]) {
+			start[edges[2 * e] + 1]++;
+			start[edges[2 * e + 1] + 1]++;
+		}
+	}
+	for (int v = 0; v < numVerts; v++) {
+		start[v + 1] += start[v];
+	}
+	adj.resize(start[numVerts]);
+	std::vector<int> fill(start.begin(), start.end() - 1);
+	for (int e = 0; e < numEdges; e++) {
+		int a = edges[2 * e];
+		int b = edges[2 * e + 1];
+		if (a != b) {
+			adj[fill[a]++] = b;
+			adj[fill[b]++] = a;
+		}
+	}
+	// Drop repeated edges, then put each list in order of degree.
+	std::vector<int> degree(numVerts);
+	for (int v = 0; v < numVerts; v++) {
+		std::sort(adj.begin() + start[v], adj.begin() + start[v + 1]);
+		degree[v] = (int)(std::unique(adj.begin() + start[v], adj.begin() + start[v + 1]) - (adj.begin() + start[v]));
+	}
+	int numAdj = 0;
+	for (int v = 0; v < numVerts; v++) {
+		int first = start[v];
+		start[v] = numAdj;
+		for (int k = 0; k < degree[v]; k++) {
+			adj[numAdj++] = adj[first + k];
+		}
+	}
+	start[numVerts] = numAdj;
+	adj.resize(numAdj);
+	for (int v = 0; v < numVerts; v++) {
+		std::sort(adj.begin() + start[v], adj.begin() + start[v + 1],
+			[&degree](int a, int b) { return degree[a] < degree[b] || (degree[a] == degree[b] && a < b); });
+	}
+	queue.reserve(numVerts);
+}
+
+int RcmGraph::Levels(int root, int& farthest)
+{
+	search++;
+	queue.clear();
+	queue.push_back(root);
+	visited[root] = search;
+	int numLevels = 0;
+	size_t levelStart = 0;
+	while (true) {
+		size_t levelEnd = queue.size();
+		farthest = queue[levelStart];
+		for (size_t k = levelStart; k < levelEnd; k++) {
+			int v = queue[k];
+			farthest = GetDegree(v) < GetDegree(farthest) ? v : farthest;
+			for (int j = start[v]; j < start[v + 1]; j++) {
+				int u = adj[j];
+				if (visited[u] != search && !numbered[u]) {
+					visited[u] = search;
+					queue.push_back(u);
+				}
+			}
+		}
+		if (queue.size() == levelEnd) {
+			return numLevels;
+		}
+		levelStart = levelEnd;
+		numLevels++;
+	}
+}
+
+int RcmGraph::PseudoPeripheral(int root)
+{
+	int farthest;
+	int numLevels = Levels(root, farthest);
+	for (int iter = 0; iter < 16; iter++) {		// Rarely more than two or three
+		int next;
+		int nextLevels = Levels(farthest, next);
+		if (nextLevels <= numLevels) {
+			break;
+		}
+		root = farthest;
+		numLevels = nextLevels;
+		farthest = next;
+	}
+	return root;
+}
+
+void RcmGraph::Number(const int* roots, int numRoots, std::vector<int>& order)
+{
+	size_t first = order.size();
+	for (int k = 0; k < numRoots; k++) {
+		order.push_back(roots[k]);
+		numbered[roots[k]] = 1;
+	}
+	for (size_t k = first; k < order.size(); k++) {
+		int v = order[k];
+		for (int j = start[v]; j < start[v + 1]; j++) {
+			int u = adj[j];
+			if (!numbered[u]) {
+				numbered[u] = 1;
+				order.push_back(u);
+			}
+		}
+	}
+}
+
+void ReverseCuthillMcKee(int numVerts, const int* edges, int numEdges, std::vector<int>& order,
+	const char* isLast)
+{
+	RcmGraph graph(numVerts, edges, numEdges);
+	order.clear();
+	order.reserve(numVerts);
+	if (isLast != 0) {
+		std::vector<int> roots;
+		for (int v = 0; v < numVerts; v++) {
+			if (isLast[v]) {
+				roots.push_back(v);
+			}
+		}
+		std::sort(roots.begin(), roots.end(),
+			[&graph](int a, int b) { return graph.GetDegree(a) < graph.GetDegree(b) || (graph.GetDegree(a) == graph.GetDegree(b) && a < b); });
+		graph.Number(roots.data(), (int)roots.size(), order);
+	}
+	for (int v = 0; v < numVerts; v++) {
+		if (!graph.IsNumbered(v)) {
+			int root = graph.PseudoPeripheral(v);
+			graph.Number(&root, 1, order);
+		}
+	}
+	std::reverse(order.begin(), order.end());
+}
+
+void SortEdges(int* edges, int numEdges)
+{
+	// One 64-bit key per edge sorts faster than pairs of ints.
+	std::vector<uint64_t> keys(numEdges);
+	for (int e = 0; e < numEdges; e++) {
+		uint32_t a = (uint32_t)edges[2 * e];
+		uint32_t b = (uint32_t)edges[2 * e + 1];
+		keys[e] = a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+	}
+	std::sort(keys.begin(), keys.end());
+	for (int e = 0; e < numEdges; e++) {
+		edges[2 * e] = (int)(keys[e] >> 32);
+		edges[2 * e + 1] = (int)(keys[e] & 0xffffffffu);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+//
+// Reorder4D.h   ---  Header file for Reorder4D.cpp.
+//
+//   Vertex orders that keep the ends of each edge close together in memory.
+//   Rendering a polytope reads the two end vertices of every edge; if the
+//   vertices of an edge are far apart in the vertex arrays, nearly every edge
+//   misses the cache once the polytope no longer fits in it.
+//   The reverse Cuthill-McKee order numbers the vertices breadth first from a
+//   vertex at the edge of the skeleton, so that neighbors get nearby numbers.
+//   The edge span, |i - j| for an edge from vertex i to vertex j, measures how
+//   well an order does.
+//
+
+#include <vector>
+
+typedef struct {
+	double mean;				// Average edge span
+	int median;
+	int max;					// The bandwidth of the order
+} EdgeSpanStats;
+
+// The spans of the edges (2 vertex indices each).
+EdgeSpanStats GetEdgeSpanStats(const int* edges, int numEdges);
+
+// The reverse Cuthill-McKee order of the graph with the given edges (2 vertex
+//    indices each, in either order; loops and repeated edges are allowed).
+//    order[k] gets the vertex to put at position k. Each connected component
+//    is numbered as a block, starting from a pseudo-peripheral vertex.
+// If isLast is given, the vertices with isLast[v] nonzero are instead the first
+//    level of the search in their components, and so come last in the order.
+void ReverseCuthillMcKee(int numVerts, const int* edges, int numEdges, std::vector<int>& order,
+	const char* isLast = 0);
+
+// Puts the smaller vertex index first in each edge, and sorts the edges by
+//    their first and then their second vertex, so the edges are read in vertex order.
+void SortEdges(int* edges, int numEdges);
@@ -0,0 +1,262 @@
+//
+//  Rotate4D.cpp
+//
+//   SIMD rotation of 4D point sets, with run time selection of the kernel.
+//   See Rotate4D.h.
+//
+
+#include "Rotate4D.h"
+#include <math.h>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ROTATE4D_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define ROTATE4D_X86 0
+#endif
+
+typedef void(*Rotate4DKernel)(const float* M,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int start, int n,
+	float* outX, float* outY, float* outZ, float* outW);
+
+// Scalar kernel. Also used for the last few points left over by the SIMD kernels.
+// M is already multiplied by the scale factor.
+static void rotate4DScalar(const float* M,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int start, int n,
+	float* outX, float* outY, float* outZ, float* outW)
+{
+	for (int i = start; i < n; i++) {
+		float x = inX[i], y = inY[i], z = inZ[i], w = inW[i];
+		outX[i] = M[0] * x + M[4] * y + M[8] * z + M[12] * w;
+		outY[i] = M[1] * x + M[5] * y + M[9] * z + M[13] * w;
+		outZ[i] = M[2] * x + M[6] * y + M[10] * z + M[14] * w;
+		outW[i] = M[3] * x + M[7] * y + M[11] * z + M[15] * w;
+	}
+}
+
+#if ROTATE4D_X86
+static void rotate4DSSE2(const float* M,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int start, int n,
+	float* outX, float* outY, float* outZ, float* outW)
+{
+	__m128 m[16];
+	for (int k = 0; k < 16; k++) {
+		m[k] = _mm_set1_ps(M[k]);
+	}
+	int i = start;
+	for (; i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(inX + i);
+		__m128 y = _mm_loadu_ps(inY + i);
+		__m128 z = _mm_loadu_ps(inZ + i);
+		__m128 w = _mm_loadu_ps(inW + i);
+		for (int r = 0; r < 4; r++) {
+			__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[r], x), _mm_mul_ps(m[4 + r], y)),
+				_mm_add_ps(_mm_mul_ps(m[8 + r], z), _mm_mul_ps(m[12 + r], w)));
+			float* out = (r == 0) ? outX : (r == 1) ? outY : (r == 2) ? outZ : outW;
+			_mm_storeu_ps(out + i, t);
+		}
+	}
+	rotate4DScalar(M, inX, inY, inZ, inW, i, n, outX, outY, outZ, outW);
+}
+
+TARGET_AVX2
+static void rotate4DAVX2(const float* M,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int start, int n,
+	float* outX, float* outY, float* outZ, float* outW)
+{
+	__m256 m[16];
+	for (int k = 0; k < 16; k++) {
+		m[k] = _mm256_set1_ps(M[k]);
+	}
+	int i = start;
+	for (; i + 8 <= n; i += 8) {
+		__m256 x = _mm256_loadu_ps(inX + i);
+		__m256 y = _mm256_loadu_ps(inY + i);
+		__m256 z = _mm256_loadu_ps(inZ + i);
+		__m256 w = _mm256_loadu_ps(inW + i);
+		for (int r = 0; r < 4; r++) {
+			__m256 t = _mm256_mul_ps(m[r], x);
+			t = _mm256_fmadd_ps(m[4 + r], y, t);
+			t = _mm256_fmadd_ps(m[8 + r], z, t);
+			t = _mm256_fmadd_ps(m[12 + r], w, t);
+			float* out = (r == 0) ? outX : (r == 1) ? outY : (r == 2) ? outZ : outW;
+			_mm256_storeu_ps(out + i, t);
+		}
+	}
+	rotate4DSSE2(M, inX, inY, inZ, inW, i, n, outX, outY, outZ, outW);
+}
+
+// AVX2 and FMA must be supported by the CPU, and the OS must save the ymm registers.
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !fma || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif  // ROTATE4D_X86
+
+static Rotate4DKernel theKernel = 0;
+static const char* theKernelName = "scalar";
+
+static void selectKernel()
+{
+	theKernel = rotate4DScalar;
+#if ROTATE4D_X86
+	theKernel = rotate4DSSE2;			// Every x86-64 CPU has SSE2
+	theKernelName = "SSE2";
+	if (cpuHasAVX2()) {
+		theKernel = rotate4DAVX2;
+		theKernelName = "AVX2";
+	}
+#endif
+}
+
+void rotate4DSoA(const float* R, float scale,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int n,
+	float* outX, float* outY, float* outZ, float* outW)
+{
+	if (theKernel == 0) {
+		selectKernel();
+	}
+	float M[16];
+	for (int k = 0; k < 16; k++) {
+		M[k] = scale * R[k];
+	}
+	theKernel(M, inX, inY, inZ, inW, 0, n, outX, outY, outZ, outW);
+}
+
+const char* rotate4DKernelName()
+{
+	if (theKernel == 0) {
+		selectKernel();
+	}
+	return theKernelName;
+}
+
+// **********************
+// Polytopes with central symmetry
+// **********************
+
+// The vertices are sorted on their projection onto this direction: an antipode's
+//    projection is the negative. No coordinate is weighted alike, so that the many
+//    vertices with one coordinate equal still sort apart.
+static const double antipodeAxis[4] = { 1.0, 0.7548776662, 0.5698402910, 0.4301597090 };
+
+struct ProjectedVert {
+	double key;
+	int index;
+	bool operator<(const ProjectedVert& other) const { return key < other.key; }
+};
+
+int orderAntipodalPairs(const float* aosVerts, int nVerts, std::vector<int>& oldIndex)
+{
+	// Find the antipode of every vertex in O(n log n): the candidates for the antipode
+	//    of v are the vertices whose key is within tolerance of -key(v), and the nearest
+	//    of them to -v is taken if it is within tolerance in every coordinate.
+	double maxAbs = 0.0;
+	for (int i = 0; i < 4 * nVerts; i++) {
+		maxAbs = std::max(maxAbs, fabs((double)aosVerts[i]));
+	}
+	double tolerance = antipodeTolerance * maxAbs;
+	double keyTolerance = tolerance * (antipodeAxis[0] + antipodeAxis[1] + antipodeAxis[2] + antipodeAxis[3]);
+	std::vector<ProjectedVert> sorted(nVerts);
+	for (int i = 0; i < nVerts; i++) {
+		const float* v = aosVerts + 4 * i;
+		sorted[i].key = v[0] * antipodeAxis[0] + v[1] * antipodeAxis[1] + v[2] * antipodeAxis[2] + v[3] * antipodeAxis[3];
+		sorted[i].index = i;
+	}
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<int> antipode(nVerts, -1);
+	bool symmetric = (nVerts % 2 == 0 && maxAbs > 0.0);
+	for (int i = 0; i < nVerts && symmetric; i++) {
+		const float* v = aosVerts + 4 * sorted[i].index;
+		ProjectedVert lowest;
+		lowest.key = -sorted[i].key - keyTolerance;
+		double bestError = tolerance;
+		int best = -1;
+		for (std::vector<ProjectedVert>::iterator it = std::lower_bound(sorted.begin(), sorted.end(), lowest);
+			it != sorted.end() && it->key <= -sorted[i].key + keyTolerance; ++it) {
+			const float* u = aosVerts + 4 * it->index;
+			double error = 0.0;
+			for (int k = 0; k < 4; k++) {
+				error = std::max(error, fabs((double)u[k] + v[k]));
+			}
+			if (error <= bestError && it->index != sorted[i].index) {
+				bestError = error;
+				best = it->index;
+			}
+		}
+		if (best < 0) {
+			symmetric = false;		// No antipode (or the vertex is the origin)
+		}
+		else {
+			antipode[sorted[i].index] = best;
+		}
+	}
+	// The pairs must match up both ways, or some vertex would be mirrored twice.
+	for (int i = 0; i < nVerts && symmetric; i++) {
+		if (antipode[antipode[i]] != i) {
+			symmetric = false;
+		}
+	}
+
+	// New order: representatives first, then their antipodes in the reverse order.
+	oldIndex.resize(nVerts);
+	int numHalf = 0;
+	if (symmetric) {
+		std::vector<bool> placed(nVerts, false);
+		for (int i = 0; i < nVerts; i++) {
+			if (!placed[i]) {
+				oldIndex[numHalf] = i;
+				placed[i] = placed[antipode[i]] = true;
+				numHalf++;
+			}
+		}
+		for (int k = 0; k < numHalf; k++) {
+			oldIndex[nVerts - 1 - k] = antipode[oldIndex[k]];
+		}
+	}
+	else {
+		numHalf = nVerts;
+		for (int i = 0; i < nVerts; i++) {
+			oldIndex[i] = i;
+		}
+	}
+	return numHalf;
+}
+
+void rotate4DHalves(const float* R, float scale,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int n, int numHalf,
+	float* outX, float* outY, float* outZ, float* outW)
+{
+	rotate4DSoA(R, scale, inX, inY, inZ, inW, numHalf, outX, outY, outZ, outW);
+	// Central symmetry: the antipodes rotate to the negatives.
+	for (int k = 0; k < n - numHalf; k++) {
+		outX[n - 1 - k] = -outX[k];
+		outY[n - 1 - k] = -outY[k];
+		outZ[n - 1 - k] = -outZ[k];
+		outW[n - 1 - k] = -outW[k];
+	}
+}
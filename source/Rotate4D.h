@@ -0,0 +1,42 @@
+#pragma once
+
+//
+// Rotate4D.h   ---  Header file for Rotate4D.cpp.
+//
+//   Rotates large sets of 4D points by a single 4x4 matrix.
+//   The points are stored as separate x, y, z and w arrays ("structure of arrays")
+//   so the kernel can process 4 (SSE2) or 8 (AVX2) points per instruction.
+//   The widest kernel supported by the CPU is chosen at run time.
+//
+
+#include <vector>
+
+// Computes out = scale * R * in for n points. R is a 4x4 matrix stored by columns
+// (as from composeRotation4D() or LinearMapR4::DumpByColumns()).
+// Any n is allowed; the in and out arrays must not overlap.
+void rotate4DSoA(const float* R, float scale,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int n,
+	float* outX, float* outY, float* outZ, float* outW);
+
+// Name of the kernel selected for this CPU ("AVX2", "SSE2" or "scalar").
+const char* rotate4DKernelName();
+
+// The order in which to store a polytope's vertices for rotate4DHalves().
+// If the polytope is centrally symmetric, the vertices are reordered so that
+//    entry numVerts - 1 - i is the antipode of entry i: the second half mirrors
+//    the first, so vertices close together in the first half have antipodes close
+//    together in the second. Since R(-v) = -R(v), only the first numHalf vertices
+//    then need to be rotated.
+// aosVerts holds 4 floats per vertex. oldIndex[k] gets the vertex to store at
+//    position k. Returns numHalf, which is numVerts if there is no central symmetry.
+int orderAntipodalPairs(const float* aosVerts, int numVerts, std::vector<int>& oldIndex);
+
+// Vertices are matched with their antipodes to within this fraction of the largest
+//    coordinate, since coordinates computed as x and -x need not be exact negatives.
+const double antipodeTolerance = 1.0e-4;
+
+// rotate4DSoA() for the first numHalf of the n points; point n - 1 - k
+//    of the output is the negative of point k.
+void rotate4DHalves(const float* R, float scale,
+	const float* inX, const float* inY, const float* inZ, const float* inW, int n, int numHalf,
+	float* outX, float* outY, float* outZ, float* outW);
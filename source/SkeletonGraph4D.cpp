@@ -0,0 +1,430 @@
+//
+//  SkeletonGraph4D.cpp
+//
+//   Graph queries on the skeleton of a polytope. See SkeletonGraph4D.h.
+//
+
+#include "SkeletonGraph4D.h"
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Steps with less work than this are done on the calling thread.
+static const int MinParallelWork = 8192;
+
+// **********************
+// Runs work(first, last, t) for ranges of [0, count), each on its own thread t.
+// Returns the number of threads used. Small counts are done on the calling thread.
+// **********************
+template <class Work>
+static int RunInParallel(int count, Work work)
+{
+	int numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads < 1 || count < MinParallelWork) {
+		numThreads = 1;
+	}
+	if (numThreads == 1) {
+		work(0, count, 0);
+		return 1;
+	}
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++) {
+		int first = (int)((long long)count * t / numThreads);
+		int last = (int)((long long)count * (t + 1) / numThreads);
+		threads.push_back(std::thread(work, first, last, t));
+	}
+	for (size_t t = 0; t < threads.size(); t++) {
+		threads[t].join();
+	}
+	return numThreads;
+}
+
+// Appends the per-thread lists to list, in thread order, and empties them.
+static void GatherLists(std::vector<std::vector<int> >& threadLists, int numThreads, std::vector<int>& list)
+{
+	for (int t = 0; t < numThreads; t++) {
+		list.insert(list.end(), threadLists[t].begin(), threadLists[t].end());
+		threadLists[t].clear();
+	}
+}
+
+// A well mixed 32-bit hash, for the coloring ranks.
+static uint32_t HashRank(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+void SkeletonGraph4D::Build(int numVerts, const int* edges, int numEdges)
+{
+	edgeEnds.assign(edges, edges + 2 * numEdges);
+	start.assign(numVerts + 1, 0);
+	for (int e = 0; e < numEdges; e++) {
+		if (edges[2 * e] != edges[2 * e + 1]) {
+			start[edges[2 * e] + 1]++;
+			start[edges[2 * e + 1] + 1]++;
+		}
+	}
+	for (int v = 0; v < numVerts; v++) {
+		start[v + 1] += start[v];
+	}
+	// Each adjacency entry is (neighbor, edge) packed in 64 bits, so sorting drops repeats.
+	std::vector<uint64_t> entries(start[numVerts]);
+	std::vector<int> fill(start.begin(), start.end() - 1);
+	for (int e = 0; e < numEdges; e++) {
+		int a = edges[2 * e];
+		int b = edges[2 * e + 1];
+		if (a != b) {
+			entries[fill[a]++] = (uint64_t)(uint32_t)b << 32 | (uint32_t)e;
+			entries[fill[b]++] = (uint64_t)(uint32_t)a << 32 | (uint32_t)e;
+		}
+	}
+	std::vector<int> degree(numVerts);
+	RunInParallel(numVerts, [&](int first, int last, int /*t*/) {
+		for (int v = first; v < last; v++) {
+			uint64_t* list = entries.data() + start[v];
+			int n = start[v + 1] - start[v];
+			std::sort(list, list + n);
+			int kept = 0;
+			for (int k = 0; k < n; k++) {
+				if (kept == 0 || (list[k] >> 32) != (list[kept - 1] >> 32)) {
+					list[kept++] = list[k];
+				}
+			}
+			degree[v] = kept;
+		}
+	});
+	adj.resize(start[numVerts]);
+	adjEdge.resize(start[numVerts]);
+	int numAdj = 0;
+	maxDegree = 0;
+	for (int v = 0; v < numVerts; v++) {
+		int first = start[v];
+		start[v] = numAdj;
+		for (int k = 0; k < degree[v]; k++) {
+			adj[numAdj] = (int)(entries[first + k] >> 32);
+			adjEdge[numAdj] = (int)(entries[first + k] & 0xffffffffu);
+			numAdj++;
+		}
+		maxDegree = std::max(maxDegree, degree[v]);
+	}
+	start[numVerts] = numAdj;
+	adj.resize(numAdj);
+	adjEdge.resize(numAdj);
+}
+
+// Level by level. A top-down step looks at the neighbors of the frontier, and
+//    claims the unvisited ones with an atomic exchange when it is split among threads.
+//    A bottom-up step has each unvisited vertex look for a neighbor in the frontier,
+//    and stops at the first: it needs no atomics, and once the frontier is a large part
+//    of the graph it looks at far fewer edges. The switches are those of Beamer,
+//    Asanovic and Patterson's direction-optimizing search.
+int SkeletonGraph4D::Distances(int source, std::vector<int>& dist) const
+{
+	int numVerts = GetNumVerts();
+	dist.assign(numVerts, -1);
+	if (source < 0 || source >= numVerts) {
+		return -1;
+	}
+	std::vector<std::atomic<unsigned char> > visited(numVerts);
+	std::vector<unsigned char> inFrontier;			// Only for the bottom-up steps
+	std::vector<std::vector<int> > threadNext(std::thread::hardware_concurrency() + 1);
+	std::vector<int> frontier(1, source);
+	std::vector<int> next;
+	dist[source] = 0;
+	visited[source].store(1, std::memory_order_relaxed);
+	long long unexploredEdges = (long long)adj.size();
+	bool bottomUp = false;
+	int level = 0;
+	while (!frontier.empty()) {
+		long long frontierEdges = 0;
+		for (size_t k = 0; k < frontier.size(); k++) {
+			frontierEdges += GetDegree(frontier[k]);
+		}
+		unexploredEdges -= frontierEdges;
+		if (!bottomUp && frontierEdges > unexploredEdges / 14) {
+			bottomUp = true;
+		}
+		else if (bottomUp && (long long)frontier.size() < numVerts / 24) {
+			bottomUp = false;
+		}
+
+		int numThreads;
+		if (bottomUp) {
+			inFrontier.resize(numVerts, 0);
+			for (size_t k = 0; k < frontier.size(); k++) {
+				inFrontier[frontier[k]] = 1;
+			}
+			numThreads = RunInParallel(numVerts, [&](int first, int last, int t) {
+				for (int v = first; v < last; v++) {
+					if (visited[v].load(std::memory_order_relaxed) == 0) {
+						for (int j = start[v]; j < start[v + 1]; j++) {
+							if (inFrontier[adj[j]]) {
+								visited[v].store(1, std::memory_order_relaxed);
+								dist[v] = level + 1;
+								threadNext[t].push_back(v);
+								break;
+							}
+						}
+					}
+				}
+			});
+			for (size_t k = 0; k < frontier.size(); k++) {
+				inFrontier[frontier[k]] = 0;
+			}
+		}
+		else {
+			int count = frontierEdges < MinParallelWork ? 0 : (int)frontier.size();
+			numThreads = RunInParallel(count, [&](int first, int last, int t) {
+				for (int k = first; k < last; k++) {
+					int v = frontier[k];
+					for (int j = start[v]; j < start[v + 1]; j++) {
+						int u = adj[j];
+						if (visited[u].load(std::memory_order_relaxed) == 0
+								&& visited[u].exchange(1, std::memory_order_relaxed) == 0) {
+							dist[u] = level + 1;
+							threadNext[t].push_back(u);
+						}
+					}
+				}
+			});
+			if (count == 0) {
+				for (size_t k = 0; k < frontier.size(); k++) {
+					int v = frontier[k];
+					for (int j = start[v]; j < start[v + 1]; j++) {
+						int u = adj[j];
+						if (visited[u].load(std::memory_order_relaxed) == 0) {
+							visited[u].store(1, std::memory_order_relaxed);
+							dist[u] = level + 1;
+							threadNext[0].push_back(u);
+						}
+					}
+				}
+			}
+		}
+		next.clear();
+		GatherLists(threadNext, numThreads, next);
+		frontier.swap(next);
+		level++;
+	}
+	return level - 1;
+}
+
+void SkeletonGraph4D::Shells(const std::vector<int>& dist, std::vector<int>& shellSizes)
+{
+	shellSizes.clear();
+	for (size_t v = 0; v < dist.size(); v++) {
+		if (dist[v] >= 0) {
+			if (dist[v] >= (int)shellSizes.size()) {
+				shellSizes.resize(dist[v] + 1, 0);
+			}
+			shellSizes[dist[v]]++;
+		}
+	}
+}
+
+// **********************
+// Jones-Plassmann coloring of the items in items (vertices or edges), numbered below numItems.
+// neighbors(i, visit) calls visit(j) for the neighbors j of item i. rank[i] orders
+//    the items; ties go to the larger number.
+// An item is colored once all its higher ranked neighbors are: with the smallest
+//    color they leave free. So its color depends only on theirs, and not on the
+//    order the threads get to it. Each item counts the higher neighbors it waits for;
+//    the items colored in one round release the next round's, and no item is looked
+//    at twice. The items of a round are never neighbors, so coloring them in parallel
+//    only reads colors that were written in earlier rounds.
+// **********************
+template <class Neighbors>
+static int JonesPlassmann(int numItems, const std::vector<int>& items, const std::vector<uint64_t>& rank,
+	int maxColors, Neighbors neighbors, std::vector<int>& colors)
+{
+	int maxThreads = (int)std::thread::hardware_concurrency() + 1;
+	std::vector<std::atomic<int> > waiting(numItems);
+	std::vector<std::vector<int> > threadReady(maxThreads);
+	std::vector<int> ready;
+	int numThreads = RunInParallel((int)items.size(), [&](int first, int last, int t) {
+		for (int k = first; k < last; k++) {
+			int i = items[k];
+			int higher = 0;
+			neighbors(i, [&](int j) {
+				higher += (rank[j] > rank[i] || (rank[j] == rank[i] && j > i)) ? 1 : 0;
+			});
+			waiting[i].store(higher, std::memory_order_relaxed);
+			if (higher == 0) {
+				threadReady[t].push_back(i);
+			}
+		}
+	});
+	GatherLists(threadReady, numThreads, ready);
+
+	std::vector<std::vector<unsigned char> > threadUsed(maxThreads, std::vector<unsigned char>(maxColors + 1, 0));
+	std::vector<int> threadMaxColor(maxThreads, -1);
+	while (!ready.empty()) {
+		numThreads = RunInParallel((int)ready.size(), [&](int first, int last, int t) {
+			std::vector<unsigned char>& used = threadUsed[t];
+			for (int k = first; k < last; k++) {
+				int i = ready[k];
+				neighbors(i, [&](int j) {
+					if (colors[j] >= 0) {
+						used[colors[j]] = 1;
+					}
+				});
+				int c = 0;
+				while (used[c]) {
+					c++;
+				}
+				colors[i] = c;
+				threadMaxColor[t] = std::max(threadMaxColor[t], c);
+				neighbors(i, [&](int j) {
+					if (colors[j] >= 0) {
+						used[colors[j]] = 0;
+					}
+					else if (waiting[j].fetch_sub(1, std::memory_order_relaxed) == 1) {
+						threadReady[t].push_back(j);
+					}
+				});
+			}
+		});
+		ready.clear();
+		GatherLists(threadReady, numThreads, ready);
+		std::sort(ready.begin(), ready.end());		// Neighbors are mostly numbered close together (see Reorder4D.h)
+	}
+	return *std::max_element(threadMaxColor.begin(), threadMaxColor.end()) + 1;
+}
+
+// Largest degree first, then by hash: fewer colors than a random order on irregular graphs.
+int SkeletonGraph4D::ColorVertices(std::vector<int>& colors) const
+{
+	int numVerts = GetNumVerts();
+	colors.assign(numVerts, -1);
+	std::vector<int> items(numVerts);
+	std::vector<uint64_t> rank(numVerts);
+	for (int v = 0; v < numVerts; v++) {
+		items[v] = v;
+		rank[v] = (uint64_t)GetDegree(v) << 32 | HashRank((uint32_t)v);
+	}
+	return JonesPlassmann(numVerts, items, rank, maxDegree + 1,
+		[this](int v, auto visit) {
+			for (int j = start[v]; j < start[v + 1]; j++) {
+				visit(adj[j]);
+			}
+		},
+		colors);
+}
+
+// The edges that meet edge e are those at either of its ends.
+int SkeletonGraph4D::ColorEdges(std::vector<int>& colors) const
+{
+	int numEdges = GetNumEdges();
+	colors.assign(numEdges, -1);
+	std::vector<uint64_t> rank(numEdges, 0);
+	std::vector<unsigned char> kept(numEdges, 0);
+	for (size_t k = 0; k < adjEdge.size(); k++) {
+		kept[adjEdge[k]] = 1;
+	}
+	std::vector<int> items;
+	items.reserve(numEdges);
+	for (int e = 0; e < numEdges; e++) {
+		if (kept[e]) {
+			items.push_back(e);
+			int lineDegree = GetDegree(edgeEnds[2 * e]) + GetDegree(edgeEnds[2 * e + 1]);
+			rank[e] = (uint64_t)lineDegree << 32 | HashRank((uint32_t)e);
+		}
+	}
+	return JonesPlassmann(numEdges, items, rank, 2 * maxDegree,
+		[this](int e, auto visit) {
+			for (int end = 0; end < 2; end++) {
+				int v = edgeEnds[2 * e + end];
+				for (int j = start[v]; j < start[v + 1]; j++) {
+					if (adjEdge[j] != e) {
+						visit(adjEdge[j]);
+					}
+				}
+			}
+		},
+		colors);
+}
+
+// A vertex at the largest distance in dist (the lowest numbered, if several).
+static int Farthest(const std::vector<int>& dist)
+{
+	int far = 0;
+	for (int v = 1; v < (int)dist.size(); v++) {
+		far = dist[v] > dist[far] ? v : far;
+	}
+	return far;
+}
+
+// Takuya Akiba's 4-sweep picks the central vertex u: the middle of a long path found
+//    by two searches. Then, with F_i the vertices at distance i from u, any two
+//    vertices within distance i-1 of u are at most 2(i-1) apart, so once the
+//    eccentricities of F_ecc(u) ... F_i are all known and one reaches 2(i-1),
+//    it is the diameter (Crescenzi et al.'s iFUB).
+int SkeletonGraph4D::Diameter(int source, int maxSearches, bool& exact) const
+{
+	exact = false;
+	std::vector<int> dist;
+	std::vector<int> distA;
+	if (Distances(source, dist) < 0) {
+		return 0;
+	}
+	int lower = 0;
+	int u = source;
+	for (int sweep = 0; sweep < 2; sweep++) {
+		int a = Farthest(dist);
+		lower = std::max(lower, Distances(a, distA));
+		int b = Farthest(distA);
+		lower = std::max(lower, Distances(b, dist));
+		int length = distA[b];
+		for (int v = 0; v < (int)dist.size(); v++) {
+			if (distA[v] == length / 2 && dist[v] == length - length / 2) {
+				u = v;
+				break;
+			}
+		}
+		Distances(u, dist);
+	}
+	int searches = 7;
+	int eccU = *std::max_element(dist.begin(), dist.end());
+	lower = std::max(lower, eccU);
+
+	// The fringes F_i, as a CSR list by distance.
+	std::vector<int> levelStart(eccU + 2, 0);
+	for (int v = 0; v < (int)dist.size(); v++) {
+		if (dist[v] >= 0) {
+			levelStart[dist[v] + 1]++;
+		}
+	}
+	for (int i = 0; i <= eccU; i++) {
+		levelStart[i + 1] += levelStart[i];
+	}
+	std::vector<int> levelVerts(levelStart[eccU + 1]);
+	std::vector<int> fill(levelStart.begin(), levelStart.end() - 1);
+	for (int v = 0; v < (int)dist.size(); v++) {
+		if (dist[v] >= 0) {
+			levelVerts[fill[dist[v]]++] = v;
+		}
+	}
+	for (int i = eccU; i >= 1; i--) {
+		if (lower >= 2 * i) {
+			break;
+		}
+		for (int k = levelStart[i]; k < levelStart[i + 1]; k++) {
+			if (searches >= maxSearches) {
+				return lower;
+			}
+			lower = std::max(lower, Distances(levelVerts[k], distA));
+			searches++;
+		}
+		if (lower >= 2 * (i - 1)) {
+			break;
+		}
+	}
+	exact = true;
+	return lower;
+}
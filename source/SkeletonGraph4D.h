@@ -0,0 +1,62 @@
+#pragma once
+
+//
+// SkeletonGraph4D.h   ---  Header file for SkeletonGraph4D.cpp.
+//
+//   The skeleton of a polytope (its vertices and edges) as a graph, in CSR form:
+//   the neighbors of each vertex, and the edges to them, are one contiguous run.
+//   It is built once per polytope, and answers the queries of the viewer:
+//      Distances    breadth first search from a vertex: the graph distance of every
+//                   vertex, and so the geodesic shells (the vertices at distance k)
+//      Coloring     proper vertex and edge colorings (no two neighbors the same)
+//      Diameter     the largest distance between two vertices
+//   The searches switch between a top-down step (from the frontier) and a
+//   bottom-up step (from the unvisited vertices) as the frontier grows and shrinks,
+//   and large steps are split among threads. The colorings are Jones-Plassmann:
+//   in each round, every vertex that outranks its uncolored neighbors takes the
+//   smallest color they leave free, all in parallel. Ranks come from a hash, so
+//   the results do not depend on the number of threads.
+//
+
+#include <vector>
+
+class SkeletonGraph4D
+{
+public:
+	// Builds the graph from edges (2 vertex indices each). The edges keep their numbers,
+	//    but loops and repeats of an edge are left out of the adjacency lists.
+	void Build(int numVerts, const int* edges, int numEdges);
+
+	int GetNumVerts() const { return (int)start.size() - 1; }
+	int GetNumEdges() const { return (int)edgeEnds.size() / 2; }
+	int GetDegree(int v) const { return start[v + 1] - start[v]; }
+	int GetMaxDegree() const { return maxDegree; }
+	const int* GetNeighbors(int v) const { return adj.data() + start[v]; }			// In increasing order
+	const int* GetNeighborEdges(int v) const { return adjEdge.data() + start[v]; }	// The edge to each neighbor
+	const int* GetEdgeEnds(int e) const { return edgeEnds.data() + 2 * e; }
+
+	// Graph distance of every vertex from source (-1 if it cannot be reached).
+	// Returns the eccentricity of source: the largest distance.
+	int Distances(int source, std::vector<int>& dist) const;
+
+	// The number of vertices at each distance (from the output of Distances()).
+	static void Shells(const std::vector<int>& dist, std::vector<int>& shellSizes);
+
+	// A proper coloring of the vertices, or of the edges (numbered as in Build(); the edges
+	//    left out get color -1).
+	// Returns the number of colors used: at most GetMaxDegree()+1, or 2*GetMaxDegree()-1 for edges.
+	int ColorVertices(std::vector<int>& colors) const;
+	int ColorEdges(std::vector<int>& colors) const;
+
+	// The diameter of the component of source, by iFUB: searches from the vertices
+	//    farthest from a central vertex, until no other vertex can be farther apart.
+	//    After maxSearches searches it gives up, and returns a lower bound with exact false.
+	int Diameter(int source, int maxSearches, bool& exact) const;
+
+private:
+	std::vector<int> start;			// The neighbors of v are adj[start[v]] up to adj[start[v+1]-1]
+	std::vector<int> adj;
+	std::vector<int> adjEdge;		// The edge from v to adj[k], for each k
+	std::vector<int> edgeEnds;		// The edges, 2 vertex indices each
+	int maxDegree = 0;
+};
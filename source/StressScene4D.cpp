@@ -0,0 +1,172 @@
+//
+//  StressScene4D.cpp
+//
+//   Parametric stress scenes on the 3-sphere. See StressScene4D.h.
+//
+
+#include "StressScene4D.h"
+#include "EdgeFinder4D.h"
+#include <math.h>
+#include <random>
+
+static const double Pi = 3.14159265358979323846;
+
+// Every scene has about size vertices, split as evenly as its shape allows.
+bool StressScene4D::Generate(int kind, int size)
+{
+	size = size < 16 ? 16 : (size > StressSceneMaxSize ? StressSceneMaxSize : size);
+	int side = (int)(sqrt((double)size) + 0.5);
+	switch (kind) {
+	case ssDuoprism:
+		return GenerateDuoprism(side, size / side);
+	case ssCliffordTorus:
+		return GenerateCliffordTorus(side, size / side);
+	case ssHopfFibration:
+		return GenerateHopfFibration(side, size / side);
+	case ssRandomS3:
+		return GenerateRandomS3(size, 1);
+	}
+	Clear();
+	return false;
+}
+
+const char* StressScene4D::GetName(int kind)
+{
+	static const char* names[numStressScenes] = { "duoprism", "Clifford torus", "Hopf fibration", "random points on S^3" };
+	return (kind >= 0 && kind < numStressScenes) ? names[kind] : "unknown stress scene";
+}
+
+// The vertices are (r1 cos a, r1 sin a, r2 cos b, r2 sin b) for a = 2*pi*i/p, b = 2*pi*j/q.
+//    The radii are chosen so all the edges have the same length, as in the uniform duoprism.
+bool StressScene4D::GenerateDuoprism(int p, int q)
+{
+	Clear();
+	if (p < 3 || q < 3) {
+		return false;
+	}
+	double r1 = 1.0 / sin(Pi / p);
+	double r2 = 1.0 / sin(Pi / q);
+	double scale = StressSceneRadius / sqrt(r1 * r1 + r2 * r2);
+	r1 *= scale;
+	r2 *= scale;
+	verts.resize(4 * (size_t)p * q);
+	edges.reserve(4 * (size_t)p * q);
+	for (int i = 0; i < p; i++) {
+		double a = 2.0 * Pi * i / p;
+		for (int j = 0; j < q; j++) {
+			double b = 2.0 * Pi * j / q;
+			float* v = &verts[4 * ((size_t)i * q + j)];
+			v[0] = (float)(r1 * cos(a));
+			v[1] = (float)(r1 * sin(a));
+			v[2] = (float)(r2 * cos(b));
+			v[3] = (float)(r2 * sin(b));
+			AddEdge(i * q + j, ((i + 1) % p) * q + j);		// Around the p-gon
+			AddEdge(i * q + j, i * q + (j + 1) % q);		// Around the q-gon
+		}
+	}
+	return true;
+}
+
+// The flat torus |z1| = |z2| on the 3-sphere, sampled on an m by n grid.
+//    Each grid square is split along a diagonal, so every vertex has six edges.
+bool StressScene4D::GenerateCliffordTorus(int m, int n)
+{
+	Clear();
+	if (m < 3 || n < 3) {
+		return false;
+	}
+	double r = StressSceneRadius / sqrt(2.0);
+	verts.resize(4 * (size_t)m * n);
+	edges.reserve(6 * (size_t)m * n);
+	for (int i = 0; i < m; i++) {
+		double a = 2.0 * Pi * i / m;
+		int iNext = (i + 1) % m;
+		for (int j = 0; j < n; j++) {
+			double b = 2.0 * Pi * j / n;
+			int jNext = (j + 1) % n;
+			float* v = &verts[4 * ((size_t)i * n + j)];
+			v[0] = (float)(r * cos(a));
+			v[1] = (float)(r * sin(a));
+			v[2] = (float)(r * cos(b));
+			v[3] = (float)(r * sin(b));
+			AddEdge(i * n + j, iNext * n + j);
+			AddEdge(i * n + j, i * n + jNext);
+			AddEdge(i * n + j, iNext * n + jNext);
+		}
+	}
+	return true;
+}
+
+// The fiber over the point (x, y, z) of S^2 is the great circle of points
+//    (z1, z2) = e^(it) (sqrt((1+z)/2), (x - iy)/sqrt(2(1+z))), which the Hopf map
+//    (2 z1 conj(z2), |z1|^2 - |z2|^2) takes to (x, y, z). The base points are a
+//    Fibonacci spiral on S^2; it never reaches z = -1, where this formula fails.
+bool StressScene4D::GenerateHopfFibration(int numFibers, int fiberSize)
+{
+	Clear();
+	if (numFibers < 1 || fiberSize < 3) {
+		return false;
+	}
+	const double goldenAngle = Pi * (3.0 - sqrt(5.0));
+	verts.resize(4 * (size_t)numFibers * fiberSize);
+	edges.reserve(2 * (size_t)numFibers * fiberSize);
+	for (int f = 0; f < numFibers; f++) {
+		double z = 1.0 - (2.0 * f + 1.0) / numFibers;
+		double rho = sqrt(1.0 - z * z);
+		double x = rho * cos(goldenAngle * f);
+		double y = rho * sin(goldenAngle * f);
+		double s1 = sqrt(0.5 * (1.0 + z));
+		double s2 = 1.0 / sqrt(2.0 * (1.0 + z));
+		int first = f * fiberSize;
+		for (int k = 0; k < fiberSize; k++) {
+			double t = 2.0 * Pi * k / fiberSize;
+			double c = cos(t);
+			double s = sin(t);
+			float* v = &verts[4 * ((size_t)first + k)];
+			v[0] = (float)(StressSceneRadius * s1 * c);
+			v[1] = (float)(StressSceneRadius * s1 * s);
+			v[2] = (float)(StressSceneRadius * s2 * (x * c + y * s));		// (x - iy) e^(it)
+			v[3] = (float)(StressSceneRadius * s2 * (x * s - y * c));
+			AddEdge(first + k, first + (k + 1) % fiberSize);
+		}
+	}
+	return true;
+}
+
+// Normalized Gaussian 4-vectors are uniform on S^3. The Gaussians come from the
+//    Box-Muller transform of mt19937 output, which (unlike std::normal_distribution)
+//    is the same with every compiler.
+// A ball of radius r around a point covers (4/3)pi r^3 of the sphere's 2 pi^2 R^3,
+//    so r = R (6 pi / numPoints)^(1/3) gives each point about four neighbors.
+bool StressScene4D::GenerateRandomS3(int numPoints, unsigned int seed)
+{
+	Clear();
+	if (numPoints < 2) {
+		return false;
+	}
+	std::mt19937 generator(seed);
+	verts.resize(4 * (size_t)numPoints);
+	for (int i = 0; i < numPoints; i++) {
+		double g[4];
+		double lenSq = 0.0;
+		do {
+			for (int k = 0; k < 4; k += 2) {
+				double u1 = ((double)generator() + 0.5) / 4294967296.0;		// In (0, 1)
+				double u2 = ((double)generator() + 0.5) / 4294967296.0;
+				double radius = sqrt(-2.0 * log(u1));
+				g[k] = radius * cos(2.0 * Pi * u2);
+				g[k + 1] = radius * sin(2.0 * Pi * u2);
+			}
+			lenSq = g[0] * g[0] + g[1] * g[1] + g[2] * g[2] + g[3] * g[3];
+		} while (lenSq < 1.0e-12);
+		double scale = StressSceneRadius / sqrt(lenSq);
+		for (int k = 0; k < 4; k++) {
+			verts[4 * i + k] = (float)(scale * g[k]);
+		}
+	}
+
+	// All the pairs closer than r: FindEdges4D's band around r/2, of half-width r/2.
+	double r = StressSceneRadius * cbrt(6.0 * Pi / numPoints);
+	FindEdges4D(verts.data(), numPoints, edges, 0.5 * r, 1.0);
+	return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+//
+// StressScene4D.h   ---  Header file for StressScene4D.cpp.
+//
+//   Parametric 4D vertex and edge sets, for loads from a few hundred up to
+//   millions of elements. They come out in the same form as the built-in
+//   polytopes (4 floats per vertex, 2 vertex indices per edge), all on the
+//   3-sphere of radius StressSceneRadius, and are reproducible: the same
+//   kind and size always give the same scene.
+//      Duoprism         {p}x{q}: p*q vertices, 2*p*q edges
+//      Clifford torus   an m by n grid on the flat torus in S^3, triangulated: 3*m*n edges
+//      Hopf fibration   great circles over points spread evenly on S^2, one edge per vertex
+//      Random S^3       uniform random points, joined to the points within a
+//                       distance that gives about four neighbors each
+//
+
+#include <vector>
+
+const int ssDuoprism = 0;
+const int ssCliffordTorus = 1;
+const int ssHopfFibration = 2;
+const int ssRandomS3 = 3;
+const int numStressScenes = 4;
+
+const int StressSceneMaxSize = 1000000;		// The most vertices Generate() makes
+const double StressSceneRadius = 2.0;		// About the size of the 120-cell in PolytopeTable.h
+
+class StressScene4D
+{
+public:
+	// Builds a scene of the given kind (ssDuoprism, ...) with about size vertices
+	//    (from 16 to StressSceneMaxSize), picking the parameters of the functions below.
+	bool Generate(int kind, int size);
+
+	// These return false (and leave the scene empty) if the parameters are too small.
+	bool GenerateDuoprism(int p, int q);
+	bool GenerateCliffordTorus(int m, int n);
+	bool GenerateHopfFibration(int numFibers, int fiberSize);
+	bool GenerateRandomS3(int numPoints, unsigned int seed);
+
+	static const char* GetName(int kind);
+
+	int GetNumVerts() const { return (int)verts.size() / 4; }
+	const float* GetVerts() const { return verts.data(); }		// 4 floats per vertex
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge
+
+private:
+	void Clear() { verts.clear(); edges.clear(); }
+	void AddEdge(int a, int b) { edges.push_back(a); edges.push_back(b); }
+
+	std::vector<float> verts;
+	std::vector<int> edges;
+};
@@ -36,6 +36,7 @@
 #include "EduPhong.h"
 #include "PhongData.h"
 #include "GlShaderMgr.h"
+#include "GlStateCache.h"
 #include "GlGeomSphere.h"
 #include "GlGeomCylinder.h"
 // #include "GlGeomTorus.h"
@@ -43,9 +44,11 @@
 // Enable standard input and output via printf(), etc.
 // Put this include *after* the includes for glew and GLFW!
 #include <stdio.h>
+#include <string.h>
 
 #include "TextureProj.h"
 #include "MyGeometries.h"
+#include "StressScene4D.h"
 
 
 
@@ -70,6 +73,13 @@ bool cullBackFaces = true;
 bool vertsOnly = false;
 bool polytopeOnly = true;
 
+int renderPath = rpInstanced;
+const char* renderPathNames[nRenderPaths] = { "per-object", "instanced", "GPU-rotated", "multi-draw-indirect", "ray-cast impostors", "wireframe lines and points" };
+
+int skeletonColoring = scNone;
+int skeletonSource = 0;
+const char* skeletonColoringNames[nSkeletonColorings] = { "off", "graph distance", "vertex coloring", "edge coloring" };
+
 // The next variable controls the resolution of the meshes for cylinders and spheres.
 int meshRes=4;             // Resolution of the meshes (slices, stacks, and rings all equal)
 
@@ -86,10 +96,15 @@ float thetaTimeFactors[] = { 0.2f, 0.2f, 0.2f, 0.2f, 0.2f, 0.2f };
 double textureTimeAnimateIncrement = 0.001;
 double textureTime = 0.0;
 int mode = 0;
-const int nPolytopes = 6;
+int stressSceneSize = 10000;        // Number of vertices of the stress scenes (the modes after the built-in polytopes)
 bool singleStep = false;
 bool tSpinMode = true;
 
+bool morphMode = false;             // Whether the polytope is morphing through its truncations (see WythoffMorph4D)
+bool morphSpinMode = true;          // Whether the morph is running
+double morphPosition = 0.0;         // From 0 to 3: the polytope with node 0, 1, 2 or 3 of its diagram ringed, and in between
+double morphIncrement = 0.005;      // Change in morphPosition per frame
+
 int tKey = 0;
 
 // ************************
@@ -99,6 +114,12 @@ int tKey = 0;
 
 unsigned int shaderProgramBitmap;       // The shader program that applies a bitmapped texture map (from a file)
 unsigned int shaderProgramProc ;       // The shader program that applies a procedural texture map
+unsigned int shaderProgramInstanced;   // The bitmap shader program, with a per-instance model matrix
+unsigned int shaderProgramGpu;         // The bitmap shader program, placing the polytope's spheres and cylinders itself
+unsigned int shaderProgramIndirect = 0;    // Draws the whole scene with per-object data from a storage buffer
+unsigned int shaderProgramImpostor;    // Ray-casts the polytope's spheres and cylinders on proxy quads and boxes
+unsigned int shaderProgramWireLines;   // Unshaded edges, widened into screen-space quads by a geometry shader
+unsigned int shaderProgramWirePoints;  // Unshaded vertices, as round point sprites
 
 unsigned int modelviewMatLocation;					// Location of the modelviewMatrix in the currently active shader program
 unsigned int applyTextureLocation; 				// Location of the applyTexture bool in the currently active shader program
@@ -177,6 +198,14 @@ void myRenderScene() {
 			textureTime -= floor(textureTime / maxTime);
 		}
 	}
+	if (morphMode && morphSpinMode) {
+		// Runs back and forth between the ends of the path
+		morphPosition += morphIncrement;
+		if (morphPosition > 3.0 || morphPosition < 0.0) {
+			morphIncrement = -morphIncrement;
+			morphPosition = Max(0.0, Min(3.0, morphPosition));
+		}
+	}
    
     // Clear the rendering window
     static const float black[] = { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -184,8 +213,13 @@ void myRenderScene() {
     glClearBufferfv(GL_COLOR, 0, black);
     glClearBufferfv(GL_DEPTH, 0, &clearDepth);	// Must pass in a *pointer* to the depth
 
+    if (renderPath == rpIndirect && !morphMode && MyRenderSceneIndirect()) {
+        check_for_opengl_errors();
+        return;
+    }
+
     selectShaderProgram(shaderProgramProc);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture
+    GlStateCache::Uniform1i(applyTextureLocation, false);           // Turn off applying texture
     MyRenderSpheresForLights();
 
     MyRenderGeometries();
@@ -214,6 +248,51 @@ void my_setup_SceneData() {
     shaderProgramProc = GlShaderMgr::LinkShaderProgram(2, shaderList2);
     phRegisterShaderProgram(shaderProgramProc);
 
+    // The third shader program is the bitmap shader, but with a per-instance model matrix.
+    // It is used to draw all the polytope's spheres (or cylinders) with a single draw call.
+    unsigned int vertexShader3 = GlShaderMgr::CompileShader("vertexShader_PhongPhongInstanced");
+    unsigned int shaderList3[2] = { vertexShader3 , fragmentShader1 };
+    shaderProgramInstanced = GlShaderMgr::LinkShaderProgram(2, shaderList3);
+    phRegisterShaderProgram(shaderProgramInstanced);
+
+    // The fourth shader program is also the bitmap shader, but it reads the unit polytope
+    // from texture buffers and does the 4D rotation itself.
+    unsigned int vertexShader4 = GlShaderMgr::CompileShader("vertexShader_PolytopeGpu", "skeletonColoring");
+    unsigned int shaderList4[2] = { vertexShader4 , fragmentShader1 };
+    shaderProgramGpu = GlShaderMgr::LinkShaderProgram(2, shaderList4);
+    phRegisterShaderProgram(shaderProgramGpu);
+
+    // The fifth shader program draws the polytope's spheres and cylinders as impostors:
+    // the exact surfaces are ray-cast in the fragment shader, which also writes the depth.
+    unsigned int vertexShader5 = GlShaderMgr::CompileShader("vertexShader_Impostor");
+    unsigned int fragmentShader5 = GlShaderMgr::CompileShader("fragmentShader_Impostor", "calcPhongLighting", "applyTextureMap");
+    unsigned int shaderList5[2] = { vertexShader5 , fragmentShader5 };
+    shaderProgramImpostor = GlShaderMgr::LinkShaderProgram(2, shaderList5);
+    phRegisterShaderProgram(shaderProgramImpostor);
+
+    // The wireframe programs skip lighting and texturing altogether. They read the rotated
+    // vertex positions straight from the CPU's x, y and z arrays, so are not Phong programs.
+    // The skeletonColoring code block colors the vertices and edges by their skeleton values.
+    unsigned int vertexShaderWire = GlShaderMgr::CompileShader("vertexShader_Wireframe", "skeletonColoring");
+    unsigned int geometryShaderWire = GlShaderMgr::CompileShader("geometryShader_WireframeLines", "skeletonColoring");
+    unsigned int fragmentShaderWire = GlShaderMgr::CompileShader("fragmentShader_Wireframe");
+    unsigned int shaderListWireLines[3] = { vertexShaderWire, geometryShaderWire, fragmentShaderWire };
+    shaderProgramWireLines = GlShaderMgr::LinkShaderProgram(3, shaderListWireLines);
+    unsigned int shaderListWirePoints[2] = { vertexShaderWire, fragmentShaderWire };
+    shaderProgramWirePoints = GlShaderMgr::LinkShaderProgram(2, shaderListWirePoints);
+
+    // The sixth shader program draws every object in the scene, with either texture,
+    // from a single glMultiDrawElementsIndirect. It needs OpenGL 4.3.
+    if (GLEW_VERSION_4_3) {
+        unsigned int vertexShader6 = GlShaderMgr::CompileShader("vertexShader_PhongPhongIndirect");
+        unsigned int fragmentShader6 = GlShaderMgr::CompileShader("fragmentShader_PhongPhongIndirect", "calcPhongLighting", "MyProcTexture");
+        unsigned int shaderList6[2] = { vertexShader6 , fragmentShader6 };
+        shaderProgramIndirect = GlShaderMgr::LinkShaderProgram(2, shaderList6);
+        if (shaderProgramIndirect != 0) {
+            phRegisterShaderProgram(shaderProgramIndirect);
+        }
+    }
+
     mySetupGeometries();
     check_for_opengl_errors();
     SetupForTextures();   // The shader programs should be compiled and linked before setting up textures.
@@ -228,10 +307,17 @@ void my_setup_SceneData() {
 }
 
 void selectShaderProgram(unsigned int shaderProgram) {
-    assert(shaderProgram == shaderProgramBitmap || shaderProgram == shaderProgramProc);
-    glUseProgram(shaderProgram);
-    modelviewMatLocation = phGetModelviewMatLoc(shaderProgram);
-    applyTextureLocation = phGetApplyTextureLoc(shaderProgram);
+    assert(shaderProgram == shaderProgramBitmap || shaderProgram == shaderProgramProc
+           || shaderProgram == shaderProgramInstanced || shaderProgram == shaderProgramGpu
+           || shaderProgram == shaderProgramImpostor
+           || (shaderProgram == shaderProgramIndirect && shaderProgram != 0));
+    GlStateCache::UseProgram(shaderProgram);
+    static unsigned int locationsProgram = 0;       // Program the two locations below belong to
+    if (shaderProgram != locationsProgram) {
+        modelviewMatLocation = phGetModelviewMatLoc(shaderProgram);
+        applyTextureLocation = phGetApplyTextureLoc(shaderProgram);
+        locationsProgram = shaderProgram;
+    }
 }
 
 // *******************************************************
@@ -293,7 +379,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 			thetaSpinMode[i] = false;
 		}
         return;
-    case 'W':		// Toggle wireframe mode
+    case 'W':
+        if (mods & GLFW_MOD_SHIFT) {        // Uppercase 'W': toggle the line and point render path
+            static int pathBeforeWireframe = rpInstanced;
+            if (renderPath == rpWireframe) {
+                renderPath = pathBeforeWireframe;
+            }
+            else {
+                pathBeforeWireframe = renderPath;
+                renderPath = rpWireframe;
+            }
+            printf("Polytope render path: %s\n", renderPathNames[renderPath]);
+            return;
+        }
+        // Lowercase 'w': toggle wireframe polygon mode
         if (wireframeMode) {
             wireframeMode = false;
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -333,7 +432,48 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		polytopeOnly = !polytopeOnly;
 		return;
 	case 'P':
-		mode = (mode + 1) % nPolytopes;
+		mode = (mode + 1) % GetNumPolytopes();
+		printf("Polytope: %s\n", GetPolytopeName(mode));
+		if (morphMode && !PolytopeHasMorph(mode)) {
+			morphMode = false;
+			printf("Morph off (only the built-in polytopes can morph).\n");
+		}
+		if (morphMode) {
+			morphPosition = MorphStartPosition(mode);
+		}
+		return;
+	case 'N':
+		if (mods & GLFW_MOD_SHIFT) {
+			stressSceneSize = Min(10 * stressSceneSize, StressSceneMaxSize);	// Uppercase 'N'
+		}
+		else {
+			stressSceneSize = Max(stressSceneSize / 10, 100);					// Lowercase 'n'
+		}
+		printf("Stress scene size: %d vertices\n", stressSceneSize);
+		InvalidateStressScenes();
+		return;
+	case 'O':
+		if (mods & GLFW_MOD_SHIFT) {
+			morphSpinMode = !morphSpinMode;		// Uppercase 'O': pause or run the morph
+		}
+		else if (!PolytopeHasMorph(mode)) {
+			printf("Only the built-in polytopes can morph.\n");
+		}
+		else {
+			morphMode = !morphMode;				// Lowercase 'o': start or stop morphing
+			if (morphMode) {
+				morphPosition = MorphStartPosition(mode);
+			}
+			printf("Morph %s.\n", morphMode ? "on (drawn by the GPU-rotated path)" : "off");
+		}
+		return;
+	case GLFW_KEY_COMMA:
+	case GLFW_KEY_PERIOD:
+		if (morphMode) {
+			morphSpinMode = false;
+			morphPosition += (key == GLFW_KEY_PERIOD) ? 0.05 : -0.05;
+			morphPosition = Max(0.0, Min(3.0, morphPosition));
+		}
 		return;
 	case 'T':
 		if (mods & GLFW_MOD_SHIFT) {
@@ -345,9 +485,30 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		}
 		MyRemeshGeometries();
 		return;
+	case 'G':
+		if (mods & GLFW_MOD_SHIFT) {
+			skeletonSource = NearestPolytopeVertex();		// Uppercase 'G': distances from the vertex nearest the viewer
+			skeletonColoring = scDistance;
+			printf("Graph distances from vertex %d.\n", skeletonSource);
+		}
+		else {
+			skeletonColoring = (skeletonColoring + 1) % nSkeletonColorings;	// Lowercase 'g'
+			printf("Skeleton coloring: %s\n", skeletonColoringNames[skeletonColoring]);
+		}
+		if (skeletonColoring != scNone && renderPath != rpGpuRotate && renderPath != rpWireframe) {
+			printf("   (Shown by the GPU-rotated and wireframe render paths: press 'i' or 'W'.)\n");
+		}
+		return;
+	case 'Y':
+		PrintPolytopeSymmetry();
+		return;
 	case 'V':
 		vertsOnly = !vertsOnly;
 		return;
+	case 'I':
+		renderPath = (renderPath + 1) % nRenderPaths;
+		printf("Polytope render path: %s\n", renderPathNames[renderPath]);
+		return;
 	case GLFW_KEY_EQUAL:
 		shapeRadius += shapeScale;
 		if (shapeRadius > shapeMax) {
@@ -465,12 +626,36 @@ void setProjectionMatrix() {
     theProjectionMatrix.DumpByColumns(matEntries);
     if (glIsProgram(shaderProgramBitmap)) {
         check_for_opengl_errors();
-        glUseProgram(shaderProgramBitmap);
-        glUniformMatrix4fv(phGetProjMatLoc(shaderProgramBitmap), 1, false, matEntries);
+        GlStateCache::UseProgram(shaderProgramBitmap);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramBitmap), matEntries);
     }
     if (glIsProgram(shaderProgramProc)) {
-        glUseProgram(shaderProgramProc);
-        glUniformMatrix4fv(phGetProjMatLoc(shaderProgramProc), 1, false, matEntries);
+        GlStateCache::UseProgram(shaderProgramProc);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramProc), matEntries);
+    }
+    if (glIsProgram(shaderProgramInstanced)) {
+        GlStateCache::UseProgram(shaderProgramInstanced);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramInstanced), matEntries);
+    }
+    if (glIsProgram(shaderProgramGpu)) {
+        GlStateCache::UseProgram(shaderProgramGpu);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramGpu), matEntries);
+    }
+    if (glIsProgram(shaderProgramImpostor)) {
+        GlStateCache::UseProgram(shaderProgramImpostor);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramImpostor), matEntries);
+    }
+    if (glIsProgram(shaderProgramWireLines)) {
+        GlStateCache::UseProgram(shaderProgramWireLines);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramWireLines), matEntries);
+    }
+    if (glIsProgram(shaderProgramWirePoints)) {
+        GlStateCache::UseProgram(shaderProgramWirePoints);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramWirePoints), matEntries);
+    }
+    if (shaderProgramIndirect != 0 && glIsProgram(shaderProgramIndirect)) {
+        GlStateCache::UseProgram(shaderProgramIndirect);
+        GlStateCache::UniformMatrix4fv(phGetProjMatLoc(shaderProgramIndirect), matEntries);
     }
 
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
@@ -507,7 +692,14 @@ void setup_callbacks(GLFWwindow* window) {
 	// glfwSetMouseButtonCallback(window, mouse_button_callback);
 }
 
-int main() {
+// The command line names polytope files to add to the ones 'P' cycles through:
+//    binary polytope files, 4OFF files or lists of points (x y z w on each line).
+//    After "--hull", lists of points are replaced by their convex hull.
+//    Binary polytope files have their indices checked before use, except after "--no-validate"
+//    (for trusted files, written by "--save").
+//    "--save file" writes the polytope loaded just before it as a binary polytope file,
+//    which then loads without any parsing, copying or reordering.
+int main(int argc, char* argv[]) {
 	glfwSetErrorCallback(error_callback);	// Supposed to be called in event of errors. (doesn't work?)
 	glfwInit();
 	//glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -537,7 +729,8 @@ int main() {
 
 	printf("------------------------------\n");
 	printf("POLYTOPE CONTROLS:\n");
-	printf("Press 'p' or 'P' to cycle through the six modes of viewing.\n");
+	printf("Press 'p' or 'P' to cycle through the twelve polytopes (six regular, six uniform), four stress scenes and any files loaded.\n");
+	printf("Press 'N' to make the stress scenes ten times larger (up to a million vertices), and 'n' ten times smaller.\n");
 	printf("Press {1,2,3,4,5,6} (numpad) to toggle rotation about xy/xz/xw/yz/yw/zw planes resp.\n");
 	printf("Press ALT + {1,2,3,4,5,6} (numpad) to reset rotation time to 0 and turn off rotation.\n");
 	printf("Press CONTROL + {1,2,3,4,5,6} (numpad) to double rotation speed.\n");
@@ -549,6 +742,8 @@ int main() {
 	printf("Press 'r'/'R' to turn off all animation, set animation speed to 0.2, and set animation time to 0.\n");
 	printf("Press 't' to toggle running the texture animation.\n");
 	printf("Press 'T' to turn off texture animation and reset the time to 0.\n");
+	printf("Press 'o' to morph the polytope through its truncations, rectification and dual, and 'O' to pause the morph.\n");
+	printf("Press ',' and '.' to step the morph back and forth.\n");
     printf("Press arrow keys to adjust the view direction.\n");
     printf("Press HOME or END to closer to and farther away from the scene.\n");
 	printf("RENDER CONTROLS:\n");
@@ -556,7 +751,12 @@ int main() {
     printf("Press 'M' (mesh) to increase the mesh resolution.\n");
     printf("Press 'm' (mesh) to decrease the mesh resolution.\n");
 	printf("Press 'v' or 'V' to toggle whether to only view vertices.\n");
-    printf("Press 'w'/'W' (wireframe) to toggle whether wireframe or fill mode.\n");
+	printf("Press 'g' to cycle the skeleton colorings (graph distance, vertex coloring, edge coloring, off).\n");
+	printf("Press 'G' to show graph distances from the vertex nearest the viewer.\n");
+	printf("Press 'y' or 'Y' to find the symmetry group of the polytope (from its skeleton).\n");
+	printf("Press 'i' or 'I' to cycle through the polytope render paths (per-object, instanced, GPU-rotated, multi-draw-indirect, impostors, wireframe).\n");
+    printf("Press 'w' (wireframe) to toggle whether wireframe or fill mode.\n");
+    printf("Press 'W' (wireframe) to toggle drawing the polytope as lines and points only (fast for huge polytopes).\n");
 	printf("Press '+'/'=' to increase shape radius and '-'/'_' to decrease shape radius.\n");
 	printf("LIGHT CONTROLS:\n");
 	printf("Press {1,2,3,4,5,6} to toggle point-source lights (1,2,3) and spotlights (4,5,6).\n");
@@ -572,6 +772,29 @@ int main() {
 	// Initialize OpenGL, the scene and the shaders
     my_setup_OpenGL();
 	my_setup_SceneData();
+	bool hull = false;
+	bool validate = true;
+	int lastLoaded = -1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--hull") == 0) {
+			hull = true;
+		}
+		else if (strcmp(argv[i], "--no-validate") == 0) {
+			validate = false;
+		}
+		else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+			i++;
+			if (lastLoaded >= 0) {
+				SavePolytope(lastLoaded, argv[i]);
+			}
+			else {
+				fprintf(stderr, "No polytope was loaded for --save to write to '%s'.\n", argv[i]);
+			}
+		}
+		else {
+			lastLoaded = LoadPolytope(argv[i], hull, validate);
+		}
+	}
  	window_size_callback(window, screenWidth, screenHeight);
 
     // Loop while program is not terminated.
@@ -586,6 +809,7 @@ int main() {
 		// glfwPollEvents();					// Use this version when animating as fast as possible
 	}
 
+	MyPrintRenderStats();
 	glfwTerminate();
 	return 0;
 }
@@ -37,8 +37,12 @@ extern bool thetaSpinMode[];
 extern double thetas[];
 // whether rotating texture
 extern bool tSpinMode;
-// number of polytopes available to be rendered
-extern const int nPolytopes;
+// morphing the polytope through the uniform polytopes of its diagram
+extern bool morphMode;
+extern bool morphSpinMode;
+extern double morphPosition;
+// number of vertices of the stress scenes
+extern int stressSceneSize;
 
 // Controls whether to render only the floor (and no other geometries)
 extern bool renderFloorOnly;
@@ -55,6 +59,29 @@ extern double currentDelta;        // Current state of the animation (YOUR CODE
 extern bool vertsOnly;
 extern bool polytopeOnly;
 
+// Controls how the polytope's vertices (spheres) and edges (cylinders) are submitted
+const int rpPerObject = 0;		// One draw call per sphere and per cylinder
+const int rpInstanced = 1;		// One instanced draw call for all spheres, one for all cylinders
+const int rpGpuRotate = 2;		// Unit polytope stored on the GPU, rotated and placed in the vertex shader
+const int rpIndirect = 3;		// The whole scene in one glMultiDrawElementsIndirect (needs OpenGL 4.3)
+const int rpImpostor = 4;		// Spheres and cylinders ray-cast in the fragment shader, on quads and boxes
+const int rpWireframe = 5;		// Edges as one GL_LINES draw and vertices as one GL_POINTS draw, no shading
+const int nRenderPaths = 6;
+extern int renderPath;
+extern const char* renderPathNames[];
+
+// Values from the polytope's skeleton graph (see SkeletonGraph4D), shown as colors
+//    by the GPU-rotated and wireframe render paths
+const int scNone = 0;			// The usual colors
+const int scDistance = 1;		// Graph distance from skeletonSource, a shell at a time
+const int scVertexColors = 2;	// A proper coloring of the vertices
+const int scEdgeColors = 3;		// A proper coloring of the edges
+const int nSkeletonColorings = 4;
+extern int skeletonColoring;
+extern int skeletonSource;		// The vertex the distances are from
+extern const char* skeletonColoringNames[];
+
+extern LinearMapR4 theProjectionMatrix;	// The current projection matrix, a symmetric frustum.
 extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth and viewDirection.
 // Comment: This viewMatrix changes only when the view changes.
 // The modelViewMatrix is updated to render objects in the desired position and orientation.
@@ -63,12 +90,21 @@ extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth
 // Global variables that let program access the shader programs:
 extern unsigned int shaderProgramBitmap;     // The shader program that applies a bitmapped texture map (from a file)
 extern unsigned int shaderProgramProc;       // The shader program that applies a procedural texture map
+extern unsigned int shaderProgramInstanced;  // Like shaderProgramBitmap, but with a per-instance model matrix
+extern unsigned int shaderProgramGpu;        // Like shaderProgramBitmap, but rotates and places the polytope itself
+extern unsigned int shaderProgramIndirect;   // Reads per-object data from a storage buffer, for multi-draw-indirect (0 if unsupported)
+extern unsigned int shaderProgramImpostor;   // Ray-casts the polytope's spheres and cylinders
+extern unsigned int shaderProgramWireLines;  // Draws the polytope's edges as anti-aliased thick lines
+extern unsigned int shaderProgramWirePoints; // Draws the polytope's vertices as anti-aliased round points
+extern int screenWidth, screenHeight;       // Size of the window in pixels
 extern unsigned int modelviewMatLocation;
 extern unsigned int applyTextureLocation;
 
 constexpr unsigned int vertPos_loc = 0;         // "location = 0" in the vertex shader definition
 constexpr unsigned int vertNormal_loc = 1;      // "location = 1" in the vertex shader definition
 constexpr unsigned int vertTexCoords_loc = 2;   // "location = 2" in the vertex shader definition
+constexpr unsigned int instanceMatrix_loc = 9;  // "location = 9" (through 12) in the instanced vertex shader
+constexpr unsigned int drawRecord_loc = 9;      // "location = 9" in the multi-draw-indirect vertex shader
 
 
 
@@ -0,0 +1,246 @@
+//
+//  Topology4D.cpp
+//
+//   Faces, cells and incidences of convex 4-polytopes. See Topology4D.h.
+//
+
+#include "Topology4D.h"
+#include <math.h>
+#include <algorithm>
+#include <iterator>
+
+// n = a vector perpendicular to a, b and c: the cofactors of the matrix with rows a, b, c.
+static void Cross4(const double* a, const double* b, const double* c, double* n)
+{
+	double m01 = b[0] * c[1] - b[1] * c[0];
+	double m02 = b[0] * c[2] - b[2] * c[0];
+	double m03 = b[0] * c[3] - b[3] * c[0];
+	double m12 = b[1] * c[2] - b[2] * c[1];
+	double m13 = b[1] * c[3] - b[3] * c[1];
+	double m23 = b[2] * c[3] - b[3] * c[2];
+	n[0] = a[1] * m23 - a[2] * m13 + a[3] * m12;
+	n[1] = -(a[0] * m23 - a[2] * m03 + a[3] * m02);
+	n[2] = a[0] * m13 - a[1] * m03 + a[3] * m01;
+	n[3] = -(a[0] * m12 - a[1] * m02 + a[2] * m01);
+}
+
+// CSR lists from (list, item) pairs: start gets numLists+1 entries.
+static void BuildCsr(int numLists, const std::vector<int>& listOf, const std::vector<int>& itemOf,
+	std::vector<int>& start, std::vector<int>& items)
+{
+	start.assign(numLists + 1, 0);
+	for (size_t k = 0; k < listOf.size(); k++) {
+		start[listOf[k] + 1]++;
+	}
+	for (int i = 0; i < numLists; i++) {
+		start[i + 1] += start[i];
+	}
+	items.resize(listOf.size());
+	std::vector<int> fill(start.begin(), start.end() - 1);
+	for (size_t k = 0; k < listOf.size(); k++) {
+		items[fill[listOf[k]]++] = itemOf[k];
+	}
+}
+
+void PolytopeTopology4D::BuildVertEdges(int numVerts, const int* edges, int numEdges)
+{
+	std::vector<int> listOf(2 * numEdges), itemOf(2 * numEdges);
+	for (int e = 0; e < numEdges; e++) {
+		listOf[2 * e] = edges[2 * e];
+		listOf[2 * e + 1] = edges[2 * e + 1];
+		itemOf[2 * e] = itemOf[2 * e + 1] = e;
+	}
+	BuildCsr(numVerts, listOf, itemOf, vertEdgeStart, vertEdges);
+}
+
+bool PolytopeTopology4D::Build(const float* verts, int numVerts, const int* edges, int numEdges)
+{
+	BuildVertEdges(numVerts, edges, numEdges);
+
+	// Cells, by hyperplane grouping around each vertex.
+	cellStart.assign(1, 0);
+	cellVerts.clear();
+	std::vector<double> cellNormals;				// 4 per cell, pointing out
+	std::vector<std::vector<int> > cellsAt(numVerts);
+	std::vector<int> stamp(numVerts, -1);			// stamp[u] == c once u is put in cell c
+	std::vector<double> nbr;						// Neighbors of the vertex, relative to it
+	std::vector<int> stack;
+	for (int v = 0; v < numVerts; v++) {
+		const float* pv = verts + 4 * v;
+		int degree = GetVertDegree(v);
+		const int* ve = GetVertEdges(v);
+		nbr.resize(4 * degree);
+		double maxLen = 0.0;
+		for (int k = 0; k < degree; k++) {
+			int w = edges[2 * ve[k]] + edges[2 * ve[k] + 1] - v;
+			double lenSq = 0.0;
+			for (int i = 0; i < 4; i++) {
+				nbr[4 * k + i] = verts[4 * w + i] - pv[i];
+				lenSq += nbr[4 * k + i] * nbr[4 * k + i];
+			}
+			maxLen = fmax(maxLen, sqrt(lenSq));
+		}
+		double eps = 1.0e-4 * maxLen;
+
+		for (int a = 0; a < degree; a++) {
+			for (int b = a + 1; b < degree; b++) {
+				for (int c = b + 1; c < degree; c++) {
+					double n[4];
+					Cross4(&nbr[4 * a], &nbr[4 * b], &nbr[4 * c], n);
+					double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] + n[3] * n[3]);
+					if (len < 1.0e-6 * maxLen * maxLen * maxLen) {
+						continue;		// The three neighbors do not span a hyperplane with v
+					}
+					for (int i = 0; i < 4; i++) {
+						n[i] /= len;
+					}
+					bool above = false, below = false;
+					for (int k = 0; k < degree && !(above && below); k++) {
+						const double* d = &nbr[4 * k];
+						double s = n[0] * d[0] + n[1] * d[1] + n[2] * d[2] + n[3] * d[3];
+						above |= (s > eps);
+						below |= (s < -eps);
+					}
+					if (above == below) {
+						continue;		// Cuts through the polytope (or it is flat)
+					}
+					if (above) {
+						for (int i = 0; i < 4; i++) {
+							n[i] = -n[i];
+						}
+					}
+					bool known = false;
+					for (size_t k = 0; k < cellsAt[v].size() && !known; k++) {
+						const double* m = &cellNormals[4 * cellsAt[v][k]];
+						known = (n[0] * m[0] + n[1] * m[1] + n[2] * m[2] + n[3] * m[3] > 1.0 - 1.0e-6);
+					}
+					if (known) {
+						continue;
+					}
+
+					// A new cell: the vertices on the hyperplane connected to v.
+					int cell = GetNumCells();
+					cellNormals.insert(cellNormals.end(), n, n + 4);
+					size_t first = cellVerts.size();
+					stamp[v] = cell;
+					stack.assign(1, v);
+					while (!stack.empty()) {
+						int u = stack.back();
+						stack.pop_back();
+						cellVerts.push_back(u);
+						cellsAt[u].push_back(cell);
+						for (int k = vertEdgeStart[u]; k < vertEdgeStart[u + 1]; k++) {
+							int e = vertEdges[k];
+							int w = edges[2 * e] + edges[2 * e + 1] - u;
+							const float* pw = verts + 4 * w;
+							double s = n[0] * (pw[0] - pv[0]) + n[1] * (pw[1] - pv[1])
+								+ n[2] * (pw[2] - pv[2]) + n[3] * (pw[3] - pv[3]);
+							if (stamp[w] != cell && fabs(s) <= eps) {
+								stamp[w] = cell;
+								stack.push_back(w);
+							}
+						}
+					}
+					std::sort(cellVerts.begin() + first, cellVerts.end());
+					cellStart.push_back((int)cellVerts.size());
+				}
+			}
+		}
+	}
+
+	return BuildFaces(edges, numEdges);
+}
+
+bool PolytopeTopology4D::BuildFromCells(int numVerts, const int* edges, int numEdges,
+	const std::vector<int>& cellStart, const std::vector<int>& cellVerts)
+{
+	BuildVertEdges(numVerts, edges, numEdges);
+	this->cellStart = cellStart;
+	this->cellVerts = cellVerts;
+	return BuildFaces(edges, numEdges);
+}
+
+bool PolytopeTopology4D::BuildFaces(const int* edges, int numEdges)
+{
+	int numVerts = GetNumVerts();
+	// Vertex -> cells
+	std::vector<int> listOf(cellVerts), itemOf(cellVerts.size());
+	for (int c = 0; c < GetNumCells(); c++) {
+		for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+			itemOf[k] = c;
+		}
+	}
+	std::vector<int> vertCellStart, vertCells;
+	BuildCsr(numVerts, listOf, itemOf, vertCellStart, vertCells);
+
+	// 2-faces: where two cells share at least three vertices. The cells c2 > c1 that
+	//    share vertices with c1 are counted through the vertices of c1.
+	faceStart.assign(1, 0);
+	faceVerts.clear();
+	faceEdges.clear();
+	faceCells.clear();
+	std::vector<int> sharedCount(GetNumCells(), 0);
+	std::vector<int> touched;
+	std::vector<int> common;
+	for (int c1 = 0; c1 < GetNumCells(); c1++) {
+		touched.clear();
+		for (int k = cellStart[c1]; k < cellStart[c1 + 1]; k++) {
+			int u = cellVerts[k];
+			for (int m = vertCellStart[u]; m < vertCellStart[u + 1]; m++) {
+				int c = vertCells[m];
+				if (c > c1 && sharedCount[c]++ == 0) {
+					touched.push_back(c);
+				}
+			}
+		}
+		for (size_t t = 0; t < touched.size(); t++) {
+			int c2 = touched[t];
+			int numShared = sharedCount[c2];
+			sharedCount[c2] = 0;
+			if (numShared < 3) {
+				continue;
+			}
+			common.clear();
+			std::set_intersection(GetCell(c1), GetCell(c1) + GetCellSize(c1),
+				GetCell(c2), GetCell(c2) + GetCellSize(c2), std::back_inserter(common));
+			// Walk around the face along its edges.
+			int prev = -1;
+			int cur = common[0];
+			for (size_t k = 0; k < common.size(); k++) {
+				faceVerts.push_back(cur);
+				int next = -1;
+				for (int m = vertEdgeStart[cur]; m < vertEdgeStart[cur + 1] && next < 0; m++) {
+					int e = vertEdges[m];
+					int w = edges[2 * e] + edges[2 * e + 1] - cur;
+					if (w != prev && std::binary_search(common.begin(), common.end(), w)) {
+						next = w;
+						faceEdges.push_back(e);
+					}
+				}
+				if (next < 0) {
+					return false;
+				}
+				prev = cur;
+				cur = next;
+			}
+			if (cur != common[0]) {
+				return false;
+			}
+			faceStart.push_back((int)faceVerts.size());
+			faceCells.push_back(c1);
+			faceCells.push_back(c2);
+		}
+	}
+
+	// Edge -> 2-faces
+	listOf.assign(faceEdges.begin(), faceEdges.end());
+	itemOf.resize(faceEdges.size());
+	for (int f = 0; f < GetNumFaces(); f++) {
+		for (int k = faceStart[f]; k < faceStart[f + 1]; k++) {
+			itemOf[k] = f;
+		}
+	}
+	BuildCsr(numEdges, listOf, itemOf, edgeFaceStart, edgeFaces);
+
+	return numVerts - numEdges + GetNumFaces() - GetNumCells() == 0;
+}
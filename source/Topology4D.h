@@ -0,0 +1,74 @@
+#pragma once
+
+//
+// Topology4D.h   ---  Header file for Topology4D.cpp.
+//
+//   The 2-faces and cells of a convex 4-polytope, found from its vertices and
+//   edges alone, with the incidences between them as flat CSR arrays
+//   (item i of a list is Items[Start[i]] up to Items[Start[i+1]-1]).
+//
+//   The cells are found by hyperplane grouping. A convex polytope lies inside
+//   the cone of its edges at any vertex v, so a hyperplane through v and three
+//   of its neighbors bounds a cell exactly when all the other neighbors of v are
+//   on one side of it. The cell is then the vertices on that hyperplane, found
+//   by following edges from v. The 2-faces are where two cells meet in more than
+//   an edge. Each vertex is only compared with its neighbors and its cells, so
+//   the time is linear for polytopes of bounded vertex degree.
+//
+
+#include <vector>
+
+class PolytopeTopology4D
+{
+public:
+	// Builds the faces, cells and incidences. verts has 4 floats per vertex, edges has
+	//    2 vertex indices per edge. Returns false if the result is not a convex
+	//    4-polytope (the Euler characteristic V - E + F - C is not 0).
+	bool Build(const float* verts, int numVerts, const int* edges, int numEdges);
+
+	// The same, for when the cells are already known (cellStart and cellVerts as below,
+	//    with each cell's vertices in increasing order). Only the 2-faces are found.
+	bool BuildFromCells(int numVerts, const int* edges, int numEdges,
+		const std::vector<int>& cellStart, const std::vector<int>& cellVerts);
+
+	int GetNumVerts() const { return (int)vertEdgeStart.size() - 1; }
+	int GetNumEdges() const { return (int)edgeFaceStart.size() - 1; }
+	int GetNumFaces() const { return (int)faceStart.size() - 1; }
+	int GetNumCells() const { return (int)cellStart.size() - 1; }
+
+	// The edges at vertex v
+	int GetVertDegree(int v) const { return vertEdgeStart[v + 1] - vertEdgeStart[v]; }
+	const int* GetVertEdges(int v) const { return vertEdges.data() + vertEdgeStart[v]; }
+
+	// The 2-faces containing edge e
+	int GetEdgeNumFaces(int e) const { return edgeFaceStart[e + 1] - edgeFaceStart[e]; }
+	const int* GetEdgeFaces(int e) const { return edgeFaces.data() + edgeFaceStart[e]; }
+
+	// The vertices of 2-face f, in order around it, and its edges in the same order
+	//    (edge k joins vertex k and vertex k+1)
+	int GetFaceSize(int f) const { return faceStart[f + 1] - faceStart[f]; }
+	const int* GetFace(int f) const { return faceVerts.data() + faceStart[f]; }
+	const int* GetFaceEdges(int f) const { return faceEdges.data() + faceStart[f]; }
+
+	// The two cells that meet in 2-face f
+	const int* GetFaceCells(int f) const { return faceCells.data() + 2 * f; }
+
+	// The vertices of cell c, in increasing order
+	int GetCellSize(int c) const { return cellStart[c + 1] - cellStart[c]; }
+	const int* GetCell(int c) const { return cellVerts.data() + cellStart[c]; }
+
+private:
+	void BuildVertEdges(int numVerts, const int* edges, int numEdges);
+	bool BuildFaces(const int* edges, int numEdges);	// From the cells
+
+	std::vector<int> vertEdgeStart;		// Vertex -> edges
+	std::vector<int> vertEdges;
+	std::vector<int> edgeFaceStart;		// Edge -> 2-faces
+	std::vector<int> edgeFaces;
+	std::vector<int> faceStart;			// 2-face -> vertices and edges
+	std::vector<int> faceVerts;
+	std::vector<int> faceEdges;
+	std::vector<int> faceCells;			// 2-face -> cells, 2 per face
+	std::vector<int> cellStart;			// Cell -> vertices
+	std::vector<int> cellVerts;
+};
@@ -0,0 +1,188 @@
+//
+//  Wythoff4D.cpp
+//
+//   The Wythoff construction for uniform 4-polytopes. See Wythoff4D.h.
+//
+
+#include "Wythoff4D.h"
+#include "Coxeter4D.h"
+#include <unordered_set>
+#include <thread>
+#include <math.h>
+
+// The edges in the orbit of the first vertex (coset 0) and its image in the given mirror,
+//    2 vertex indices per edge. An edge is looked up as a 64 bit key, smaller vertex first.
+static void EdgeOrbit(const std::vector<int>* table, int mirror, std::vector<int>* edges)
+{
+	const int* t = table->data();
+	std::unordered_set<long long> found;
+	edges->clear();
+	edges->push_back(0);
+	edges->push_back(t[mirror]);
+	found.insert((long long)t[mirror]);
+	for (size_t e = 0; e < edges->size(); e += 2) {
+		int a = (*edges)[e];
+		int b = (*edges)[e + 1];
+		for (int i = 0; i < 4; i++) {
+			int ia = t[4 * a + i];
+			int ib = t[4 * b + i];
+			long long key = ia < ib ? ((long long)ia << 32) | ib : ((long long)ib << 32) | ia;
+			if (found.insert(key).second) {
+				edges->push_back(ia);
+				edges->push_back(ib);
+			}
+		}
+	}
+}
+
+bool UniformPolytope4D::Generate(int m01, int m12, int m23, int ringMask, double edgeLength)
+{
+	verts.clear();
+	edges.clear();
+	ringMask &= 15;
+	CoxeterGroup4D group;
+	if (ringMask == 0 || !group.Set(m01, m12, m23)) {
+		return false;
+	}
+
+	// The first vertex is fixed exactly by the mirrors that are not ringed.
+	std::vector<int> table;
+	if (group.EnumerateCosets(15 & ~ringMask, table) == 0) {
+		return false;
+	}
+	group.PlaceCosets(table, ringMask, edgeLength, verts);
+
+	// The edge orbits of different mirrors are disjoint, so each one gets its own thread.
+	std::vector<int> orbitEdges[4];
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; i++) {
+		if (ringMask & (1 << i)) {
+			threads.push_back(std::thread(EdgeOrbit, &table, i, &orbitEdges[i]));
+		}
+	}
+	for (size_t k = 0; k < threads.size(); k++) {
+		threads[k].join();
+	}
+	for (int i = 0; i < 4; i++) {
+		edges.insert(edges.end(), orbitEdges[i].begin(), orbitEdges[i].end());
+	}
+	return true;
+}
+
+// **********************
+// WythoffMorph4D
+// **********************
+
+bool WythoffMorph4D::Generate(int m01, int m12, int m23)
+{
+	corners.clear();
+	edges.clear();
+	CoxeterGroup4D group;
+	if (!group.Set(m01, m12, m23)) {
+		return false;
+	}
+
+	// The cosets of the trivial subgroup are the group elements themselves.
+	std::vector<int> table;
+	int numVerts = group.EnumerateCosets(0, table);
+	if (numVerts == 0) {
+		return false;
+	}
+
+	// Vertex c*ri is vertex c's image of the first vertex's reflection in mirror i.
+	//    So each vertex's matrix is found as its neighbor's times the reflection,
+	//    and the corners are placed with it.
+	double cornerPos[4][4];
+	for (int i = 0; i < 4; i++) {
+		group.WythoffPoint(1 << i, cornerPos[i]);
+		const double* p = cornerPos[i];
+		double len = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + p[3] * p[3]);
+		cornerDistance[i] = 0.5 / len;
+		for (int k = 0; k < 4; k++) {
+			cornerPos[i][k] /= len;
+		}
+	}
+	std::vector<double> matrices(16 * (size_t)numVerts);		// Column j is the image of axis j
+	std::vector<bool> placed(numVerts, false);
+	std::vector<int> queue(1, 0);
+	for (int k = 0; k < 16; k++) {
+		matrices[k] = (k % 5 == 0) ? 1.0 : 0.0;
+	}
+	placed[0] = true;
+	corners.resize(16 * (size_t)numVerts);
+	for (size_t q = 0; q < queue.size(); q++) {
+		int c = queue[q];
+		const double* m = &matrices[16 * c];
+		for (int i = 0; i < 4; i++) {
+			double image[4];
+			for (int k = 0; k < 4; k++) {
+				image[k] = m[k] * cornerPos[i][0] + m[4 + k] * cornerPos[i][1] + m[8 + k] * cornerPos[i][2] + m[12 + k] * cornerPos[i][3];
+				corners[16 * c + 4 * i + k] = (float)image[k];
+			}
+		}
+		for (int i = 0; i < 4; i++) {
+			int d = table[4 * c + i];
+			if (!placed[d]) {
+				// Column j of M*Ri is M applied to Ri(axis j).
+				for (int j = 0; j < 4; j++) {
+					double axis[4] = { 0.0, 0.0, 0.0, 0.0 };
+					axis[j] = 1.0;
+					group.Reflect(i, axis, axis);
+					for (int k = 0; k < 4; k++) {
+						matrices[16 * d + 4 * j + k] = m[k] * axis[0] + m[4 + k] * axis[1] + m[8 + k] * axis[2] + m[12 + k] * axis[3];
+					}
+				}
+				placed[d] = true;
+				queue.push_back(d);
+			}
+		}
+	}
+
+	// Each mirror takes every vertex to another one, so there are no duplicates to find.
+	edges.reserve(4 * (size_t)numVerts);
+	for (int c = 0; c < numVerts; c++) {
+		for (int i = 0; i < 4; i++) {
+			if (c < table[4 * c + i]) {
+				edges.push_back(c);
+				edges.push_back(table[4 * c + i]);
+			}
+		}
+	}
+	return true;
+}
+
+void WythoffMorph4D::GetRingWeights(int ringMask, float* weights) const
+{
+	// The first vertex of the Wythoff construction is 1/2 away from each ringed mirror,
+	//    and only corner i is off mirror i.
+	for (int i = 0; i < 4; i++) {
+		weights[i] = (ringMask & (1 << i)) ? (float)(0.5 / cornerDistance[i]) : 0.0f;
+	}
+}
+
+void WythoffMorph4D::GetPathWeights(double position, float* weights)
+{
+	position = position < 0.0 ? 0.0 : (position > 3.0 ? 3.0 : position);
+	int i = position < 3.0 ? (int)position : 2;
+	double t = position - i;
+	for (int k = 0; k < 4; k++) {
+		weights[k] = 0.0f;
+	}
+	weights[i] = (float)(1.0 - t);
+	weights[i + 1] = (float)t;
+}
+
+double WythoffMorph4D::GetPathPosition(int ringMask) const
+{
+	float weights[4];
+	GetRingWeights(ringMask, weights);
+	for (int i = 0; i < 4; i++) {
+		if ((ringMask & 15) == (1 << i)) {
+			return i;
+		}
+		if (i < 3 && (ringMask & 15) == (3 << i)) {
+			return i + weights[i + 1] / (weights[i] + weights[i + 1]);
+		}
+	}
+	return -1.0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+//
+// Wythoff4D.h   ---  Header file for Wythoff4D.cpp.
+//
+//   The Wythoff construction ("kaleidoscope") for uniform 4-polytopes.
+//   Four mirrors form a Coxeter diagram o-m01-o-m12-o-m23-o (see Coxeter4D.h).
+//   Some of the nodes are ringed. The first vertex lies on every mirror that
+//   is not ringed, and at distance 1/2 from every ringed mirror. The other
+//   vertices are its images under the group. Each ringed mirror i gives a
+//   kind of edge, the orbit of the first vertex and its reflection in mirror i.
+//   So every edge has the same length.
+//
+//   Examples, for the diagram o-5-o-3-o-3-o (ringMask bit i for node i):
+//      0x1   120-cell            0x8   600-cell
+//      0x2   rectified 120-cell  0x3   truncated 120-cell
+//      0x5   cantellated         0x9   runcinated
+//      0xf   omnitruncated 120-cell (14400 vertices, 28800 edges)
+//
+
+#include <vector>
+
+class UniformPolytope4D
+{
+public:
+	// Builds the polytope with the given diagram and ringed nodes, centered at the origin,
+	//    with all edges of length edgeLength. Returns false if the diagram's group is
+	//    infinite, or if no node is ringed.
+	// The edge orbits of the ringed mirrors are found in parallel, one thread each.
+	bool Generate(int m01, int m12, int m23, int ringMask, double edgeLength);
+
+	int GetNumVerts() const { return (int)verts.size() / 4; }
+	const float* GetVerts() const { return verts.data(); }		// 4 floats per vertex
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge
+
+private:
+	std::vector<float> verts;
+	std::vector<int> edges;
+};
+
+// All the uniform polytopes of one diagram at once, for morphing between them:
+//    the polytope, its truncation, rectification, bitruncation, ... and its dual.
+// The combinatorics are those of the omnitruncation, one vertex per group element g
+//    and one edge from g to g*ri for each mirror i. As the first vertex moves in the
+//    fundamental simplex, vertex g moves to its image under g, and edges shrink to
+//    points when it reaches their mirror. So any Wythoff position is a weighted sum
+//    of the images of the simplex's four corners: the renderer stores these once,
+//    and places the vertices from a vec4 of weights.
+class WythoffMorph4D
+{
+public:
+	// Builds the morph for the diagram o-m01-o-m12-o-m23-o. Returns false if its group is infinite.
+	bool Generate(int m01, int m12, int m23);
+
+	int GetNumVerts() const { return (int)corners.size() / 16; }
+	// For each vertex g, the images under g of the four corners of the fundamental
+	//    simplex (corner i is the one off mirror i), as 4 vec4's of length 1.
+	const float* GetCorners() const { return corners.data(); }
+	int GetNumEdges() const { return (int)edges.size() / 2; }
+	const int* GetEdges() const { return edges.data(); }		// 2 vertex indices per edge
+
+	// The weights of the corners that place the vertices of the polytope with the given
+	//    ringed nodes, with edge length 1. (The renderer scales the sums to a sphere.)
+	void GetRingWeights(int ringMask, float* weights) const;
+
+	// The weights for a position from 0 to 3 along the path through the corners in
+	//    order: node 0 ringed at 0, nodes 0 and 1 in between, node 1 at 1, and so on.
+	static void GetPathWeights(double position, float* weights);
+	// The position on that path of the polytope with the given ringed nodes, or -1 if it
+	//    is not on the path (more than two nodes ringed, or two that are not adjacent).
+	double GetPathPosition(int ringMask) const;
+
+private:
+	std::vector<float> corners;
+	std::vector<int> edges;
+	double cornerDistance[4];		// Distance from corner i to mirror i
+};